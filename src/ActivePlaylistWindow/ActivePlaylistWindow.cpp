@@ -36,7 +36,7 @@ ActivePlaylistWindow::ActivePlaylistWindow(xmms2::Client *xmmsClient, const Rect
     plsModel->activeSongPositionChanged_Connect(&ActivePlaylistWindow::scrollToActiveSong, this);
 
     plsModel->playlistRenamed_Connect(&ActivePlaylistWindow::updateWindowTitle, this);
-    plsModel->totalDurationChanged_Connect(&ActivePlaylistWindow::updateWindowTitle, this);
+    plsModel->durationsChanged_Connect(&ActivePlaylistWindow::updateWindowTitle, this);
 
     //Settings
     loadPalette("ActivePlaylistWindow");
@@ -75,6 +75,12 @@ void ActivePlaylistWindow::updateWindowTitle()
             titleString.append(", ");
             titleString.append(Utils::getTimeStringFromInt(plsModel->totalDuration()));
             titleString.append(" total playtime");
+            const int remainingDuration = plsModel->remainingDuration();
+            if (remainingDuration > 0 && remainingDuration < plsModel->totalDuration()) {
+                titleString.append(", ");
+                titleString.append(Utils::getTimeStringFromInt(remainingDuration));
+                titleString.append(" remaining");
+            }
         }
         titleString.push_back(')');
     }
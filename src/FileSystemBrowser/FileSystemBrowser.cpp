@@ -108,12 +108,15 @@ void FileSystemBrowser::directoryLoadFailed(const Dir& dir, const std::string& e
 
 void FileSystemBrowser::addItemToActivePlaylist()
 {
-    const std::vector<int>& selectedItems = this->selectedItems();
+    const ItemSelection& selectedItems = this->selectedItems();
     if (!selectedItems.empty()) {
+        xmms2::RequestGroup group;
         for (int item : selectedItems) {
-            const bool beQuiet = true;
-            activePlaylistAddFileOrDirectory(item, beQuiet);
+            activePlaylistAddFileOrDirectory(item, &group);
         }
+        group.finish([](int count, const std::vector<xmms2::RequestGroup::ItemError>& errors){
+            StatusArea::showActivePlaylistAddErrors(errors.size(), count, "items", errors);
+        });
         StatusArea::showMessage("Adding %d items to active playlist", selectedItems.size());
         clearSelection();
     } else {
@@ -123,35 +126,40 @@ void FileSystemBrowser::addItemToActivePlaylist()
     }    
 }
 
-void FileSystemBrowser::activePlaylistAddFileOrDirectory(int item, bool beQuiet)
+void FileSystemBrowser::activePlaylistAddFileOrDirectory(int item, xmms2::RequestGroup *group)
 {
     assert(item >= 0 && item < fsModel()->itemsCount());
 
     if (fsModel()->isDirectory(item)) {
-        m_xmmsClient->playlistAddRecursive(m_xmmsClient->playlistCurrentActive(), fsModel()->fileUrl(item));
-        if (!beQuiet) {
+        const std::string& playlist = m_xmmsClient->playlistCurrentActive();
+        if (group) {
+            group->add(m_xmmsClient->playlistAddRecursive(playlist, fsModel()->fileUrl(item)));
+        } else {
+            m_xmmsClient->playlistAddRecursive(playlist, fsModel()->fileUrl(item));
             StatusArea::showMessage("Adding \"%s\" directory to active playlist", fsModel()->fileName(item));
         }
      } else {
-        activePlaylistAddFile(item, beQuiet);
+        activePlaylistAddFile(item, group);
     }
 }
 
-void FileSystemBrowser::activePlaylistAddFile(int item, bool beQuiet)
+void FileSystemBrowser::activePlaylistAddFile(int item, xmms2::RequestGroup *group)
 {
     assert(item >= 0 && item < fsModel()->itemsCount());
 
     const std::string fileName = fsModel()->fileName(item);
     const std::string fileUrl  = fsModel()->fileUrl(item);
+    const std::string& playlist = m_xmmsClient->playlistCurrentActive();
 
     if (Utils::getFileType(fileName) ==  Utils::FileType::Playlist) {
-        m_xmmsClient->playlistAddPlaylistFile(m_xmmsClient->playlistCurrentActive(), fileUrl);
-        if (!beQuiet)
+        m_xmmsClient->playlistAddPlaylistFile(playlist, fileUrl, group);
+        if (!group)
             StatusArea::showMessage("Adding \"%s\" playlist file to active playlist", fileName);
+    } else if (group) {
+        group->add(m_xmmsClient->playlistAddUrl(playlist, fileUrl));
     } else {
-        m_xmmsClient->playlistAddUrl(m_xmmsClient->playlistCurrentActive(), fileUrl);
-        if (!beQuiet)
-            StatusArea::showMessage("Adding \"%s\" file to active playlist", fileName);
+        m_xmmsClient->playlistAddUrl(playlist, fileUrl);
+        StatusArea::showMessage("Adding \"%s\" file to active playlist", fileName);
     }
 }
 
@@ -194,8 +202,12 @@ void FileSystemBrowser::activePlaylistPlayPlaylistFile(const std::string& url)
             return;
         m_xmmsClient->playlistPlayId(m_xmmsClient->playlistCurrentActive(), idlist->at(0));
         
-        for (int i = 1; i < size; ++i) {
-            m_xmmsClient->playlistAddId(m_xmmsClient->playlistCurrentActive(), idlist->at(i));
+        if (size > 1) {
+            xmms2::Collection rest(xmms2::Collection::Type::Idlist);
+            for (int i = 1; i < size; ++i) {
+                rest.append(idlist->at(i));
+            }
+            m_xmmsClient->playlistAddIdList(m_xmmsClient->playlistCurrentActive(), rest);
         }
     });
 }
@@ -55,8 +55,9 @@ private:
     void directoryLoadFailed(const Dir& dir, const std::string& error);
     
     void addItemToActivePlaylist();
-    void activePlaylistAddFileOrDirectory(int item, bool beQuiet = false);
-    void activePlaylistAddFile(int item, bool beQuiet = false);
+    // Requests are added to the group if it is given, otherwise a status message is shown
+    void activePlaylistAddFileOrDirectory(int item, xmms2::RequestGroup *group = nullptr);
+    void activePlaylistAddFile(int item, xmms2::RequestGroup *group = nullptr);
     void activePlaylistPlayItem(int item);
     void activePlaylistPlayFile(const std::string& url);
     void activePlaylistPlayPlaylistFile(const std::string& url);
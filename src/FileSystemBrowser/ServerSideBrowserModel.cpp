@@ -35,21 +35,21 @@ ServerSideBrowserModel::~ServerSideBrowserModel()
 
 void ServerSideBrowserModel::setDirectory(const Dir& dir)
 {
-    m_xmmsClient->xformMediaBrowse(dir.url())(&ServerSideBrowserModel::getDirectoryItems, this,
-                                              dir, std::placeholders::_1);
+    m_xmmsClient->xformMediaBrowse(dir.url()).supersede(m_browseRequest)(&ServerSideBrowserModel::getDirectoryItems, this,
+                                                                               dir, std::placeholders::_1);
 }
 
 const std::string& ServerSideBrowserModel::fileName(int item) const
 {
     assert(item >= 0 && (size_t)item < m_items.size());
-    return m_items[item].name;
+    return m_items[item].name.str();
 }
 
 std::string ServerSideBrowserModel::fileUrl(int item) const
 {
     assert(item >= 0 && (size_t)item < m_items.size());
     // NOTE: Item may not be a directory, but Dir class doesn't care ...
-    return Dir(m_dir).cd(m_items[item].name).url();
+    return Dir(m_dir).cd(m_items[item].name.str()).url();
 }
 
 bool ServerSideBrowserModel::isDirectory(int item) const
@@ -60,15 +60,15 @@ bool ServerSideBrowserModel::isDirectory(int item) const
 
 int ServerSideBrowserModel::fileIndex(const std::string& name) const
 {
-    Item item(name, true);
+    Item item(PooledString(name), true);
     auto it = std::lower_bound(m_items.begin(), m_items.end(), item);
-    if (it != m_items.end() && it->name == name) {
+    if (it != m_items.end() && it->name.str() == name) {
         return it - m_items.begin();
     }
     
     item.isDir = false;
     it = std::lower_bound(m_items.begin(), m_items.end(), item);
-    if (it != m_items.end() && it->name == name) {
+    if (it != m_items.end() && it->name.str() == name) {
         return it - m_items.begin();
     }
     
@@ -82,7 +82,7 @@ const Dir& ServerSideBrowserModel::directory() const
 
 void ServerSideBrowserModel::data(int item, ListModelItemData *itemData) const
 {
-    itemData->textPtr = &m_items[item].name;
+    itemData->textPtr = &m_items[item].name.str();
 }
 
 int ServerSideBrowserModel::itemsCount() const
@@ -108,25 +108,30 @@ void ServerSideBrowserModel::getDirectoryItems(const Dir& dir,
     
     // Explicitly add .. item
     if (!m_dir.isRootPath()) {
-        m_items.emplace_back("..", true);
+        m_items.emplace_back(PooledString(".."), true);
     }
     
-    for (auto it = list->getIterator(); it.isValid(); it.next()) {
-        bool ok = false;
-        xmms2::Dict dict = it.value(&ok);
-        if (NCXMMS2_UNLIKELY(!ok))
-            continue;
-        
-        StringRef path = dict.value<StringRef>("path");
-        if (NCXMMS2_UNLIKELY(path.isNull()))
-            continue;
+    struct Row
+    {
+        StringRef path;
+        PooledString name;
+        int isDir;
+    };
+    xmms2::DictListDecoder<Row> decoder;
+    decoder.field("path", &Row::path)
+           .fileNameField("path", &Row::name)
+           .field("isdir", &Row::isDir, 0);
+    
+    m_items.reserve(m_items.size() + list->size());
+    decoder.decode(*list, [this](Row& row){
+        if (NCXMMS2_UNLIKELY(row.path.isNull()))
+            return;
         
-        if (NCXMMS2_UNLIKELY(path == "." || path == ".."))
-            continue;
+        if (NCXMMS2_UNLIKELY(row.path == "." || row.path == ".."))
+            return;
         
-        bool isDir = dict.value<int>("isdir", 0);
-        m_items.emplace_back(xmms2::getFileNameFromUrl(xmms2::decodeUrl(path.c_str())), isDir);
-    }
+        m_items.emplace_back(std::move(row.name), row.isDir);
+    });
     
     std::sort(m_items.begin(), m_items.end());
     
@@ -46,22 +46,22 @@ public:
     
 private:
     xmms2::Client *m_xmmsClient;
+    xmms2::RequestKey m_browseRequest;
     Dir m_dir;
     
     struct Item
     {
-        std::string name;
+        PooledString name;
         bool isDir;
         
-        template <typename Str>
-        Item(Str&& name, bool isDir_) : name(std::forward<Str>(name)), isDir(isDir_) {}
+        Item(PooledString name_, bool isDir_) : name(std::move(name_)), isDir(isDir_) {}
         
         friend bool operator<(const Item& item1, const Item& item2)
         {
-            if (item1.name == "..")
+            if (item1.name.str() == "..")
                 return true;
             
-            if (item2.name == "..")
+            if (item2.name.str() == "..")
                 return false;
 
             if (item1.isDir && !item2.isDir)
@@ -70,7 +70,7 @@ private:
             if (!item1.isDir && item2.isDir)
                 return false;
     
-            return item1.name < item2.name;
+            return item1.name.str() < item2.name.str();
         }
     };
     std::vector<Item> m_items;
@@ -55,6 +55,9 @@ HelpBrowser::HelpBrowser(const Rectangle& rect, Window *parent) :
         {"Unselect items by regular expression", '\\'               },
         {"Jump to next selected item",           '.'                },
         {"Jump to previous selected item",       ','                },
+        {"Find items as you type",               '/'                },
+        {"Jump to next found item",              'n'                },
+        {"Jump to previous found item",          'N'                },
         {nullptr, 0}
     };
 
@@ -97,6 +97,54 @@ void ListViewAppIntegrated::keyPressedEvent(const KeyEvent& keyEvent)
             break;
         }
 
+        case '/': // Find items as you type
+        {
+            const int oldCurrentItem = currentItem();
+            const std::string oldPattern = searchPattern();
+            auto resultCallback = [this, oldCurrentItem, oldPattern](const std::string& pattern,
+                                                                   LineEdit::Result result)
+            {
+                if (result == LineEdit::Result::Rejected) {
+                    setSearchPattern(oldPattern);
+                    setCurrentItem(oldCurrentItem);
+                    return;
+                }
+
+                const int matches = setSearchPattern(pattern);
+                if (matches) {
+                    StatusArea::showMessage("%d items found", matches);
+                } else if (!pattern.empty()) {
+                    StatusArea::showMessage("Pattern not found: %s", pattern);
+                }
+            };
+            auto patternChangedCallback = [this, oldCurrentItem](const std::string& pattern)
+            {
+                // Every new pattern is looked for from the item search started at
+                setCurrentItem(oldCurrentItem);
+                setSearchPattern(pattern);
+            };
+            StatusArea::askQuestion("Find: ", resultCallback, std::string(), patternChangedCallback);
+            break;
+        }
+
+        case 'n': // Jump to next found item
+        case 'N': // Jump to previous found item
+        {
+            if (searchPattern().empty()) {
+                StatusArea::showMessage("No search pattern!");
+                return;
+            }
+            const int oldCurrentItem = currentItem();
+            const bool next = keyEvent.key() == 'n';
+            if (!(next ? jumpToNextSearchMatch() : jumpToPreviousSearchMatch())) {
+                StatusArea::showMessage("Pattern not found: %s", searchPattern());
+            } else if (next ? currentItem() <= oldCurrentItem : currentItem() >= oldCurrentItem) {
+                StatusArea::showMessage(next ? "Search hit bottom, continuing at top"
+                                             : "Search hit top, continuing at bottom");
+            }
+            break;
+        }
+
         default: ListView::keyPressedEvent(keyEvent);
     }
 }
@@ -14,11 +14,14 @@
  *  GNU General Public License for more details.
  */
 
+#include <algorithm>
 #include <assert.h>
 
 #include "AlbumsListModel.h"
+#include "MedialibIndex.h"
 #include "../StatusArea/StatusArea.h"
 #include "../XmmsUtils/Client.h"
+#include "../Utils.h"
 #include "../Log.h"
 
 #include "../lib/ListModelItemData.h"
@@ -28,13 +31,26 @@ using namespace ncxmms2;
 AlbumsListModel::AlbumsListModel(xmms2::Client *xmmsClient, Object *parent) :
     ListModel(parent),
     m_xmmsClient(xmmsClient),
+    m_medialibIndex(nullptr),
+    m_hasFilter(false),
     m_filterTag(Song::Tag::Artist)
 {
     m_sortingOrder = {"date", "artist", "album"};
 }
 
+void AlbumsListModel::setMedialibIndex(const MedialibIndex *index)
+{
+    m_medialibIndex = index;
+}
+
 void AlbumsListModel::setFilterByTag(Song::Tag tag, const std::string& tagValue)
 {
+    // Current item of the tag values list moves when values are inserted above
+    // it, albums don't need to be reloaded then
+    if (m_hasFilter && m_filterTag == tag && m_filterTagValue == tagValue)
+        return;
+
+    m_hasFilter = true;
     m_filterTag = tag;
     m_filterTagValue = tagValue;
     refresh();
@@ -97,11 +113,17 @@ int AlbumsListModel::itemsCount() const
 void AlbumsListModel::refresh()
 {
     m_albums.clear();
+    if (m_medialibIndex && m_medialibIndex->isLoaded()) {
+        m_albumsRequest.cancel();
+        getAlbumsFromIndex(&m_albums);
+        reset();
+        return;
+    }
     
-    const std::vector<std::string>    fetch = {"artist", "album"};
+    const std::vector<std::string>    fetch = {"artist", "album", "date"};
     const std::vector<std::string>& groupBy = {"album"};
     
-    m_xmmsClient->collectionQueryInfos(getAlbumsCollection(), fetch, m_sortingOrder, groupBy)(
+    m_xmmsClient->collectionQueryInfos(getAlbumsCollection(), fetch, m_sortingOrder, groupBy).supersede(m_albumsRequest)(
         &AlbumsListModel::getAlbumsList, this);
     
     reset();
@@ -128,7 +150,69 @@ void AlbumsListModel::getAlbumsList(const xmms2::Expected<xmms2::List<xmms2::Dic
             continue;
         StringRef artist = dict.value<StringRef>("artist", "");
         StringRef album = dict.value<StringRef>("album", "");
-        m_albums.push_back({artist.c_str(), album.c_str()});
+        StringRef date = dict.value<StringRef>("date", "");
+        m_albums.push_back({artist.c_str(), album.c_str(), date.c_str()});
     }
     reset();
 }
+
+void AlbumsListModel::addEntries(const xmms2::List<xmms2::Dict>& entries)
+{
+    if (!m_hasFilter)
+        return;
+
+    for (auto it = entries.getIterator(); it.isValid(); it.next()) {
+        bool ok = false;
+        xmms2::Dict dict = it.value(&ok);
+        if (NCXMMS2_UNLIKELY(!ok))
+            continue;
+        if (m_filterTagValue != dict.value<StringRef>(Song::getTagKey(m_filterTag).c_str(), "").c_str())
+            continue;
+
+        AlnumData data;
+        data.album = dict.value<StringRef>("album", "").c_str();
+        // Albums are grouped by name
+        auto sameAlbum = [&data](const AlnumData& album){return album.album == data.album;};
+        if (std::any_of(m_albums.begin(), m_albums.end(), sameAlbum))
+            continue;
+        data.artist = dict.value<StringRef>("artist", "").c_str();
+        data.date = dict.value<StringRef>("date", "").c_str();
+
+        auto position = std::upper_bound(m_albums.begin(), m_albums.end(), data, lessAlbum);
+        const int item = position - m_albums.begin();
+        m_albums.insert(position, std::move(data));
+        itemsInserted(item, 1);
+    }
+}
+
+void AlbumsListModel::updateFromIndex()
+{
+    if (!m_hasFilter || !m_medialibIndex || !m_medialibIndex->isLoaded())
+        return;
+
+    std::vector<AlnumData> albums;
+    getAlbumsFromIndex(&albums);
+    updateSortedRows(&m_albums, std::move(albums), lessAlbum);
+}
+
+bool AlbumsListModel::lessAlbum(const AlnumData& left, const AlnumData& right)
+{
+    // Same as m_sortingOrder
+    int result = Utils::compareMedialibStrings(left.date, right.date);
+    if (result == 0)
+        result = Utils::compareMedialibStrings(left.artist, right.artist);
+    if (result == 0)
+        result = Utils::compareMedialibStrings(left.album, right.album);
+    return result < 0;
+}
+
+void AlbumsListModel::getAlbumsFromIndex(std::vector<AlnumData> *albums) const
+{
+    std::vector<MedialibIndex::AlbumEntry> entries;
+    m_medialibIndex->getAlbums(m_filterTag, m_filterTagValue, &entries);
+    albums->clear();
+    albums->reserve(entries.size());
+    for (auto& entry : entries) {
+        albums->push_back({std::move(entry.artist), std::move(entry.album), std::move(entry.date)});
+    }
+}
@@ -27,13 +27,19 @@ namespace ncxmms2 {
 namespace xmms2 {
 class Client;
 }
+class MedialibIndex;
 
 class AlbumsListModel : public ListModel
 {
 public:
     AlbumsListModel(xmms2::Client *xmmsClient, Object *parent = nullptr);
 
+    // Albums are taken from the index once it is loaded
+    void setMedialibIndex(const MedialibIndex *index);
+
     void setFilterByTag(Song::Tag tag, const std::string & tagValue);
+    Song::Tag filterTag() const {return m_filterTag;}
+    const std::string& filterTagValue() const {return m_filterTagValue;}
 
     const std::string& album(int item) const;
 
@@ -47,9 +53,18 @@ public:
 
     virtual void refresh();
 
+    // Inserts albums of newly added medialib entries matching the filter
+    void addEntries(const xmms2::List<xmms2::Dict>& entries);
+
+    // Takes albums from the loaded index again, see TagValueListModel::updateFromIndex
+    void updateFromIndex();
+
 private:
     xmms2::Client *m_xmmsClient;
+    const MedialibIndex *m_medialibIndex;
+    xmms2::RequestKey m_albumsRequest;
 
+    bool m_hasFilter;
     Song::Tag m_filterTag;
     std::string m_filterTagValue;
 
@@ -59,9 +74,17 @@ private:
     {
         std::string artist;
         std::string album;
+        std::string date;
+
+        bool operator==(const AlnumData& other) const
+        {
+            return artist == other.artist && album == other.album && date == other.date;
+        }
     };
     std::vector<AlnumData> m_albums;
 
+    static bool lessAlbum(const AlnumData& left, const AlnumData& right);
+    void getAlbumsFromIndex(std::vector<AlnumData> *albums) const;
     void getAlbumsList(const xmms2::Expected<xmms2::List<xmms2::Dict>>& list);
 };
 } // ncxmms2
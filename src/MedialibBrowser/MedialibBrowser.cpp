@@ -23,10 +23,12 @@
 #include "TagValueListModel.h"
 #include "AlbumsListModel.h"
 #include "SongsListModel.h"
+#include "MedialibIndex.h"
 
 #include "../XmmsUtils/Client.h"
 #include "../ListViewAppIntegrated/ListViewAppIntegrated.h"
 #include "../StatusArea/StatusArea.h"
+#include "../Settings.h"
 #include "../Hotkeys.h"
 #include "../Log.h"
 
@@ -38,7 +40,9 @@ using namespace ncxmms2;
 
 MedialibBrowser::MedialibBrowser(xmms2::Client *xmmsClient, const Rectangle& rect, Window *parent) :
     Window(rect, parent),
-    m_xmmsClient(xmmsClient)
+    m_xmmsClient(xmmsClient),
+    m_medialibIndex(nullptr),
+    m_listViewToRefresh(nullptr)
 {
     setName("Medialib browser");
     loadPalette("MedialibBrowser");
@@ -49,7 +53,7 @@ MedialibBrowser::MedialibBrowser(xmms2::Client *xmmsClient, const Rectangle& rec
     m_primaryTagListView = new ListViewAppIntegrated(artistsListViewRect, this);
     m_primaryTagListView->setModel(new TagValueListModel(m_xmmsClient, this));
 
-    m_primaryTagListView->currentItemChanged_Connect(&MedialibBrowser::setAlbumsListViewFilterTag, this);
+    m_primaryTagListView->currentItemSettled_Connect(&MedialibBrowser::setAlbumsListViewFilterTag, this);
     m_primaryTagListView->itemEntered_Connect(&MedialibBrowser::activePlaylistPlayByPrimaryTag, this);
     m_primaryTagListView->setFocus();
 
@@ -58,7 +62,7 @@ MedialibBrowser::MedialibBrowser(xmms2::Client *xmmsClient, const Rectangle& rec
                                        albumsListViewCols, lines() - HeaderLines);
     m_albumsListView = new ListViewAppIntegrated(albumsListViewRect, this);
     m_albumsListView->setModel(new AlbumsListModel(m_xmmsClient, this));
-    m_albumsListView->currentItemChanged_Connect(&MedialibBrowser::setSongsListViewAlbum, this);
+    m_albumsListView->currentItemSettled_Connect(&MedialibBrowser::setSongsListViewAlbum, this);
     m_albumsListView->itemEntered_Connect(&MedialibBrowser::activePlaylistPlayAlbum, this);
 
     const int songsListViewCols = cols() - artistsListViewCols - albumsListViewCols - 2;
@@ -68,13 +72,19 @@ MedialibBrowser::MedialibBrowser(xmms2::Client *xmmsClient, const Rectangle& rec
     m_songsListView->setModel(new SongsListModel(m_xmmsClient, this));
     m_songsListView->itemEntered_Connect(&MedialibBrowser::activePlaylistPlaySong, this);
 
-    // This will reload the whole medialib on adding new medialib entry.
-    // TODO: Can it be done in a more clever way?
-    m_xmmsClient->medialibEntryAdded_Connect([this](const xmms2::Expected<int>& id)
-    {
-        NCXMMS2_UNUSED(id);
-        m_primaryTagListView->model()->refresh();
-    });
+    if (Settings::value("MedialibBrowserScreen", "localIndex", true)) {
+        m_medialibIndex = new MedialibIndex(m_xmmsClient, this);
+        m_medialibIndex->loaded_Connect(&MedialibBrowser::handleMedialibIndexLoad, this);
+        static_cast<TagValueListModel*>(m_primaryTagListView->model())->setMedialibIndex(m_medialibIndex);
+        static_cast<AlbumsListModel*>(m_albumsListView->model())->setMedialibIndex(m_medialibIndex);
+        static_cast<SongsListModel*>(m_songsListView->model())->setMedialibIndex(m_medialibIndex);
+    }
+
+    m_updatedEntriesTimer.setSingleShot(true);
+    m_updatedEntriesTimer.timeout_Connect(&MedialibBrowser::requestUpdatedEntries, this);
+    m_xmmsClient->medialibEntryAdded_Connect(&MedialibBrowser::handleMedialibEntryUpdate, this);
+    m_xmmsClient->medialibEntryChanged_Connect(&MedialibBrowser::handleMedialibEntryUpdate, this);
+    m_xmmsClient->medialibEntryRemoved_Connect(&MedialibBrowser::handleMedialibEntryRemove, this);
 }
 
 void MedialibBrowser::keyPressedEvent(const KeyEvent& keyEvent)
@@ -108,32 +118,13 @@ void MedialibBrowser::keyPressedEvent(const KeyEvent& keyEvent)
         case Hotkeys::Screens::MedialibBrowser::AddItemToActivePlaylist:
         {
             const int currentItem = activeListView->currentItem();
-            const std::vector<int>& selectedItems = activeListView->selectedItems();
-
-#define ADD_ITEMS_TO_ACTIVE_PLAYLIST(addFunction, itemDescription)                      \
-    do {                                                                                \
-        if (!selectedItems.empty()) {                                                   \
-            for (int item : selectedItems) {                                            \
-                addFunction(item, true);                                                \
-            }                                                                           \
-            StatusArea::showMessage("Adding %s " itemDescription " to active playlist", \
-                                    selectedItems.size());                              \
-            activeListView->clearSelection();                                           \
-        } else {                                                                        \
-            if (currentItem != -1)                                                      \
-                addFunction(currentItem);                                               \
-        }                                                                               \
-    } while (0)
-
-            if (activeListView == m_songsListView) {
-                ADD_ITEMS_TO_ACTIVE_PLAYLIST(activePlaylistAddSong, "songs");
-            } else if (activeListView == m_albumsListView) {
-                ADD_ITEMS_TO_ACTIVE_PLAYLIST(activePlaylistAddAlbum, "albums");
-            } else if (activeListView == m_primaryTagListView) {
-                ADD_ITEMS_TO_ACTIVE_PLAYLIST(activePlaylistAddByPrimaryTag, "items");
+            const ItemSelection& selectedItems = activeListView->selectedItems();
+            if (!selectedItems.empty()) {
+                activePlaylistAddItems(activeListView, selectedItems.items());
+                activeListView->clearSelection();
+            } else if (currentItem != -1) {
+                activePlaylistAddItems(activeListView, {currentItem});
             }
-
-#undef ADD_ITEMS_TO_ACTIVE_PLAYLIST
             break;
         }
 
@@ -147,7 +138,13 @@ void MedialibBrowser::keyPressedEvent(const KeyEvent& keyEvent)
             break;
             
         case Hotkeys::Screens::MedialibBrowser::Refresh:
-            activeListView->model()->refresh();
+            if (m_medialibIndex) {
+                // List is refreshed from the reloaded index
+                m_listViewToRefresh = activeListView;
+                m_medialibIndex->load();
+            } else {
+                activeListView->model()->refresh();
+            }
             break;
 
         case Hotkeys::Screens::MedialibBrowser::SetPrimaryTag:
@@ -197,6 +194,10 @@ void MedialibBrowser::paint(const Rectangle& rect)
 
 void MedialibBrowser::showEvent()
 {
+    if (m_medialibIndex && !m_medialibIndex->isLoaded() && !m_medialibIndex->isLoading())
+        m_medialibIndex->load();
+
+    // Until the index is loaded, lists are filled with server queries
     TagValueListModel *primaryListModel = static_cast<TagValueListModel*>(m_primaryTagListView->model());
     if (primaryListModel->itemsCount() == 0)
         primaryListModel->refresh();
@@ -276,69 +277,95 @@ void MedialibBrowser::setSongsListViewAlbum(int item)
     AlbumsListModel *albumsModel = static_cast<AlbumsListModel*>(m_albumsListView->model());
     SongsListModel  *songsModel = static_cast<SongsListModel*>(m_songsListView->model());
 
-    songsModel->setAlbum(albumsModel->getAlbumsCollection(),
+    songsModel->setAlbum(albumsModel->filterTag(), albumsModel->filterTagValue(),
                          item != -1 ? albumsModel->album(item) : std::string());
 }
 
-void MedialibBrowser::activePlaylistAddSong(int item, bool beQuiet)
-{
-    SongsListModel *songsModel = static_cast<SongsListModel*>(m_songsListView->model());
-    m_xmmsClient->playlistAddId(m_xmmsClient->playlistCurrentActive(), songsModel->songId(item));
-    if (!beQuiet)
-        StatusArea::showMessage("Adding \"%s\" song to active playlist", songsModel->title(item));
-}
-
-void MedialibBrowser::activePlaylistAddAlbum(int item, bool beQuiet)
-{
-    AlbumsListModel *albumsModel = static_cast<AlbumsListModel*>(m_albumsListView->model());
-    SongsListModel  *songsModel = static_cast<SongsListModel*>(m_songsListView->model());
-    const auto album  = albumsModel->album(item);
-    auto albumColl = SongsListModel::getSongsCollection(albumsModel->getAlbumsCollection(), album);
-
-    m_xmmsClient->playlistAddCollection(m_xmmsClient->playlistCurrentActive(), albumColl, songsModel->sortingOrder());
-    if (!beQuiet)
-        StatusArea::showMessage("Adding \"%s\" album to active playlist", album);
-}
-
-void MedialibBrowser::activePlaylistAddByPrimaryTag(int item, bool beQuiet)
+void MedialibBrowser::activePlaylistAddItems(ListView *listView, const std::vector<int>& items)
 {
     TagValueListModel *primaryListModel = static_cast<TagValueListModel*>(m_primaryTagListView->model());
-    AlbumsListModel  *albumsModel = static_cast<AlbumsListModel*>(m_albumsListView->model());
-    const auto primaryTag      = primaryListModel->tag();
-    const auto primaryTagValue = primaryListModel->tagValue(item);
-
-    xmms2::Collection            albumsColl = albumsModel->getAlbumsCollection();
-    const std::vector<std::string>    fetch = {"album"};
-    const std::vector<std::string>& groupBy = fetch;
+    AlbumsListModel   *albumsModel = static_cast<AlbumsListModel*>(m_albumsListView->model());
+    SongsListModel    *songsModel = static_cast<SongsListModel*>(m_songsListView->model());
+    const std::string& playlist = m_xmmsClient->playlistCurrentActive();
+
+    //   Songs of all items are added with one request. Ids are collected client
+    // side when they are known, otherwise the server resolves the union of items.
+    xmms2::RequestGroup group;
+    if (listView == m_songsListView || (m_medialibIndex && m_medialibIndex->isLoaded())) {
+        std::vector<int> ids;
+        if (listView == m_songsListView) {
+            for (int item : items) {
+                ids.push_back(songsModel->songId(item));
+            }
+        } else if (listView == m_albumsListView) {
+            for (int item : items) {
+                m_medialibIndex->appendSongIds(albumsModel->filterTag(), albumsModel->filterTagValue(),
+                                               albumsModel->album(item), &ids);
+            }
+        } else {
+            const Song::Tag primaryTag = primaryListModel->tag();
+            std::vector<MedialibIndex::AlbumEntry> albums;
+            for (int item : items) {
+                const std::string& primaryTagValue = primaryListModel->tagValue(item);
+                m_medialibIndex->getAlbums(primaryTag, primaryTagValue, &albums);
+                for (const auto& album : albums) {
+                    m_medialibIndex->appendSongIds(primaryTag, primaryTagValue, album.album, &ids);
+                }
+            }
+        }
 
-    m_xmmsClient->collectionQueryInfos(albumsColl, fetch, albumsModel->sortingOrder(), groupBy)(
-                &MedialibBrowser::activePlaylistAddAlbums, this, primaryTag, primaryTagValue, std::placeholders::_1, beQuiet);
-}
+        if (ids.empty())
+            return;
 
-void MedialibBrowser::activePlaylistAddAlbums(Song::Tag primaryTag,
-                                              const std::string& primaryTagValue,
-                                              const xmms2::Expected<xmms2::List<xmms2::Dict>>& list,
-                                              bool beQuiet)
-{
-    if (list.isError()) {
-        NCXMMS2_LOG_ERROR("%s", list.error());
-        return;
+        xmms2::Collection idlist(xmms2::Collection::Type::Idlist);
+        for (int id : ids) {
+            idlist.append(id);
+        }
+        group.add(m_xmmsClient->playlistAddIdList(playlist, idlist));
+
+        // All songs are added by one request, so they fail together
+        const int songsCount = ids.size();
+        group.finish([songsCount](int, const std::vector<xmms2::RequestGroup::ItemError>& errors){
+            StatusArea::showActivePlaylistAddErrors(songsCount, songsCount, "songs", errors);
+        });
+    } else {
+        xmms2::Collection songs(xmms2::Collection::Type::Union);
+        std::vector<std::string> order;
+        if (listView == m_albumsListView) {
+            const xmms2::Collection albumsColl = albumsModel->getAlbumsCollection();
+            for (int item : items) {
+                songs.addOperand(SongsListModel::getSongsCollection(albumsColl, albumsModel->album(item)));
+            }
+        } else {
+            const Song::Tag primaryTag = primaryListModel->tag();
+            for (int item : items) {
+                songs.addOperand(AlbumsListModel::getAlbumsCollection(primaryTag, primaryListModel->tagValue(item)));
+            }
+            order.push_back(Song::getTagKey(primaryTag).c_str());
+        }
+        order.insert(order.end(), albumsModel->sortingOrder().begin(), albumsModel->sortingOrder().end());
+        order.insert(order.end(), songsModel->sortingOrder().begin(), songsModel->sortingOrder().end());
+        group.add(m_xmmsClient->playlistAddCollection(playlist, songs, order));
+
+        // Songs of the items are resolved by the server, so only the items are counted
+        const int itemsCount = items.size();
+        group.finish([itemsCount](int, const std::vector<xmms2::RequestGroup::ItemError>& errors){
+            StatusArea::showActivePlaylistAddErrors(itemsCount, itemsCount, "items", errors);
+        });
     }
 
-    SongsListModel *songsModel = static_cast<SongsListModel*>(m_songsListView->model());
-
-    for (auto it = list->getIterator(); it.isValid(); it.next()) {
-        bool ok = false;
-        xmms2::Dict dict = it.value(&ok);
-        if (NCXMMS2_UNLIKELY(!ok))
-            continue;
-        std::string album = dict.value<std::string>("album");
-        auto albumColl = songsModel->getSongsCollection(AlbumsListModel::getAlbumsCollection(primaryTag, primaryTagValue), album);
-        m_xmmsClient->playlistAddCollection(m_xmmsClient->playlistCurrentActive(), albumColl, songsModel->sortingOrder());
+    if (items.size() > 1) {
+        const char *description = listView == m_songsListView ? "songs"
+                                  : listView == m_albumsListView ? "albums" : "items";
+        StatusArea::showMessage("Adding %s %s to active playlist", items.size(), description);
+    } else if (listView == m_songsListView) {
+        StatusArea::showMessage("Adding \"%s\" song to active playlist", songsModel->title(items.front()));
+    } else if (listView == m_albumsListView) {
+        StatusArea::showMessage("Adding \"%s\" album to active playlist", albumsModel->album(items.front()));
+    } else {
+        StatusArea::showMessage("Adding all albums of \"%s\" to active playlist",
+                                primaryListModel->tagValue(items.front()));
     }
-
-    if (!beQuiet)
-        StatusArea::showMessage("Adding all albums of \"%s\" to active playlist", primaryTagValue);
 }
 
 void MedialibBrowser::activePlaylistPlaySong(int item)
@@ -351,44 +378,47 @@ void MedialibBrowser::activePlaylistPlayAlbum(int item)
 {
     AlbumsListModel *albumsModel = static_cast<AlbumsListModel*>(m_albumsListView->model());
     SongsListModel  *songsModel = static_cast<SongsListModel*>(m_songsListView->model());
-    const auto album  = albumsModel->album(item);
+    const auto& album = albumsModel->album(item);
+
+    if (m_medialibIndex && m_medialibIndex->isLoaded()) {
+        std::vector<int> ids;
+        m_medialibIndex->appendSongIds(albumsModel->filterTag(), albumsModel->filterTagValue(), album, &ids);
+        activePlaylistPlayIds(ids);
+        return;
+    }
 
     auto albumColl = SongsListModel::getSongsCollection(albumsModel->getAlbumsCollection(), album);
-    activePlaylistPlayAlbumColl(albumColl, songsModel->sortingOrder());
+    activePlaylistPlaySongsColl(albumColl, songsModel->sortingOrder());
 }
 
-void MedialibBrowser::activePlaylistPlayAlbumColl(const xmms2::Collection& songs,
-                                                  const std::vector<std::string>& sortingOrder)
+void MedialibBrowser::activePlaylistPlayByPrimaryTag(int item)
 {
-    m_xmmsClient->collectionQueryInfos(songs, {"id"}, sortingOrder)(
-    [this](const xmms2::Expected<xmms2::List<xmms2::Dict>>& list)
-    {
-        if (list.isError()) {
-            NCXMMS2_LOG_ERROR("%s", list.error());
-            return;
-        }
-        
-        auto it = list->getIterator();
-        if (!it.isValid())
-            return;
-        bool ok = false;
-        xmms2::Dict dict = it.value(&ok);
-        if (!ok)
-            return;
-        m_xmmsClient->playlistPlayId(m_xmmsClient->playlistCurrentActive(), dict.value<int>("id"));
-        it.next();
-        
-        for (; it.isValid(); it.next()) {
-            dict = it.value(&ok);
-            if (NCXMMS2_UNLIKELY(!ok))
-                continue;
-            m_xmmsClient->playlistAddId(m_xmmsClient->playlistCurrentActive(), dict.value<int>("id"));
+    TagValueListModel *primaryListModel = static_cast<TagValueListModel*>(m_primaryTagListView->model());
+    AlbumsListModel   *albumsModel = static_cast<AlbumsListModel*>(m_albumsListView->model());
+    SongsListModel    *songsModel = static_cast<SongsListModel*>(m_songsListView->model());
+
+    const Song::Tag primaryTag = primaryListModel->tag();
+    const std::string& primaryTagValue = primaryListModel->tagValue(item);
+
+    if (m_medialibIndex && m_medialibIndex->isLoaded()) {
+        std::vector<MedialibIndex::AlbumEntry> albums;
+        m_medialibIndex->getAlbums(primaryTag, primaryTagValue, &albums);
+        std::vector<int> ids;
+        for (const auto& album : albums) {
+            m_medialibIndex->appendSongIds(primaryTag, primaryTagValue, album.album, &ids);
         }
-    });
+        activePlaylistPlayIds(ids);
+        return;
+    }
+
+    // Songs of all albums of the tag value are queried at once, ordered by albums and then by songs
+    std::vector<std::string> order = albumsModel->sortingOrder();
+    order.insert(order.end(), songsModel->sortingOrder().begin(), songsModel->sortingOrder().end());
+    activePlaylistPlaySongsColl(AlbumsListModel::getAlbumsCollection(primaryTag, primaryTagValue), order);
 }
 
-void MedialibBrowser::activePlaylistAddAlbumColl(const xmms2::Collection& songs,
-                                                 const std::vector<std::string>& sortingOrder)
+void MedialibBrowser::activePlaylistPlaySongsColl(const xmms2::Collection& songs,
+                                                  const std::vector<std::string>& sortingOrder)
 {
     m_xmmsClient->collectionQueryInfos(songs, {"id"}, sortingOrder)(
     [this](const xmms2::Expected<xmms2::List<xmms2::Dict>>& list)
@@ -397,57 +427,136 @@ void MedialibBrowser::activePlaylistAddAlbumColl(const xmms2::Collection& songs,
             NCXMMS2_LOG_ERROR("%s", list.error());
             return;
         }
-        
+
+        std::vector<int> ids;
         for (auto it = list->getIterator(); it.isValid(); it.next()) {
             bool ok = false;
             xmms2::Dict dict = it.value(&ok);
             if (NCXMMS2_UNLIKELY(!ok))
                 continue;
-            m_xmmsClient->playlistAddId(m_xmmsClient->playlistCurrentActive(), dict.value<int>("id"));
+            ids.push_back(dict.value<int>("id"));
         }
+        activePlaylistPlayIds(ids);
     });
 }
 
-void MedialibBrowser::activePlaylistPlayByPrimaryTag(int item)
+void MedialibBrowser::activePlaylistPlayIds(const std::vector<int>& ids)
 {
-    TagValueListModel *primaryListModel = static_cast<TagValueListModel*>(m_primaryTagListView->model());
-    AlbumsListModel  *albumsModel = static_cast<AlbumsListModel*>(m_albumsListView->model());
+    if (ids.empty())
+        return;
 
-    const auto primaryTag        = primaryListModel->tag();
-    const auto primaryTagValue   = primaryListModel->tagValue(item);
-    xmms2::Collection albumsColl = AlbumsListModel::getAlbumsCollection(primaryTag, primaryTagValue);
+    // First song is played right away, the rest is added with one request
+    const std::string& playlist = m_xmmsClient->playlistCurrentActive();
+    m_xmmsClient->playlistPlayId(playlist, ids.front());
 
-    const std::vector<std::string>    fetch = {"album"};
-    const std::vector<std::string>& groupBy = fetch;
-    
-    m_xmmsClient->collectionQueryInfos(albumsColl, fetch, albumsModel->sortingOrder(), groupBy)(
-    [=](const xmms2::Expected<xmms2::List<xmms2::Dict>>& list)
-    {
-        if (list.isError()) {
-            NCXMMS2_LOG_ERROR("%s", list.error());
-            return;
-        }
-        SongsListModel *songsModel = static_cast<SongsListModel*>(m_songsListView->model());
-        
-        auto it = list->getIterator();
-        if (!it.isValid())
-            return;
-        bool ok = false;
-        xmms2::Dict dict = it.value(&ok);
-        if (!ok)
-            return;
-        std::string album = dict.value<std::string>("album");
-        auto albumColl = songsModel->getSongsCollection(AlbumsListModel::getAlbumsCollection(primaryTag, primaryTagValue), album);
-        activePlaylistPlayAlbumColl(albumColl, songsModel->sortingOrder());
-        it.next();
-        
-        for (; it.isValid(); it.next()) {
-            dict = it.value(&ok);
-            if (NCXMMS2_UNLIKELY(!ok))
-                continue;
-            album = dict.value<std::string>("album");
-            auto albumColl = songsModel->getSongsCollection(AlbumsListModel::getAlbumsCollection(primaryTag, primaryTagValue), album);
-            activePlaylistAddAlbumColl(albumColl, songsModel->sortingOrder());
+    xmms2::Collection idlist(xmms2::Collection::Type::Idlist);
+    for (auto it = ids.begin() + 1; it != ids.end(); ++it) {
+        idlist.append(*it);
+    }
+    if (idlist.size() > 0)
+        m_xmmsClient->playlistAddIdList(playlist, idlist);
+}
+
+void MedialibBrowser::handleMedialibIndexLoad()
+{
+    if (m_listViewToRefresh) {
+        m_listViewToRefresh->model()->refresh();
+        m_listViewToRefresh = nullptr;
+    }
+}
+
+void MedialibBrowser::handleMedialibEntryUpdate(const xmms2::Expected<int>& id)
+{
+    if (id.isError()) {
+        NCXMMS2_LOG_ERROR("%s", id.error());
+        return;
+    }
+
+    // Entries added or changed within a second are fetched with one query, so
+    // importing a big library updates the lists once in a while instead of on every file
+    m_updatedEntries.push_back(*id);
+    if (!m_updatedEntriesTimer.isActive())
+        m_updatedEntriesTimer.startMs(1000);
+}
+
+void MedialibBrowser::handleMedialibEntryRemove(const xmms2::Expected<int>& id)
+{
+    if (id.isError()) {
+        NCXMMS2_LOG_ERROR("%s", id.error());
+        return;
+    }
+
+    m_removedEntries.push_back(*id);
+    if (!m_updatedEntriesTimer.isActive())
+        m_updatedEntriesTimer.startMs(1000);
+}
+
+void MedialibBrowser::requestUpdatedEntries()
+{
+    std::vector<int> ids;
+    ids.swap(m_updatedEntries);
+    std::vector<int> removedIds;
+    removedIds.swap(m_removedEntries);
+
+    if (!removedIds.empty()) {
+        if (m_medialibIndex && m_medialibIndex->isLoaded()) {
+            if (m_medialibIndex->removeEntries(removedIds))
+                updateModelsFromIndex();
+        } else {
+            // Without the index albums and tag values left without songs
+            // stay in the lists until they are refreshed
+            static_cast<SongsListModel*>(m_songsListView->model())->removeEntries(removedIds);
         }
-    });
+    }
+    if (ids.empty())
+        return;
+
+    TagValueListModel *primaryListModel = static_cast<TagValueListModel*>(m_primaryTagListView->model());
+    if (primaryListModel->itemsCount() == 0) {
+        // Medialib is not loaded yet (it is loaded when the browser is shown) or was empty
+        if (!isHidden())
+            primaryListModel->refresh();
+        return;
+    }
+
+    xmms2::Collection idlist(xmms2::Collection::Type::Idlist);
+    for (int id : ids) {
+        idlist.append(id);
+    }
+
+    // Index keys include everything the lists need
+    m_xmmsClient->collectionQueryInfos(idlist, MedialibIndex::keys(), {})(&MedialibBrowser::getUpdatedEntries, this);
+}
+
+void MedialibBrowser::getUpdatedEntries(const xmms2::Expected<xmms2::List<xmms2::Dict>>& entries)
+{
+    if (entries.isError()) {
+        NCXMMS2_LOG_ERROR("%s", entries.error());
+        return;
+    }
+
+    // Changed entries can leave their old groups, the index knows whether
+    // a group is left empty, so the lists are compared with it
+    if (m_medialibIndex && m_medialibIndex->isLoaded()) {
+        if (m_medialibIndex->updateEntries(*entries))
+            updateModelsFromIndex();
+        return;
+    }
+
+    // Models insert new entries at their sorted positions, views keep
+    // the current item and selection on the same rows. Without the index
+    // only songs are moved out of their old album
+    TagValueListModel *primaryListModel = static_cast<TagValueListModel*>(m_primaryTagListView->model());
+    AlbumsListModel *albumsModel = static_cast<AlbumsListModel*>(m_albumsListView->model());
+    SongsListModel *songsModel = static_cast<SongsListModel*>(m_songsListView->model());
+    primaryListModel->addEntries(*entries);
+    albumsModel->addEntries(*entries);
+    songsModel->updateEntries(*entries);
+}
+
+void MedialibBrowser::updateModelsFromIndex()
+{
+    static_cast<TagValueListModel*>(m_primaryTagListView->model())->updateFromIndex();
+    static_cast<AlbumsListModel*>(m_albumsListView->model())->updateFromIndex();
+    static_cast<SongsListModel*>(m_songsListView->model())->updateFromIndex();
 }
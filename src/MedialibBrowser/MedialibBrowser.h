@@ -17,9 +17,11 @@
 #ifndef MEDIALIBBROWSER_H
 #define MEDIALIBBROWSER_H
 
+#include <vector>
 #include "../Song.h"
 #include "../XmmsUtils/Result.h"
 #include "../lib/Window.h"
+#include "../lib/Timer.h"
 
 namespace ncxmms2 {
 
@@ -27,6 +29,7 @@ namespace xmms2 {
 class Client;
 }
 class ListView;
+class MedialibIndex;
 
 class MedialibBrowser : public Window
 {
@@ -50,6 +53,13 @@ private:
     ListView *m_albumsListView;
     ListView *m_songsListView;
 
+    MedialibIndex *m_medialibIndex;
+    ListView *m_listViewToRefresh;
+
+    std::vector<int> m_updatedEntries;
+    std::vector<int> m_removedEntries;
+    Timer m_updatedEntriesTimer;
+
     enum
     {
       HeaderLines = 2
@@ -63,17 +73,21 @@ private:
     void setAlbumsListViewFilterTag(int item);
     void setSongsListViewAlbum(int item);
 
-    void activePlaylistAddSong(int item, bool beQuiet = false);
-    void activePlaylistAddAlbum(int item, bool beQuiet = false);
-    void activePlaylistAddByPrimaryTag(int item, bool beQuiet = false);
-    void activePlaylistAddAlbums(Song::Tag primaryTag, const std::string& primaryTagValue,
-                                 const xmms2::Expected<xmms2::List<xmms2::Dict>>& list, bool beQuiet = false);
+    // Adds songs of the items of one of the list views
+    void activePlaylistAddItems(ListView *listView, const std::vector<int>& items);
     
     void activePlaylistPlaySong(int item);
     void activePlaylistPlayAlbum(int item);
-    void activePlaylistPlayAlbumColl(const xmms2::Collection& songs, const std::vector<std::string>& sortingOrder);
-    void activePlaylistAddAlbumColl(const xmms2::Collection& songs, const std::vector<std::string>& sortingOrder);
     void activePlaylistPlayByPrimaryTag(int item);
+    void activePlaylistPlaySongsColl(const xmms2::Collection& songs, const std::vector<std::string>& sortingOrder);
+    void activePlaylistPlayIds(const std::vector<int>& ids);
+
+    void handleMedialibIndexLoad();
+    void handleMedialibEntryUpdate(const xmms2::Expected<int>& id);
+    void handleMedialibEntryRemove(const xmms2::Expected<int>& id);
+    void requestUpdatedEntries();
+    void getUpdatedEntries(const xmms2::Expected<xmms2::List<xmms2::Dict>>& entries);
+    void updateModelsFromIndex();
 };
 } // ncxmms2
 
@@ -0,0 +1,563 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <glib.h>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+
+#include "MedialibIndex.h"
+#include "../XmmsUtils/Client.h"
+#include "../Log.h"
+
+#include "../lib/StringPool.h"
+#include "../lib/FlatHashMap.h"
+
+namespace ncxmms2 {
+
+class MedialibIndexPrivate
+{
+public:
+    MedialibIndexPrivate(MedialibIndex *_q, xmms2::Client *_xmmsClient) :
+        q(_q),
+        xmmsClient(_xmmsClient),
+        isLoaded(false),
+        isLoading(false)
+    {
+        clear();
+    }
+
+    ~MedialibIndexPrivate()
+    {
+        clear();
+    }
+
+    enum TagColumn
+    {
+        ColumnArtist,
+        ColumnAlbum,
+        ColumnAlbumArtist,
+        ColumnDate,
+        ColumnGenre,
+        ColumnComposer,
+        ColumnPerformer,
+        TagColumnsCount
+    };
+
+    MedialibIndex *q;
+    xmms2::Client *xmmsClient;
+    xmms2::RequestKey loadRequest;
+    bool isLoaded;
+    bool isLoading;
+
+    // Row of an entry is its position in every column
+    FlatHashMap<int, int> rows;
+    std::vector<int> ids;
+    std::vector<int> trackNumbers;
+    std::vector<StringPool::Handle> tags[TagColumnsCount];
+
+    // Titles and urls are unique for almost every song, so they are kept
+    // in one buffer as offsets instead of the string pool. Replaced texts
+    // are counted as dead bytes and dropped when the buffer is compacted
+    std::vector<uint32_t> titles;
+    std::vector<uint32_t> urls;
+    std::vector<char> textBuffer;
+    size_t deadTextBytes;
+
+    // Built on demand, dropped when entries change
+    mutable std::unordered_map<StringPool::Handle, std::vector<int>> postings[TagColumnsCount];
+    mutable bool postingsValid[TagColumnsCount];
+    mutable std::unordered_map<StringPool::Handle, std::string> collationKeys;
+
+    static Song::Tag columnTag(int column);
+    static TagColumn tagColumn(Song::Tag tag);
+
+    void clear();
+    void invalidatePostings();
+    bool updateEntry(const xmms2::Dict& dict);
+    void removeRows(const std::vector<bool>& removedRows);
+    bool setText(uint32_t *offset, const char *str);
+    void releaseText(uint32_t offset);
+    uint32_t appendText(const char *str);
+    void compactTextBuffer();
+    const char *text(uint32_t offset) const {return &textBuffer[offset];}
+
+    const std::vector<int> *findPostings(TagColumn column, const std::string& value) const;
+    void findSongRows(Song::Tag tag, const std::string& tagValue, const std::string& album,
+                      std::vector<int> *songRows) const;
+    int compare(StringPool::Handle left, StringPool::Handle right) const;
+
+    void getEntries(const xmms2::Expected<xmms2::List<xmms2::Dict>>& entries);
+};
+} // ncxmms2
+
+using namespace ncxmms2;
+
+MedialibIndex::MedialibIndex(xmms2::Client *xmmsClient, Object *parent) :
+    Object(parent),
+    d(new MedialibIndexPrivate(this, xmmsClient))
+{
+
+}
+
+MedialibIndex::~MedialibIndex()
+{
+
+}
+
+void MedialibIndex::load()
+{
+    d->isLoading = true;
+    d->xmmsClient->collectionQueryInfos(xmms2::Collection::universe(), keys(), {"id"}).supersede(d->loadRequest)(
+                &MedialibIndexPrivate::getEntries, d.get());
+}
+
+bool MedialibIndex::isLoaded() const
+{
+    return d->isLoaded;
+}
+
+bool MedialibIndex::isLoading() const
+{
+    return d->isLoading;
+}
+
+const std::vector<std::string>& MedialibIndex::keys()
+{
+    static const std::vector<std::string> keys = []() {
+        std::vector<std::string> result = {"id", "tracknr", "title", "url"};
+        for (int column = 0; column < MedialibIndexPrivate::TagColumnsCount; ++column) {
+            result.push_back(Song::getTagKey(MedialibIndexPrivate::columnTag(column)).c_str());
+        }
+        return result;
+    }();
+    return keys;
+}
+
+bool MedialibIndex::updateEntries(const xmms2::List<xmms2::Dict>& entries)
+{
+    // Entries received before the index is loaded are included in the loaded ones
+    if (!d->isLoaded)
+        return false;
+
+    bool changed = false;
+    for (auto it = entries.getIterator(); it.isValid(); it.next()) {
+        bool ok = false;
+        xmms2::Dict dict = it.value(&ok);
+        if (NCXMMS2_UNLIKELY(!ok))
+            continue;
+        if (d->updateEntry(dict))
+            changed = true;
+    }
+    // Most changes are play counts and other keys the index doesn't have
+    if (!changed)
+        return false;
+
+    d->invalidatePostings();
+    d->compactTextBuffer();
+    return true;
+}
+
+bool MedialibIndex::removeEntries(const std::vector<int>& ids)
+{
+    if (!d->isLoaded)
+        return false;
+
+    std::vector<bool> removedRows(d->ids.size(), false);
+    bool removed = false;
+    for (int id : ids) {
+        auto it = d->rows.find(id);
+        if (it != d->rows.end()) {
+            removedRows[(*it).second] = true;
+            removed = true;
+        }
+    }
+    if (!removed)
+        return false;
+
+    d->removeRows(removedRows);
+    d->invalidatePostings();
+    d->compactTextBuffer();
+    return true;
+}
+
+void MedialibIndex::getTagValues(Song::Tag tag, std::vector<PooledString> *values) const
+{
+    const MedialibIndexPrivate::TagColumn column = MedialibIndexPrivate::tagColumn(tag);
+    d->findPostings(column, std::string());
+
+    std::vector<StringPool::Handle> handles;
+    handles.reserve(d->postings[column].size());
+    for (const auto& pair : d->postings[column]) {
+        handles.push_back(pair.first);
+    }
+    std::sort(handles.begin(), handles.end(), [this](StringPool::Handle left, StringPool::Handle right){
+        return d->compare(left, right) < 0;
+    });
+
+    values->clear();
+    values->reserve(handles.size());
+    for (StringPool::Handle handle : handles) {
+        values->push_back(PooledString::fromHandle(handle));
+    }
+}
+
+void MedialibIndex::getAlbums(Song::Tag tag, const std::string& tagValue,
+                              std::vector<AlbumEntry> *albums) const
+{
+    albums->clear();
+    const std::vector<int> *rows = d->findPostings(MedialibIndexPrivate::tagColumn(tag), tagValue);
+    if (!rows)
+        return;
+
+    // Albums are grouped by name, artist and date are taken from the first song
+    const auto& albumColumn = d->tags[MedialibIndexPrivate::ColumnAlbum];
+    const auto& artistColumn = d->tags[MedialibIndexPrivate::ColumnArtist];
+    const auto& dateColumn = d->tags[MedialibIndexPrivate::ColumnDate];
+    FlatHashMap<StringPool::Handle, bool> seenAlbums;
+    std::vector<int> albumRows;
+    for (int row : *rows) {
+        bool& seen = seenAlbums[albumColumn[row]];
+        if (!seen) {
+            seen = true;
+            albumRows.push_back(row);
+        }
+    }
+
+    std::sort(albumRows.begin(), albumRows.end(), [&](int left, int right){
+        int result = d->compare(dateColumn[left], dateColumn[right]);
+        if (result == 0)
+            result = d->compare(artistColumn[left], artistColumn[right]);
+        if (result == 0)
+            result = d->compare(albumColumn[left], albumColumn[right]);
+        return result < 0;
+    });
+
+    albums->reserve(albumRows.size());
+    for (int row : albumRows) {
+        albums->push_back({StringPool::get(artistColumn[row]),
+                           StringPool::get(albumColumn[row]),
+                           StringPool::get(dateColumn[row])});
+    }
+}
+
+void MedialibIndex::getSongs(Song::Tag tag, const std::string& tagValue, const std::string& album,
+                             std::vector<SongEntry> *songs) const
+{
+    songs->clear();
+    std::vector<int> rows;
+    d->findSongRows(tag, tagValue, album, &rows);
+
+    songs->reserve(rows.size());
+    for (int row : rows) {
+        std::string title = d->text(d->titles[row]);
+        if (title.empty()) {
+            const char *url = d->text(d->urls[row]);
+            if (!*url)
+                continue;
+            title = xmms2::getFileNameFromUrl(xmms2::decodeUrl(url));
+        }
+        songs->push_back({d->ids[row], d->trackNumbers[row], std::move(title)});
+    }
+}
+
+void MedialibIndex::appendSongIds(Song::Tag tag, const std::string& tagValue, const std::string& album,
+                                  std::vector<int> *ids) const
+{
+    std::vector<int> rows;
+    d->findSongRows(tag, tagValue, album, &rows);
+
+    for (int row : rows) {
+        // Songs without title and url are not listed by getSongs
+        if (NCXMMS2_UNLIKELY(!*d->text(d->titles[row]) && !*d->text(d->urls[row])))
+            continue;
+        ids->push_back(d->ids[row]);
+    }
+}
+
+Song::Tag MedialibIndexPrivate::columnTag(int column)
+{
+    static const Song::Tag columnTags[TagColumnsCount] =
+    {
+        Song::Tag::Artist,
+        Song::Tag::Album,
+        Song::Tag::AlbumArtist,
+        Song::Tag::Year,
+        Song::Tag::Genre,
+        Song::Tag::Composer,
+        Song::Tag::Performer
+    };
+    assert(column >= 0 && column < TagColumnsCount);
+    return columnTags[column];
+}
+
+MedialibIndexPrivate::TagColumn MedialibIndexPrivate::tagColumn(Song::Tag tag)
+{
+    for (int column = 0; column < TagColumnsCount; ++column) {
+        if (columnTag(column) == tag)
+            return (TagColumn)column;
+    }
+    assert(false);
+    return ColumnArtist;
+}
+
+void MedialibIndexPrivate::clear()
+{
+    for (auto& column : tags) {
+        for (StringPool::Handle handle : column) {
+            StringPool::release(handle);
+        }
+        column.clear();
+    }
+    rows.clear();
+    ids.clear();
+    trackNumbers.clear();
+    titles.clear();
+    urls.clear();
+    // Offset 0 is an empty string
+    textBuffer.assign(1, '\0');
+    deadTextBytes = 0;
+    invalidatePostings();
+}
+
+void MedialibIndexPrivate::invalidatePostings()
+{
+    for (int column = 0; column < TagColumnsCount; ++column) {
+        postings[column].clear();
+        postingsValid[column] = false;
+    }
+    collationKeys.clear();
+}
+
+bool MedialibIndexPrivate::updateEntry(const xmms2::Dict& dict)
+{
+    const int id = dict.value<int>("id");
+    if (NCXMMS2_UNLIKELY(id <= 0))
+        return false;
+
+    bool changed = false;
+    int row = -1;
+    auto it = rows.find(id);
+    if (it != rows.end()) {
+        row = (*it).second;
+    } else {
+        changed = true;
+        row = ids.size();
+        rows[id] = row;
+        ids.push_back(id);
+        trackNumbers.push_back(-1);
+        for (auto& column : tags) {
+            column.push_back(0);
+        }
+        titles.push_back(0);
+        urls.push_back(0);
+    }
+
+    const int trackNumber = dict.value<int>("tracknr", -1);
+    if (trackNumbers[row] != trackNumber) {
+        trackNumbers[row] = trackNumber;
+        changed = true;
+    }
+    for (int column = 0; column < TagColumnsCount; ++column) {
+        StringRef value = dict.value<StringRef>(Song::getTagKey(columnTag(column)).c_str(), "");
+        const StringPool::Handle handle = StringPool::intern(value.c_str());
+        StringPool::release(tags[column][row]);
+        if (tags[column][row] != handle) {
+            tags[column][row] = handle;
+            changed = true;
+        }
+    }
+    if (setText(&titles[row], dict.value<StringRef>("title", "").c_str()))
+        changed = true;
+    if (setText(&urls[row], dict.value<StringRef>("url", "").c_str()))
+        changed = true;
+    return changed;
+}
+
+void MedialibIndexPrivate::removeRows(const std::vector<bool>& removedRows)
+{
+    // Rows keep their order, so albums still take artist and date from the lowest id
+    size_t keptRows = 0;
+    for (size_t row = 0; row < ids.size(); ++row) {
+        if (removedRows[row]) {
+            rows.erase(ids[row]);
+            for (auto& column : tags) {
+                StringPool::release(column[row]);
+            }
+            releaseText(titles[row]);
+            releaseText(urls[row]);
+            continue;
+        }
+        if (keptRows != row) {
+            ids[keptRows] = ids[row];
+            trackNumbers[keptRows] = trackNumbers[row];
+            for (auto& column : tags) {
+                column[keptRows] = column[row];
+            }
+            titles[keptRows] = titles[row];
+            urls[keptRows] = urls[row];
+            rows[ids[keptRows]] = keptRows;
+        }
+        ++keptRows;
+    }
+
+    ids.resize(keptRows);
+    trackNumbers.resize(keptRows);
+    for (auto& column : tags) {
+        column.resize(keptRows);
+    }
+    titles.resize(keptRows);
+    urls.resize(keptRows);
+}
+
+bool MedialibIndexPrivate::setText(uint32_t *offset, const char *str)
+{
+    // Unchanged text keeps its place in the buffer
+    if (std::strcmp(text(*offset), str) == 0)
+        return false;
+    releaseText(*offset);
+    *offset = appendText(str);
+    return true;
+}
+
+void MedialibIndexPrivate::releaseText(uint32_t offset)
+{
+    if (offset != 0)
+        deadTextBytes += std::strlen(text(offset)) + 1;
+}
+
+uint32_t MedialibIndexPrivate::appendText(const char *str)
+{
+    if (!*str)
+        return 0;
+    const uint32_t offset = textBuffer.size();
+    textBuffer.insert(textBuffer.end(), str, str + std::strlen(str) + 1);
+    return offset;
+}
+
+void MedialibIndexPrivate::compactTextBuffer()
+{
+    // Copying the live texts is only worth it once at least half of the buffer is dead
+    if (deadTextBytes < 256 * 1024 || deadTextBytes < textBuffer.size() / 2)
+        return;
+
+    std::vector<char> buffer;
+    buffer.reserve(textBuffer.size() - deadTextBytes);
+    buffer.push_back('\0');
+    auto moveText = [this, &buffer](uint32_t& offset){
+        if (offset == 0)
+            return;
+        const char *str = text(offset);
+        offset = buffer.size();
+        buffer.insert(buffer.end(), str, str + std::strlen(str) + 1);
+    };
+    for (size_t row = 0; row < ids.size(); ++row) {
+        moveText(titles[row]);
+        moveText(urls[row]);
+    }
+    textBuffer.swap(buffer);
+    deadTextBytes = 0;
+}
+
+const std::vector<int> *MedialibIndexPrivate::findPostings(TagColumn column, const std::string& value) const
+{
+    if (!postingsValid[column]) {
+        auto& columnPostings = postings[column];
+        const auto& columnTags = tags[column];
+        for (size_t row = 0; row < columnTags.size(); ++row) {
+            columnPostings[columnTags[row]].push_back(row);
+        }
+        postingsValid[column] = true;
+    }
+
+    // Interning finds the handle of the value, if it's not used anywhere,
+    // there are no postings for it
+    const StringPool::Handle handle = StringPool::intern(value);
+    auto it = postings[column].find(handle);
+    StringPool::release(handle);
+    return it != postings[column].end() ? &it->second : nullptr;
+}
+
+void MedialibIndexPrivate::findSongRows(Song::Tag tag, const std::string& tagValue, const std::string& album,
+                                        std::vector<int> *songRows) const
+{
+    const std::vector<int> *rows = findPostings(tagColumn(tag), tagValue);
+    if (!rows)
+        return;
+
+    const StringPool::Handle albumHandle = StringPool::intern(album);
+    const auto& albumColumn = tags[ColumnAlbum];
+    for (int row : *rows) {
+        if (albumColumn[row] == albumHandle)
+            songRows->push_back(row);
+    }
+    StringPool::release(albumHandle);
+
+    std::sort(songRows->begin(), songRows->end(), [this](int left, int right){
+        return trackNumbers[left] != trackNumbers[right]
+               ? trackNumbers[left] < trackNumbers[right]
+               : ids[left] < ids[right];
+    });
+}
+
+int MedialibIndexPrivate::compare(StringPool::Handle left, StringPool::Handle right) const
+{
+    if (left == right)
+        return 0;
+
+    // Same order as Utils::compareMedialibStrings, collation keys
+    // are computed once per string
+    auto collationKey = [this](StringPool::Handle handle) -> const std::string& {
+        auto it = collationKeys.find(handle);
+        if (it != collationKeys.end())
+            return it->second;
+        const std::string& str = StringPool::get(handle);
+        gchar *folded = g_utf8_casefold(str.c_str(), str.size());
+        gchar *key = g_utf8_collate_key(folded, -1);
+        std::string& result = collationKeys[handle];
+        result = key;
+        g_free(key);
+        g_free(folded);
+        return result;
+    };
+
+    const int result = collationKey(left).compare(collationKey(right));
+    if (result != 0)
+        return result;
+    // Values differing only by case are still different values
+    return StringPool::get(left).compare(StringPool::get(right));
+}
+
+void MedialibIndexPrivate::getEntries(const xmms2::Expected<xmms2::List<xmms2::Dict>>& entries)
+{
+    isLoading = false;
+    if (entries.isError()) {
+        NCXMMS2_LOG_ERROR("%s", entries.error());
+        return;
+    }
+
+    clear();
+    ids.reserve(entries->size());
+    for (auto it = entries->getIterator(); it.isValid(); it.next()) {
+        bool ok = false;
+        xmms2::Dict dict = it.value(&ok);
+        if (NCXMMS2_UNLIKELY(!ok))
+            continue;
+        updateEntry(dict);
+    }
+    isLoaded = true;
+    q->loaded();
+}
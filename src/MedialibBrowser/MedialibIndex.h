@@ -0,0 +1,95 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifndef MEDIALIBINDEX_H
+#define MEDIALIBINDEX_H
+
+#include <vector>
+#include <string>
+#include "../Song.h"
+#include "../XmmsUtils/Result.h"
+#include "../lib/Object.h"
+
+namespace ncxmms2 {
+
+namespace xmms2 {
+class Client;
+}
+
+class MedialibIndexPrivate;
+
+/*   MedialibIndex is a client side copy of medialib tags needed by the medialib
+ * browser, so that moving through its lists doesn't cost a server query per
+ * cursor move. The whole medialib is loaded with one query, then the index is
+ * kept up to date by feeding it with added, changed and removed entries.
+ *   Tags are stored by columns, entries with the same value of a tag are found
+ * with postings lists, which are built when the tag is first queried.
+ */
+class MedialibIndex : public Object
+{
+public:
+    MedialibIndex(xmms2::Client *xmmsClient, Object *parent = nullptr);
+    ~MedialibIndex();
+
+    // Requests the whole medialib, loaded is emitted when it's received
+    void load();
+    bool isLoaded() const;
+    bool isLoading() const;
+
+    // Medialib keys of the indexed tags, entries passed to updateEntries
+    // should be queried with them
+    static const std::vector<std::string>& keys();
+
+    // Both return whether any indexed value has changed, so that the lists
+    // need to be updated
+    bool updateEntries(const xmms2::List<xmms2::Dict>& entries);
+    bool removeEntries(const std::vector<int>& ids);
+
+    struct AlbumEntry
+    {
+        std::string artist;
+        std::string album;
+        std::string date;
+    };
+
+    struct SongEntry
+    {
+        int id;
+        int trackNumber;
+        std::string title;
+    };
+
+    // Results are sorted the same way as the corresponding medialib queries
+    // in TagValueListModel, AlbumsListModel and SongsListModel
+    void getTagValues(Song::Tag tag, std::vector<PooledString> *values) const;
+    void getAlbums(Song::Tag tag, const std::string& tagValue, std::vector<AlbumEntry> *albums) const;
+    void getSongs(Song::Tag tag, const std::string& tagValue, const std::string& album,
+                  std::vector<SongEntry> *songs) const;
+
+    // Appends ids of the songs getSongs would return, in the same order
+    void appendSongIds(Song::Tag tag, const std::string& tagValue, const std::string& album,
+                       std::vector<int> *ids) const;
+
+    // Signals
+    NCXMMS2_SIGNAL(loaded)
+
+private:
+    friend class MedialibIndexPrivate;
+    std::unique_ptr<MedialibIndexPrivate> d;
+};
+} // ncxmms2
+
+#endif // MEDIALIBINDEX_H
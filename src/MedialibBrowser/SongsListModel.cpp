@@ -14,9 +14,12 @@
  *  GNU General Public License for more details.
  */
 
+#include <algorithm>
 #include <assert.h>
 
 #include "SongsListModel.h"
+#include "AlbumsListModel.h"
+#include "MedialibIndex.h"
 #include "../StatusArea/StatusArea.h"
 #include "../XmmsUtils/Client.h"
 #include "../Log.h"
@@ -25,16 +28,69 @@
 
 using namespace ncxmms2;
 
+namespace {
+
+struct SongRow
+{
+    int id;
+    int trackNumber;
+    PooledString title;
+    StringRef url;
+    StringRef album;
+    StringRef filterTagValue;
+};
+
+xmms2::DictListDecoder<SongRow> songRowDecoder()
+{
+    xmms2::DictListDecoder<SongRow> decoder;
+    decoder.field("id", &SongRow::id)
+           .field("tracknr", &SongRow::trackNumber, -1)
+           .field("title", &SongRow::title)
+           .field("url", &SongRow::url);
+    return decoder;
+}
+
+// Takes the file name from url if the entry has no title,
+// returns false if it has neither title nor url
+bool fillSongTitle(SongRow *row, std::string *urlBuffer)
+{
+    if (NCXMMS2_UNLIKELY(row->title.empty()) && !row->url.isNull())
+        row->title = xmms2::getPooledFileNameFromUrl(row->url.c_str(), urlBuffer);
+    return !row->title.empty();
+}
+
+bool equals(const std::string& str, StringRef ref)
+{
+    return ref.isNull() ? str.empty() : str == ref.c_str();
+}
+
+}
+
 SongsListModel::SongsListModel(xmms2::Client *xmmsClient, Object *parent) :
     ListModel(parent),
-    m_xmmsClient(xmmsClient)
+    m_xmmsClient(xmmsClient),
+    m_medialibIndex(nullptr),
+    m_hasAlbum(false),
+    m_filterTag(Song::Tag::Artist)
 {
     m_sortingOrder = {"tracknr", "id"};
 }
 
-void SongsListModel::setAlbum(xmms2::Collection albumsColl, const std::string& album)
+void SongsListModel::setMedialibIndex(const MedialibIndex *index)
+{
+    m_medialibIndex = index;
+}
+
+void SongsListModel::setAlbum(Song::Tag filterTag, const std::string& filterTagValue, const std::string& album)
 {
-    m_albumsColl = make_unique<xmms2::Collection>(std::move(albumsColl));
+    // Current item of the albums list moves when albums are inserted above
+    // it, songs don't need to be reloaded then
+    if (m_hasAlbum && m_filterTag == filterTag && m_filterTagValue == filterTagValue && m_album == album)
+        return;
+
+    m_hasAlbum = true;
+    m_filterTag = filterTag;
+    m_filterTagValue = filterTagValue;
     m_album = album;
     refresh();
 }
@@ -48,7 +104,7 @@ int SongsListModel::songId(int item) const
 const std::string &SongsListModel::title(int item) const
 {
     assert(item >= 0 && (size_t)item < m_songs.size());
-    return m_songs[item].title;
+    return m_songs[item].title.str();
 }
 
 const std::vector<std::string>& SongsListModel::sortingOrder() const
@@ -58,7 +114,7 @@ const std::vector<std::string>& SongsListModel::sortingOrder() const
 
 void SongsListModel::data(int item, ListModelItemData *itemData) const
 {
-    itemData->textPtr = &m_songs[item].title;
+    itemData->textPtr = &m_songs[item].title.str();
 }
 
 int SongsListModel::itemsCount() const
@@ -68,9 +124,16 @@ int SongsListModel::itemsCount() const
 
 void SongsListModel::refresh()
 {
-    if (m_albumsColl) {
-        const std::vector<std::string> fetch = {"id", "title", "url"};
-        m_xmmsClient->collectionQueryInfos(getSongsCollection(), fetch, m_sortingOrder)(
+    if (m_hasAlbum && m_medialibIndex && m_medialibIndex->isLoaded()) {
+        m_songsRequest.cancel();
+        getSongsFromIndex(&m_songs);
+        reset();
+        return;
+    }
+
+    if (m_hasAlbum) {
+        const std::vector<std::string> fetch = {"id", "title", "url", "tracknr"};
+        m_xmmsClient->collectionQueryInfos(getSongsCollection(), fetch, m_sortingOrder).supersede(m_songsRequest)(
                     &SongsListModel::getSongsList, this, m_album, std::placeholders::_1);
     }
     
@@ -104,8 +167,8 @@ xmms2::Collection SongsListModel::getSongsCollection(const xmms2::Collection& al
 
 xmms2::Collection SongsListModel::getSongsCollection() const
 {
-    assert(m_albumsColl);
-    return getSongsCollection(*m_albumsColl, m_album);
+    assert(m_hasAlbum);
+    return getSongsCollection(AlbumsListModel::getAlbumsCollection(m_filterTag, m_filterTagValue), m_album);
 }
 
 void SongsListModel::getSongsList(const std::string& album, const xmms2::Expected<xmms2::List<xmms2::Dict>>& list)
@@ -115,28 +178,101 @@ void SongsListModel::getSongsList(const std::string& album, const xmms2::Expecte
         NCXMMS2_LOG_ERROR("%s", list.error());
         return;
     }
-    
-    if (album != m_album)
-        return;
+
+    xmms2::DictListDecoder<SongRow> decoder = songRowDecoder();
+    std::string urlBuffer;
 
     m_songs.clear();
-    for (auto it = list->getIterator(); it.isValid(); it.next()) {
-        bool ok = false;
-        xmms2::Dict dict = it.value(&ok);
-        if (NCXMMS2_UNLIKELY(!ok))
-            continue;
-        std::string title = dict.value<std::string>("title");
-        if (NCXMMS2_UNLIKELY(title.empty())) {
-            StringRef url = dict.value<StringRef>("url");
-            if (url.isNull())
-                continue;
-            title = xmms2::getFileNameFromUrl(xmms2::decodeUrl(url.c_str()));
+    m_songs.reserve(list->size());
+    decoder.decode(*list, [this, &urlBuffer](SongRow& row){
+        if (NCXMMS2_UNLIKELY(row.id == 0 || !fillSongTitle(&row, &urlBuffer)))
+            return;
+        m_songs.push_back({row.id, row.trackNumber, std::move(row.title)});
+    });
+
+    reset();
+}
+
+void SongsListModel::updateEntries(const xmms2::List<xmms2::Dict>& entries)
+{
+    if (!m_hasAlbum)
+        return;
+
+    xmms2::DictListDecoder<SongRow> decoder = songRowDecoder();
+    decoder.field("album", &SongRow::album)
+           .field(Song::getTagKey(m_filterTag).c_str(), &SongRow::filterTagValue);
+
+    std::string urlBuffer;
+    decoder.decode(entries, [&](SongRow& row){
+        if (NCXMMS2_UNLIKELY(row.id == 0))
+            return;
+        const bool belongs = equals(m_filterTagValue, row.filterTagValue) && equals(m_album, row.album)
+                             && fillSongTitle(&row, &urlBuffer);
+
+        auto sameId = [&row](const SongData& song){return song.id == row.id;};
+        auto it = std::find_if(m_songs.begin(), m_songs.end(), sameId);
+        if (it != m_songs.end()) {
+            const int item = it - m_songs.begin();
+            if (belongs && it->trackNumber == row.trackNumber) {
+                if (!(it->title == row.title)) {
+                    it->title = std::move(row.title);
+                    itemsChanged(item, item);
+                }
+                return;
+            }
+            // Entry has moved to another album or position
+            m_songs.erase(it);
+            itemsRemoved(item, 1);
         }
-        int id = dict.value<int>("id");
-        if (NCXMMS2_UNLIKELY(id == 0))
+        if (!belongs)
+            return;
+
+        SongData data{row.id, row.trackNumber, std::move(row.title)};
+        auto position = std::upper_bound(m_songs.begin(), m_songs.end(), data, lessSong);
+        const int item = position - m_songs.begin();
+        m_songs.insert(position, std::move(data));
+        itemsInserted(item, 1);
+    });
+}
+
+void SongsListModel::removeEntries(const std::vector<int>& ids)
+{
+    for (int id : ids) {
+        auto sameId = [id](const SongData& song){return song.id == id;};
+        auto it = std::find_if(m_songs.begin(), m_songs.end(), sameId);
+        if (it == m_songs.end())
             continue;
-        m_songs.push_back({id, std::move(title)});
+        const int item = it - m_songs.begin();
+        m_songs.erase(it);
+        itemsRemoved(item, 1);
     }
+}
 
-    reset();
+void SongsListModel::updateFromIndex()
+{
+    if (!m_hasAlbum || !m_medialibIndex || !m_medialibIndex->isLoaded())
+        return;
+
+    std::vector<SongData> songs;
+    getSongsFromIndex(&songs);
+    updateSortedRows(&m_songs, std::move(songs), lessSong);
+}
+
+bool SongsListModel::lessSong(const SongData& left, const SongData& right)
+{
+    // Same as m_sortingOrder
+    return left.trackNumber != right.trackNumber
+           ? left.trackNumber < right.trackNumber
+           : left.id < right.id;
+}
+
+void SongsListModel::getSongsFromIndex(std::vector<SongData> *songs) const
+{
+    std::vector<MedialibIndex::SongEntry> entries;
+    m_medialibIndex->getSongs(m_filterTag, m_filterTagValue, m_album, &entries);
+    songs->clear();
+    songs->reserve(entries.size());
+    for (auto& entry : entries) {
+        songs->push_back({entry.id, entry.trackNumber, PooledString(entry.title)});
+    }
 }
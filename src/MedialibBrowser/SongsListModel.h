@@ -18,6 +18,7 @@
 #define SONGSLISTMODEL_H
 
 #include <vector>
+#include "../Song.h"
 #include "../XmmsUtils/Result.h"
 #include "../lib/ListModel.h"
 
@@ -26,13 +27,18 @@ namespace ncxmms2 {
 namespace xmms2 {
 class Client;
 }
+class MedialibIndex;
 
 class SongsListModel : public ListModel
 {
 public:
     SongsListModel(xmms2::Client *xmmsClient, Object *parent = nullptr);
 
-    void setAlbum(xmms2::Collection albumsColl, const std::string& album);
+    // Songs are taken from the index once it is loaded
+    void setMedialibIndex(const MedialibIndex *index);
+
+    // Songs of the album among albums filtered by the tag value, see AlbumsListModel
+    void setAlbum(Song::Tag filterTag, const std::string& filterTagValue, const std::string& album);
 
     int songId(int item) const;
     const std::string& title(int item) const;
@@ -44,23 +50,42 @@ public:
 
     virtual void refresh();
 
+    // Inserts new entries which belong to the album, moves or removes changed ones
+    void updateEntries(const xmms2::List<xmms2::Dict>& entries);
+    void removeEntries(const std::vector<int>& ids);
+
+    // Takes songs from the loaded index again, see TagValueListModel::updateFromIndex
+    void updateFromIndex();
+
     static xmms2::Collection getSongsCollection(const xmms2::Collection& albumsColl, const std::string& album);
 
 private:
     xmms2::Client *m_xmmsClient;
+    const MedialibIndex *m_medialibIndex;
+    xmms2::RequestKey m_songsRequest;
 
-    std::unique_ptr<xmms2::Collection> m_albumsColl;
+    bool m_hasAlbum;
+    Song::Tag m_filterTag;
+    std::string m_filterTagValue;
     std::string m_album;
 
     struct SongData
     {
         int id;
-        std::string title;
+        int trackNumber;
+        PooledString title;
+
+        bool operator==(const SongData& other) const
+        {
+            return id == other.id && trackNumber == other.trackNumber && title == other.title;
+        }
     };
 
     std::vector<std::string> m_sortingOrder;
     std::vector<SongData> m_songs;
 
+    static bool lessSong(const SongData& left, const SongData& right);
+    void getSongsFromIndex(std::vector<SongData> *songs) const;
     xmms2::Collection getSongsCollection() const;
 
     void getSongsList(const std::string& album, const xmms2::Expected<xmms2::List<xmms2::Dict>>& list);
@@ -14,22 +14,41 @@
  *  GNU General Public License for more details.
  */
 
+#include <algorithm>
+
 #include "TagValueListModel.h"
+#include "MedialibIndex.h"
 #include "../XmmsUtils/Client.h"
+#include "../Utils.h"
 #include "../Log.h"
 
 #include "../lib/ListModelItemData.h"
 
 using namespace ncxmms2;
 
+namespace {
+
+bool lessTagValue(const PooledString& left, const PooledString& right)
+{
+    return Utils::compareMedialibStrings(left.str(), right.str()) < 0;
+}
+
+} // namespace
+
 TagValueListModel::TagValueListModel(xmms2::Client *xmmsClient, Object *parent) :
     ListModel(parent),
     m_xmmsClient(xmmsClient),
+    m_medialibIndex(nullptr),
     m_tag(Song::Tag::Artist)
 {
 
 }
 
+void TagValueListModel::setMedialibIndex(const MedialibIndex *index)
+{
+    m_medialibIndex = index;
+}
+
 void TagValueListModel::setTag(Song::Tag tag)
 {
     if (m_tag == tag)
@@ -42,13 +61,13 @@ void TagValueListModel::setTag(Song::Tag tag)
 const std::string &TagValueListModel::tagValue(int item) const
 {
     assert(item >= 0 && (size_t)item < m_tagValues.size());
-    return m_tagValues[item];
+    return m_tagValues[item].str();
 }
 
 void TagValueListModel::data(int item, ListModelItemData *itemData) const
 {
     static const std::string unknown = "<Unknown>";
-    itemData->textPtr = !m_tagValues[item].empty() ? &m_tagValues[item] : &unknown;
+    itemData->textPtr = !m_tagValues[item].empty() ? &m_tagValues[item].str() : &unknown;
 }
 
 int TagValueListModel::itemsCount() const
@@ -59,6 +78,12 @@ int TagValueListModel::itemsCount() const
 void TagValueListModel::refresh()
 {
     m_tagValues.clear();
+    if (m_medialibIndex && m_medialibIndex->isLoaded()) {
+        m_tagValuesRequest.cancel();
+        m_medialibIndex->getTagValues(m_tag, &m_tagValues);
+        reset();
+        return;
+    }
     reset();
 
     const xmms2::Collection allMedia = xmms2::Collection::universe();
@@ -66,7 +91,7 @@ void TagValueListModel::refresh()
     const std::vector<std::string>& order = fetch;
     const std::vector<std::string>& groupBy = fetch;
 
-    m_xmmsClient->collectionQueryInfos(allMedia, fetch, order, groupBy)(&TagValueListModel::getTagValueList, this);
+    m_xmmsClient->collectionQueryInfos(allMedia, fetch, order, groupBy).supersede(m_tagValuesRequest)(&TagValueListModel::getTagValueList, this);
 }
 
 void TagValueListModel::getTagValueList(const xmms2::Expected<xmms2::List<xmms2::Dict>> &list)
@@ -76,14 +101,53 @@ void TagValueListModel::getTagValueList(const xmms2::Expected<xmms2::List<xmms2:
         return;
     }
 
+    struct Row
+    {
+        PooledString value;
+    };
+    xmms2::DictListDecoder<Row> decoder;
+    decoder.field(Song::getTagKey(m_tag).c_str(), &Row::value);
+
     m_tagValues.clear();
-    for (auto it = list->getIterator(); it.isValid(); it.next()) {
-        bool ok = false;
-        xmms2::Dict dict = it.value(&ok);
-        if (NCXMMS2_UNLIKELY(!ok))
-            continue;
-        StringRef artist = dict.value<StringRef>(Song::getTagKey(m_tag).c_str(), "");
-        m_tagValues.emplace_back(artist.c_str());
-    }
+    m_tagValues.reserve(list->size());
+    decoder.decode(*list, [this](Row& row){
+        m_tagValues.push_back(std::move(row.value));
+    });
     reset();
 }
+
+void TagValueListModel::addEntries(const xmms2::List<xmms2::Dict>& entries)
+{
+    // Empty list is not loaded yet, it gets new values with the whole list
+    if (m_tagValues.empty())
+        return;
+
+    struct Row
+    {
+        PooledString value;
+    };
+    xmms2::DictListDecoder<Row> decoder;
+    decoder.field(Song::getTagKey(m_tag).c_str(), &Row::value);
+
+    decoder.decode(entries, [this](Row& row){
+        // Values are grouped by exact match, while sorting is case insensitive,
+        // so the whole range of equivalent values is checked
+        auto range = std::equal_range(m_tagValues.begin(), m_tagValues.end(), row.value, lessTagValue);
+        if (std::find(range.first, range.second, row.value) != range.second)
+            return;
+
+        const int item = range.second - m_tagValues.begin();
+        m_tagValues.insert(range.second, std::move(row.value));
+        itemsInserted(item, 1);
+    });
+}
+
+void TagValueListModel::updateFromIndex()
+{
+    if (!m_medialibIndex || !m_medialibIndex->isLoaded())
+        return;
+
+    std::vector<PooledString> tagValues;
+    m_medialibIndex->getTagValues(m_tag, &tagValues);
+    updateSortedRows(&m_tagValues, std::move(tagValues), lessTagValue);
+}
@@ -27,12 +27,16 @@ namespace ncxmms2 {
 namespace xmms2 {
 class Client;
 }
+class MedialibIndex;
 
 class TagValueListModel : public ListModel
 {
 public:
     TagValueListModel(xmms2::Client *xmmsClient, Object *parent = nullptr);
 
+    // Values are taken from the index once it is loaded
+    void setMedialibIndex(const MedialibIndex *index);
+
     void setTag(Song::Tag tag);
 
     Song::Tag tag() const {return m_tag;}
@@ -44,10 +48,19 @@ public:
 
     virtual void refresh();
 
+    // Inserts tag values of newly added medialib entries into the loaded list
+    void addEntries(const xmms2::List<xmms2::Dict>& entries);
+
+    // Takes values from the loaded index again, only inserting and removing
+    // the changed ones, so the view keeps its current item
+    void updateFromIndex();
+
 private:
     xmms2::Client *m_xmmsClient;
+    const MedialibIndex *m_medialibIndex;
+    xmms2::RequestKey m_tagValuesRequest;
     Song::Tag m_tag;
-    std::vector<std::string> m_tagValues;
+    std::vector<PooledString> m_tagValues;
 
     void getTagValueList(const xmms2::Expected<xmms2::List<xmms2::Dict>>& list);
 };
@@ -26,7 +26,8 @@
 using namespace ncxmms2;
 
 PlaylistItemDelegate::PlaylistItemDelegate(const PlaylistModel *model) :
-    ListModelItemDelegate(model)
+    ListModelItemDelegate(model),
+    m_renderedRows(1024)
 {
 
 }
@@ -38,6 +39,7 @@ void PlaylistItemDelegate::setDisplayFormat(const std::string& format)
             std::string("Parsing format string failed: ").append(m_songDisplayFormatter.errorString())
         );
     }
+    invalidateRows();
 }
 
 void PlaylistItemDelegate::paint(Painter *painter, const ListItemPaintOptions& options, int item)
@@ -85,14 +87,30 @@ void PlaylistItemDelegate::paint(Painter *painter, const ListItemPaintOptions& o
         if (item == plsModel->currentSongItem() && !(options.state & ListItemStateCurrent))
             painter->setBold(true);
 
-        m_songDisplayFormatter.paint(song, painter, options.rect, displayFormatterIgnoreColors);
+        SongDisplayFormatParser::RenderedRow *row = m_renderedRows.find(song.id());
+        if (row && row->cols() == options.rect.cols()) {
+            SongDisplayFormatParser::paint(*row, painter, options.rect, displayFormatterIgnoreColors);
+        } else {
+            row = &m_renderedRows.insert(song.id());
+            m_songDisplayFormatter.paint(song, painter, options.rect, displayFormatterIgnoreColors, row);
+        }
     } else {
         painter->setColor(palette->color(colorGroup, Palette::RoleText));
         painter->printString("Loading...");
     }
 }
 
-bool PlaylistItemDelegate::matchFormattedString(const Song& song, const GRegex *regex)
+const SongDisplayFormatParser& PlaylistItemDelegate::displayFormatter() const
+{
+    return m_songDisplayFormatter;
+}
+
+void PlaylistItemDelegate::invalidateRow(int songId)
+{
+    m_renderedRows.remove(songId);
+}
+
+void PlaylistItemDelegate::invalidateRows()
 {
-    return m_songDisplayFormatter.matchFormattedString(song, regex);
+    m_renderedRows.clear();
 }
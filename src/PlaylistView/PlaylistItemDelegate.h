@@ -21,6 +21,7 @@
 
 #include "../lib/ListModelItemDelegate.h"
 #include "../lib/Palette.h"
+#include "../lib/LruCache.h"
 
 namespace ncxmms2 {
 
@@ -35,10 +36,16 @@ public:
 
     virtual void paint(Painter *painter, const ListItemPaintOptions& options, int item);
 
-    bool matchFormattedString(const Song& song, const GRegex *regex);
+    const SongDisplayFormatParser& displayFormatter() const;
+
+    // Rows of songs are painted once and then copied from the cache, until
+    // info of the song or display format changes
+    void invalidateRow(int songId);
+    void invalidateRows();
 
 private:
     SongDisplayFormatParser m_songDisplayFormatter;
+    LruCache<int, SongDisplayFormatParser::RenderedRow> m_renderedRows; // Song id -> row
 };
 }
 
@@ -14,8 +14,11 @@
  *  GNU General Public License for more details.
  */
 
+#include <algorithm>
+
 #include "PlaylistModel.h"
 #include "../XmmsUtils/Client.h"
+#include "../SongInfoCache.h"
 #include "../Log.h"
 
 #include "../lib/ListModelItemData.h"
@@ -26,20 +29,32 @@ PlaylistModel::PlaylistModel(xmms2::Client *xmmsClient, Object *parent) :
     ListModel(parent),
     m_xmmsClient(xmmsClient),
     m_lazyLoadPlaylist(false),
-    m_currentPosition(-1),
-    m_totalDuration(0)
+    m_prefetchBehind(0),
+    m_prefetchAhead(0),
+    m_prefetchFirstItem(-1),
+    m_prefetchLastItem(-1),
+    m_currentPosition(-1)
 {
     m_xmmsClient->playlistChanged_Connect(&PlaylistModel::processPlaylistChange, this);
     m_xmmsClient->playlistCurrentPositionChanged_Connect(&PlaylistModel::getCurrentPosition, this);
     m_xmmsClient->collectionChanged_Connect(&PlaylistModel::handlePlaylistRename, this);
     m_xmmsClient->medialibEntryChanged_Connect(&PlaylistModel::handleSongInfoUpdate, this);
+    
+    m_pendingSongsInfoTimer.setSingleShot(true);
+    m_pendingSongsInfoTimer.timeout_Connect(&PlaylistModel::requestPendingSongsInfo, this);
+    
+    m_pendingChangesTimer.setSingleShot(true);
+    m_pendingChangesTimer.timeout_Connect(&PlaylistModel::applyPendingChanges, this);
+    
+    m_pendingDurationsTimer.setSingleShot(true);
+    m_pendingDurationsTimer.timeout_Connect(&PlaylistModel::applyPendingDurations, this);
 }
 
 void PlaylistModel::setPlaylist(const std::string& playlist)
 {
     m_playlist = playlist;
     m_currentPosition = -1;
-    m_xmmsClient->playlistGetEntries(m_playlist)(&PlaylistModel::getEntries, this);
+    m_xmmsClient->playlistGetEntries(m_playlist).supersede(m_entriesRequest)(&PlaylistModel::getEntries, this);
 }
 
 const std::string& PlaylistModel::playlist() const
@@ -49,9 +64,19 @@ const std::string& PlaylistModel::playlist() const
 
 void PlaylistModel::getEntries(const xmms2::Expected<xmms2::List<int>>& entries)
 {
-    m_totalDuration = 0;
-    m_idList.clear();
+    m_entries.clear();
     m_songInfos.clear();
+    m_entriesCount.clear();
+    m_searchTexts.clear();
+    m_pendingSongsInfo.clear();
+    m_pendingSongsInfoTimer.stop();
+    m_pendingChanges.clear();
+    m_pendingChangesTimer.stop();
+    m_durations.clear();
+    m_pendingDurations.clear();
+    m_pendingDurationsTimer.stop();
+    m_prefetchFirstItem = -1;
+    m_prefetchLastItem = -1;
     
     if (entries.isError()) {
         NCXMMS2_LOG_ERROR("%s", entries.error());
@@ -59,38 +84,93 @@ void PlaylistModel::getEntries(const xmms2::Expected<xmms2::List<int>>& entries)
         // we can't recover from this error
         m_playlist.clear();
         reset();
-        totalDurationChanged();
+        durationsChanged();
         return;
     }
     
-    m_idList.reserve(entries->size());
-    m_songInfos.rehash(m_idList.size() / m_songInfos.max_load_factor() + 1);
+    std::vector<int> ids;
+    ids.reserve(entries->size());
+    m_songInfos.reserve(entries->size());
 
     for (auto it = entries->getIterator(); it.isValid(); it.next()) {
         bool ok = false;
         int id = it.value(&ok);
         if (NCXMMS2_UNLIKELY(!ok)) {
-            m_idList.clear();
+            ids.clear();
             m_songInfos.clear();
             break;
         }
-        m_idList.push_back(id);
+        ids.push_back(id);
     }
     
-    if (!m_idList.empty())
+    if (!ids.empty())
         m_xmmsClient->playlistGetCurrentPosition(m_playlist)(&PlaylistModel::getCurrentPosition, this);
     
     if (!m_lazyLoadPlaylist) {
-        for (int i = 0; i < (int)m_idList.size(); ++i) {
-            int id = m_idList[i];
-            m_songInfos[id];
-            m_xmmsClient->medialibGetInfo(id)(&PlaylistModel::getSongInfo, this,
-                                              i, std::placeholders::_1);
+        // Cached songs are shown right away, but their info is requested
+        // anyway to get changes made while we were not running
+        for (int id : ids) {
+            Song& song = m_songInfos[id];
+            if (song.id() == 0)
+                loadCachedSongInfo(id, &song);
         }
     }
     
+    std::vector<Entry> newEntries;
+    newEntries.reserve(ids.size());
+    for (int id : ids) {
+        ++m_entriesCount[id];
+        newEntries.push_back(makeEntry(id));
+    }
+    m_entries.assign(newEntries.begin(), newEntries.end());
+    // Entries are made with durations of cached songs already
+    m_pendingDurations.clear();
+    m_pendingDurationsTimer.stop();
+    
+    if (!m_lazyLoadPlaylist)
+        requestSongsInfo(ids);
+    
     reset();
-    totalDurationChanged();
+    durationsChanged();
+}
+
+PlaylistModel::Entry PlaylistModel::makeEntry(int id) const
+{
+    auto it = m_durations.find(id);
+    return Entry{id, it != m_durations.end() ? (*it).second : 0};
+}
+
+void PlaylistModel::updateSongDuration(int id, int duration)
+{
+    // Most info updates, e.g. play counts, don't change the duration
+    // and cost nothing here
+    duration = std::max(duration, 0);
+    int& knownDuration = m_durations[id];
+    if (knownDuration == duration)
+        return;
+    knownDuration = duration;
+    m_pendingDurations[id] = duration;
+    if (!m_pendingDurationsTimer.isActive())
+        m_pendingDurationsTimer.startMs(0);
+}
+
+void PlaylistModel::applyPendingDurations()
+{
+    // Song may occur in the playlist many times, so all entries are checked,
+    // which is one pass per batch of changed durations
+    if (m_pendingDurations.empty())
+        return;
+    
+    const bool changed = m_entries.modify([this](Entry& entry){
+        auto it = m_pendingDurations.find(entry.id);
+        if (it == m_pendingDurations.end() || (*it).second == entry.duration)
+            return false;
+        entry.duration = (*it).second;
+        return true;
+    });
+    m_pendingDurations.clear();
+    if (changed)
+        durationsChanged();
 }
 
 void PlaylistModel::getSongInfo(int position, const xmms2::Expected<xmms2::PropDict>& info)
@@ -106,103 +186,257 @@ void PlaylistModel::getSongInfo(int position, const xmms2::Expected<xmms2::PropD
         return;
 
     Song *song = &(*it).second;
-    int durationDiff = song->duration() > 0 ? -song->duration() : 0;
     song->loadInfo(*info);
+    SongInfoCache::store(*song);
+    m_searchTexts.remove(id);
+    songInfoChanged(id);
+    updateSongDuration(id, song->duration());
 
     if (position == -1
-        || (std::vector<int>::size_type)position >= m_idList.size()
-        || m_idList[position] != id) {
-        itemsChanged(0, m_idList.size() - 1);
+        || (size_t)position >= m_entries.size()
+        || m_entries[position].id != id) {
+        itemsChanged(0, m_entries.size() - 1);
     } else {
         itemsChanged(position, position);
     }
+}
 
-    durationDiff += song->duration() > 0 ? song->duration() : 0;
-    if (durationDiff) {
-        m_totalDuration += durationDiff;
-        totalDurationChanged();
+void PlaylistModel::requestSongsInfo(const std::vector<int>& ids)
+{
+    // Songs info is requested with collection queries over idlists instead of
+    // medialibGetInfo per song, so large playlists take a few round trips
+    // instead of one per entry. Ids are split into chunks to keep single
+    // reply reasonably small and let the view fill progressively.
+    const size_t chunkSize = 512;
+    
+    for (size_t begin = 0; begin < ids.size(); begin += chunkSize) {
+        const size_t end = std::min(begin + chunkSize, ids.size());
+        xmms2::Collection idlist(xmms2::Collection::Type::Idlist);
+        for (size_t i = begin; i < end; ++i) {
+            idlist.append(ids[i]);
+        }
+        m_xmmsClient->collectionQueryInfos(idlist, Song::infoKeys(), {})(&PlaylistModel::getSongsInfo, this);
     }
 }
 
+void PlaylistModel::enqueueSongInfoRequest(int id)
+{
+    // Requests are held for a short time, so that all songs needed by one
+    // repaint go in one query and requests for rows the user has already
+    // scrolled away from can be dropped before they are sent.
+    // Cached info is used until the reply comes.
+    loadCachedSongInfo(id, &m_songInfos[id]);
+    m_pendingSongsInfo.push_back(id);
+    if (!m_pendingSongsInfoTimer.isActive())
+        m_pendingSongsInfoTimer.startMs(30);
+}
+
+bool PlaylistModel::loadCachedSongInfo(int id, Song *song)
+{
+    if (!SongInfoCache::lookup(id, song))
+        return false;
+    updateSongDuration(id, song->duration());
+    return true;
+}
+
+void PlaylistModel::requestPendingSongsInfo()
+{
+    std::vector<int> ids;
+    ids.swap(m_pendingSongsInfo);
+    requestSongsInfo(ids);
+}
+
+void PlaylistModel::cancelPendingSongsInfo()
+{
+    // Songs filled from the cache are dropped too, they are not validated
+    // yet and are loaded from the cache again when needed. Their entries
+    // keep cached durations, which are still the best ones we know.
+    for (int id : m_pendingSongsInfo) {
+        auto it = m_songInfos.find(id);
+        if (it != m_songInfos.end())
+            m_songInfos.erase(it);
+        m_searchTexts.remove(id);
+    }
+    m_pendingSongsInfo.clear();
+    m_pendingSongsInfoTimer.stop();
+}
+
+void PlaylistModel::getSongsInfo(const xmms2::Expected<xmms2::List<xmms2::Dict>>& infos)
+{
+    if (infos.isError()) {
+        NCXMMS2_LOG_ERROR("%s", infos.error());
+        return;
+    }
+    
+    bool songsUpdated = false;
+    for (auto it = infos->getIterator(); it.isValid(); it.next()) {
+        bool ok = false;
+        xmms2::Dict info = it.value(&ok);
+        if (NCXMMS2_UNLIKELY(!ok))
+            continue;
+        
+        auto songIt = m_songInfos.find(info.value<int>("id"));
+        if (songIt == m_songInfos.end())
+            continue;
+        
+        Song *song = &(*songIt).second;
+        song->loadInfo(info);
+        SongInfoCache::store(*song);
+        m_searchTexts.remove(song->id());
+        songInfoChanged(song->id());
+        updateSongDuration(song->id(), song->duration());
+        songsUpdated = true;
+    }
+    
+    if (songsUpdated)
+        itemsChanged(0, m_entries.size() - 1);
+}
+
 void PlaylistModel::processPlaylistChange(const xmms2::PlaylistChangeEvent& change)
 {
     if (m_playlist.empty() || change.playlist() != m_playlist)
         return;
 
-    typedef xmms2::PlaylistChangeEvent::Type ChangeType;
-    switch (change.type()) {
-        case ChangeType::Add:
-        {
-            const int id = change.id();
-            m_idList.push_back(id);
-            m_songInfos[id];
-            m_xmmsClient->medialibGetInfo(id)(&PlaylistModel::getSongInfo, this,
-                                              m_idList.size() - 1, std::placeholders::_1);
-            itemAdded();
-            totalDurationChanged();
-            break;
-        }
+    // Changes are applied when all broadcasts received within the current main
+    // loop iteration are dispatched. This way adding a big collection leads to
+    // one model update and one songs info query instead of one per song.
+    m_pendingChanges.push_back(change);
+    if (!m_pendingChangesTimer.isActive())
+        m_pendingChangesTimer.startMs(0);
+}
 
-        case ChangeType::Insert:
-        {
-            const int id = change.id();
-            const int position = change.position();
-            if (position < 0 || (size_t)position > m_idList.size()) {
-                NCXMMS2_LOG_ERROR("Wrong insert position: %d, playlist size: %zu", position, m_idList.size());
-                return;
-            }
-            m_idList.insert(m_idList.begin() + position, id);
-            m_songInfos[id];
-            m_xmmsClient->medialibGetInfo(id)(&PlaylistModel::getSongInfo, this,
-                                              position, std::placeholders::_1);
-            itemInserted(position);
-            totalDurationChanged();
-            break;
-        }
+void PlaylistModel::applyPendingChanges()
+{
+    std::vector<xmms2::PlaylistChangeEvent> changes;
+    changes.swap(m_pendingChanges);
 
-        case ChangeType::Remove:
-        {
-            const int position = change.position();
-            if (position < 0 || (size_t)position >= m_idList.size()) {
-                NCXMMS2_LOG_ERROR("Wrong insert position: %d, playlist size: %zu", position, m_idList.size());
-                return;
-            }
-            const int id = m_idList[position];
-            m_idList.erase(m_idList.begin() + position);
-            m_totalDuration -= m_songInfos[id].duration();
-            m_songInfos.erase(id);
+    typedef xmms2::PlaylistChangeEvent::Type ChangeType;
+    auto isReplace = [](const xmms2::PlaylistChangeEvent& change) {
+        return change.type() == ChangeType::Replace;
+    };
+    if (std::any_of(changes.begin(), changes.end(), isReplace)) {
+        // Playlist is reloaded anyway, all other changes are included in the new entries list
+        m_xmmsClient->playlistGetEntries(m_playlist).supersede(m_entriesRequest)(&PlaylistModel::getEntries, this);
+        return;
+    }
 
-            itemRemoved(position);
-            totalDurationChanged();
-            break;
-        }
+    std::vector<int> newIds;
+    bool entriesChanged = false;
 
-        case ChangeType::Move:
-        {
-            const int position = change.position();
-            const int newPosition = change.newPosition();
-            if (position < 0 || (size_t)position >= m_idList.size()) {
-                NCXMMS2_LOG_ERROR("Wrong insert position: %d, playlist size: %zu", position, m_idList.size());
-                return;
+    for (auto it = changes.begin(); it != changes.end();) {
+        if (it->type() == ChangeType::Add) {
+            const size_t oldSize = m_entries.size();
+            for (; it != changes.end() && it->type() == ChangeType::Add; ++it) {
+                m_entries.push_back(addSongInfo(it->id(), &newIds));
             }
-            if (newPosition < 0 || (size_t)newPosition >= m_idList.size()) {
-                NCXMMS2_LOG_ERROR("Wrong insert position: %d, playlist size: %zu", newPosition, m_idList.size());
-                return;
+            itemsAdded(m_entries.size() - oldSize);
+            entriesChanged = true;
+        } else if (it->type() == ChangeType::Insert) {
+            // Songs inserted one after another, e.g. a collection inserted at some position
+            auto last = it + 1;
+            while (last != changes.end()
+                   && last->type() == ChangeType::Insert
+                   && last->position() == (last - 1)->position() + 1) {
+                ++last;
             }
-            const int id = m_idList[position];
-            m_idList.erase(m_idList.begin() + position);
-            m_idList.insert(m_idList.begin() + newPosition, id);
-            itemMoved(position, newPosition);
-            break;
+            entriesChanged |= insertEntries(it, last, &newIds);
+            it = last;
+        } else if (it->type() == ChangeType::Remove) {
+            // Contiguous range removed entry by entry either from its beginning
+            // (same position repeated) or from its end (descending positions)
+            int first = it->position();
+            int count = 1;
+            auto last = it + 1;
+            for (; last != changes.end() && last->type() == ChangeType::Remove; ++last, ++count) {
+                const int position = last->position();
+                if (position == first - 1)
+                    first = position;
+                else if (position != first)
+                    break;
+            }
+            entriesChanged |= removeEntries(first, count);
+            it = last;
+        } else {
+            if (it->type() == ChangeType::Move) {
+                moveEntry(it->position(), it->newPosition());
+                entriesChanged = true;
+            }
+            ++it;
         }
+    }
 
-        case ChangeType::Replace:
-            m_xmmsClient->playlistGetEntries(m_playlist)(&PlaylistModel::getEntries, this);
-            break;
+    requestSongsInfo(newIds);
+    // Moves don't change the total, but they do change the remaining duration
+    if (entriesChanged)
+        durationsChanged();
+}
 
-        default:
-            break;
+void PlaylistModel::moveEntry(int position, int newPosition)
+{
+    if (position < 0 || (size_t)position >= m_entries.size()) {
+        NCXMMS2_LOG_ERROR("Wrong insert position: %d, playlist size: %zu", position, m_entries.size());
+        return;
+    }
+    if (newPosition < 0 || (size_t)newPosition >= m_entries.size()) {
+        NCXMMS2_LOG_ERROR("Wrong insert position: %d, playlist size: %zu", newPosition, m_entries.size());
+        return;
+    }
+    m_entries.move(position, newPosition);
+    itemMoved(position, newPosition);
+}
+
+bool PlaylistModel::insertEntries(std::vector<xmms2::PlaylistChangeEvent>::const_iterator begin,
+                                  std::vector<xmms2::PlaylistChangeEvent>::const_iterator end,
+                                  std::vector<int> *newIds)
+{
+    const int position = begin->position();
+    if (position < 0 || (size_t)position > m_entries.size()) {
+        NCXMMS2_LOG_ERROR("Wrong insert position: %d, playlist size: %zu", position, m_entries.size());
+        return false;
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(end - begin);
+    for (auto it = begin; it != end; ++it) {
+        entries.push_back(addSongInfo(it->id(), newIds));
+    }
+    m_entries.insert(position, entries.begin(), entries.end());
+    itemsInserted(position, entries.size());
+    return true;
+}
+
+bool PlaylistModel::removeEntries(int first, int count)
+{
+    if (first < 0 || (size_t)(first + count) > m_entries.size()) {
+        NCXMMS2_LOG_ERROR("Wrong remove range: %d-%d, playlist size: %zu", first, first + count - 1, m_entries.size());
+        return false;
+    }
+
+    // Info of a song is kept while other entries of it remain in the playlist
+    m_entries.forEach(first, first + count, [this](const Entry& entry){
+        auto countIt = m_entriesCount.find(entry.id);
+        if (countIt != m_entriesCount.end() && --(*countIt).second > 0)
+            return;
+        if (countIt != m_entriesCount.end())
+            m_entriesCount.erase(countIt);
+        auto it = m_songInfos.find(entry.id);
+        if (it != m_songInfos.end())
+            m_songInfos.erase(it);
+        m_searchTexts.remove(entry.id);
+    });
+    m_entries.erase(first, first + count);
+    itemsRemoved(first, count);
+    return true;
+}
+
+PlaylistModel::Entry PlaylistModel::addSongInfo(int id, std::vector<int> *newIds)
+{
+    ++m_entriesCount[id];
+    if (m_songInfos.find(id) == m_songInfos.end()) {
+        loadCachedSongInfo(id, &m_songInfos[id]);
+        newIds->push_back(id);
     }
+    return makeEntry(id);
 }
 
 void PlaylistModel::getCurrentPosition(const xmms2::Expected<xmms2::Dict>& position)
@@ -226,6 +460,7 @@ void PlaylistModel::getCurrentPosition(const xmms2::Expected<xmms2::Dict>& posit
         itemsChanged(m_currentPosition, m_currentPosition);
         if (oldPosition != -1)
             activeSongPositionChanged(m_currentPosition);
+        durationsChanged();
     }
 }
 
@@ -250,6 +485,9 @@ void PlaylistModel::handleSongInfoUpdate(const xmms2::Expected<int>& id)
         return;
     }
     
+    SongInfoCache::invalidate(*id);
+    m_searchTexts.remove(*id);
+    songInfoChanged(*id);
     if (m_songInfos.find(*id) != m_songInfos.end()) {
         m_xmmsClient->medialibGetInfo(*id)(&PlaylistModel::getSongInfo, this, -1, std::placeholders::_1);
     }
@@ -257,26 +495,22 @@ void PlaylistModel::handleSongInfoUpdate(const xmms2::Expected<int>& id)
 
 int PlaylistModel::itemsCount() const
 {
-    return m_idList.size();
+    return m_entries.size();
 }
 
 const Song &PlaylistModel::song(int item) const
 {
-    assert(item >= 0 && (size_t)item < m_idList.size());
+    assert(item >= 0 && (size_t)item < m_entries.size());
 
-    const Song *song = nullptr;
-    const int id = m_idList[item];
-    auto it = m_songInfos.find(id);
-    if (it == m_songInfos.end()) {
-        PlaylistModel *nonConstThis = const_cast<PlaylistModel*>(this);
-        song = &nonConstThis->m_songInfos[id];
-        m_xmmsClient->medialibGetInfo(id)(&PlaylistModel::getSongInfo, nonConstThis,
-                                          -1, std::placeholders::_1);
-    } else {
-        song = &(*it).second;
-    }
+    static const Song notLoadedSong;
+    auto it = m_songInfos.find(m_entries[item].id);
+    return it != m_songInfos.end() ? (*it).second : notLoadedSong;
+}
 
-    return *song;
+int PlaylistModel::songId(int item) const
+{
+    assert(item >= 0 && (size_t)item < m_entries.size());
+    return m_entries[item].id;
 }
 
 int PlaylistModel::currentSongItem() const
@@ -286,7 +520,39 @@ int PlaylistModel::currentSongItem() const
 
 int PlaylistModel::totalDuration() const
 {
-    return m_totalDuration;
+    return m_entries.sum();
+}
+
+int PlaylistModel::itemsDuration(int firstItem, int lastItem) const
+{
+    firstItem = std::max(firstItem, 0);
+    lastItem = std::min(lastItem, (int)m_entries.size() - 1);
+    if (lastItem < firstItem)
+        return 0;
+    return m_entries.sum(firstItem, lastItem + 1);
+}
+
+int PlaylistModel::itemsDuration(const std::vector<int>& items) const
+{
+    // Selections are mostly made of a few contiguous ranges,
+    // each range is summed up at once
+    int64_t duration = 0;
+    for (auto it = items.begin(); it != items.end();) {
+        auto last = it + 1;
+        while (last != items.end() && *last == *(last - 1) + 1) {
+            ++last;
+        }
+        duration += itemsDuration(*it, *(last - 1));
+        it = last;
+    }
+    return duration;
+}
+
+int PlaylistModel::remainingDuration() const
+{
+    if (m_currentPosition < 0)
+        return 0;
+    return itemsDuration(m_currentPosition, m_entries.size() - 1);
 }
 
 void PlaylistModel::setLazyLoadPlaylist(bool enable)
@@ -294,6 +560,94 @@ void PlaylistModel::setLazyLoadPlaylist(bool enable)
     m_lazyLoadPlaylist = enable;
 }
 
+void PlaylistModel::setPrefetchWindow(int behind, int ahead)
+{
+    m_prefetchBehind = std::max(behind, 0);
+    m_prefetchAhead = std::max(ahead, 0);
+}
+
+void PlaylistModel::prefetchSongsInfo(int firstItem, int lastItem)
+{
+    if (!m_lazyLoadPlaylist || m_entries.empty() || firstItem < 0 || lastItem < firstItem)
+        return;
+    
+    firstItem = std::max(firstItem - m_prefetchBehind, 0);
+    lastItem = std::min(lastItem + m_prefetchAhead, (int)m_entries.size() - 1);
+    
+    // Window doesn't overlap the previous one, the user jumped elsewhere,
+    // requests for the old window are not needed anymore
+    if (m_prefetchFirstItem != -1
+        && (lastItem < m_prefetchFirstItem || firstItem > m_prefetchLastItem)) {
+        cancelPendingSongsInfo();
+    }
+    m_prefetchFirstItem = firstItem;
+    m_prefetchLastItem = lastItem;
+    
+    m_entries.forEach(firstItem, lastItem + 1, [this](const Entry& entry){
+        if (m_songInfos.find(entry.id) == m_songInfos.end())
+            enqueueSongInfoRequest(entry.id);
+    });
+}
+
+void PlaylistModel::setSearchTextGenerator(const SearchTextGenerator& generator)
+{
+    m_searchTextGenerator = generator;
+    m_searchTexts.clear();
+}
+
+void PlaylistModel::clearSearchTexts()
+{
+    m_searchTexts.clear();
+}
+
+const SearchTextArena& PlaylistModel::searchTexts(const std::vector<int>& items,
+                                                  std::vector<SearchTextArena::Span> *spans)
+{
+    // All missing texts are built first, as insertion may compact the arena
+    // and move texts already there. Songs which are not loaded yet are
+    // requested, cached ones are searched right away
+    for (int item : items) {
+        const int id = m_entries[item].id;
+        if (m_songInfos.find(id) == m_songInfos.end())
+            enqueueSongInfoRequest(id);
+        buildSearchText(song(item));
+    }
+
+    spans->clear();
+    spans->reserve(items.size());
+    for (int item : items) {
+        SearchTextArena::Span span = {0, 0};
+        m_searchTexts.find(m_entries[item].id, &span);
+        spans->push_back(span);
+    }
+    return m_searchTexts;
+}
+
+void PlaylistModel::searchText(int item, std::string *text) const
+{
+    const Song& s = song(item);
+    if (!buildSearchText(s))
+        return;
+
+    SearchTextArena::Span span;
+    m_searchTexts.find(s.id(), &span);
+    text->append(m_searchTexts.buffer(), span.offset, span.size);
+}
+
+bool PlaylistModel::buildSearchText(const Song& song) const
+{
+    if (song.id() == 0)
+        return false;
+
+    if (!m_searchTexts.contains(song.id())) {
+        std::string text;
+        if (m_searchTextGenerator)
+            m_searchTextGenerator(song, &text);
+        m_searchTexts.insert(song.id(), text);
+    }
+    return true;
+}
+
 void PlaylistModel::data(int item, ListModelItemData *itemData) const
 {
     // Actually, this is never used, PlaylistItemDelegate uses song method instead.
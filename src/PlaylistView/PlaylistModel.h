@@ -19,11 +19,15 @@
 
 #include <vector>
 #include <string>
-#include <unordered_map>
+#include <functional>
 
 #include "../Song.h"
 #include "../XmmsUtils/Result.h"
 #include "../lib/ListModel.h"
+#include "../lib/Timer.h"
+#include "../lib/ChunkedVector.h"
+#include "../lib/FlatHashMap.h"
+#include "../lib/SearchTextArena.h"
 
 namespace ncxmms2 {
 
@@ -41,34 +45,107 @@ public:
 
     virtual int itemsCount() const;
     virtual void data(int item, ListModelItemData *itemData) const;
+    virtual void searchText(int item, std::string *text) const;
 
+    // Songs which are not loaded yet have zero id, in lazy load mode
+    // songs are loaded by prefetchSongsInfo
     const Song& song(int item) const;
+    int songId(int item) const;
     int currentSongItem() const;
 
+    // Durations are in milliseconds, songs with unknown duration count as zero
     int totalDuration() const;
+    int itemsDuration(int firstItem, int lastItem) const;
+    int itemsDuration(const std::vector<int>& items) const; // items must be sorted
+    int remainingDuration() const; // Current song and all songs after it
 
     void setLazyLoadPlaylist(bool enable);
     
+    // In lazy load mode, songs info of items around the visible range is
+    // requested in advance, behind and ahead set the number of such items
+    void setPrefetchWindow(int behind, int ahead);
+    void prefetchSongsInfo(int firstItem, int lastItem);
+    
+    // Search text of a song is a list of strings made by the generator, usually
+    // the ones displayed for the song. Texts are built on demand, kept case folded
+    // in one buffer and rebuilt after songs info changes.
+    typedef std::function<void (const Song&, std::string*)> SearchTextGenerator;
+    void setSearchTextGenerator(const SearchTextGenerator& generator);
+    void clearSearchTexts(); // Texts are made anew, e.g. display format has changed
+    // Builds missing texts of items and returns spans of their texts in the arena
+    // buffer, items with songs which are not loaded yet get empty spans
+    const SearchTextArena& searchTexts(const std::vector<int>& items,
+                                       std::vector<SearchTextArena::Span> *spans);
+    
     // Signals
     NCXMMS2_SIGNAL(playlistRenamed)
     NCXMMS2_SIGNAL(activeSongPositionChanged, int)
-    NCXMMS2_SIGNAL(totalDurationChanged)
+    NCXMMS2_SIGNAL(durationsChanged)
+    NCXMMS2_SIGNAL(songInfoChanged, int) // Id of the song, info is (re)loaded or about to be
 
 private:
     xmms2::Client *m_xmmsClient;
+    xmms2::RequestKey m_entriesRequest;
 
     bool m_lazyLoadPlaylist;
+    int m_prefetchBehind;
+    int m_prefetchAhead;
+    int m_prefetchFirstItem;
+    int m_prefetchLastItem;
+    std::vector<int> m_pendingSongsInfo;
+    Timer m_pendingSongsInfoTimer;
+    std::vector<xmms2::PlaylistChangeEvent> m_pendingChanges;
+    Timer m_pendingChangesTimer;
+    
+    // Duration all entries of a song have, a changed one is applied to
+    // the entries in one pass per main loop iteration
+    FlatHashMap<int, int> m_durations;
+    FlatHashMap<int, int> m_pendingDurations;
+    Timer m_pendingDurationsTimer;
     
-    std::unordered_map<int, Song> m_songInfos;
-    std::vector<int> m_idList;
+    // Every entry keeps duration of its song, so that durations of any range
+    // of the playlist are summed up by m_entries in O(log n)
+    struct Entry
+    {
+        int id;
+        int duration;
+    };
+    struct EntryDuration
+    {
+        int64_t operator()(const Entry& entry) const {return entry.duration;}
+    };
+
+    FlatHashMap<int, Song> m_songInfos;
+    // Number of entries of every song, a song may occur in the playlist many
+    // times and its info is dropped only with the last of its entries
+    FlatHashMap<int, int> m_entriesCount;
+    ChunkedVector<Entry, 256, EntryDuration> m_entries;
+    mutable SearchTextArena m_searchTexts; // Cache, filled by const methods too
+    SearchTextGenerator m_searchTextGenerator;
     std::string m_playlist;
     int m_currentPosition;
 
-    int m_totalDuration;
+    Entry makeEntry(int id) const;
+    void updateSongDuration(int id, int duration);
+    void applyPendingDurations();
+    bool buildSearchText(const Song& song) const;
+    void requestSongsInfo(const std::vector<int>& ids);
+    void enqueueSongInfoRequest(int id);
+    bool loadCachedSongInfo(int id, Song *song);
+    void requestPendingSongsInfo();
+    void cancelPendingSongsInfo();
+    Entry addSongInfo(int id, std::vector<int> *newIds);
+    void applyPendingChanges();
+    bool insertEntries(std::vector<xmms2::PlaylistChangeEvent>::const_iterator begin,
+                       std::vector<xmms2::PlaylistChangeEvent>::const_iterator end,
+                       std::vector<int> *newIds);
+    bool removeEntries(int first, int count);
+    void moveEntry(int position, int newPosition);
 
     // Callbacks
     void getEntries(const xmms2::Expected<xmms2::List<int>>& entries);
     void getSongInfo(int position, const xmms2::Expected<xmms2::PropDict>& info);
+    void getSongsInfo(const xmms2::Expected<xmms2::List<xmms2::Dict>>& infos);
     void processPlaylistChange(const xmms2::PlaylistChangeEvent& change);
     void getCurrentPosition(const xmms2::Expected<xmms2::Dict>& position);
     void handlePlaylistRename(const xmms2::CollectionChangeEvent& change);
@@ -33,16 +33,34 @@ using namespace ncxmms2;
 
 PlaylistView::PlaylistView(xmms2::Client *xmmsClient, const Rectangle& rect, Window *parent) :
     ListViewAppIntegrated(rect, parent),
-    m_xmmsClient(xmmsClient)
+    m_xmmsClient(xmmsClient),
+    m_selectMatchedSongs(true)
 {
     loadPalette("PlaylistView");
 
     PlaylistModel *plsModel = new PlaylistModel(m_xmmsClient, this);
+    PlaylistItemDelegate *plsDelegate = new PlaylistItemDelegate(plsModel);
     setModel(plsModel);
-    setItemDelegate(new PlaylistItemDelegate(plsModel));
+    setItemDelegate(plsDelegate);
+
+    // Songs are searched by what is actually displayed
+    plsModel->setSearchTextGenerator([plsDelegate](const Song& song, std::string *text){
+        plsDelegate->displayFormatter().appendMatchStrings(song, text);
+    });
+    plsModel->songInfoChanged_Connect([plsDelegate](int id){
+        plsDelegate->invalidateRow(id);
+    });
     setHideCurrentItemInterval(10);
 
     itemEntered_Connect(&PlaylistView::onItemEntered, this);
+
+    m_songsMatcher.progressChanged_Connect([](int percent){
+        StatusArea::showMessage("Matching songs: %d%%", percent);
+    });
+    m_songsMatcher.finished_Connect(&PlaylistView::onSongsMatched, this);
+    m_songsMatcher.aborted_Connect([](){
+        StatusArea::showMessage("Playlist has changed, selection is cancelled");
+    });
 }
 
 void PlaylistView::setPlaylist(const std::string& playlist)
@@ -55,6 +73,9 @@ void PlaylistView::setDisplayFormat(const std::string& format)
 {
     PlaylistItemDelegate *plsDelegate = static_cast<PlaylistItemDelegate*>(itemDelegate());
     plsDelegate->setDisplayFormat(format);
+
+    PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
+    plsModel->clearSearchTexts();
 }
 
 void PlaylistView::setLazyLoadPlaylist(bool enable)
@@ -63,6 +84,12 @@ void PlaylistView::setLazyLoadPlaylist(bool enable)
     plsModel->setLazyLoadPlaylist(enable);
 }
 
+void PlaylistView::setLazyLoadPrefetchWindow(int behind, int ahead)
+{
+    PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
+    plsModel->setPrefetchWindow(behind, ahead);
+}
+
 void PlaylistView::keyPressedEvent(const KeyEvent& keyEvent)
 {
     PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
@@ -112,9 +139,7 @@ void PlaylistView::keyPressedEvent(const KeyEvent& keyEvent)
         
         case Hotkeys::PlaylistView::ShowSongInfo:
             if (plsModel->itemsCount() && !isCurrentItemHidden()) {
-                int id = plsModel->song(currentItem()).id();
-                if (id > 0)
-                    showSongInfo(id);
+                showSongInfo(plsModel->songId(currentItem()));
             }
             break;
             
@@ -130,6 +155,13 @@ void PlaylistView::keyPressedEvent(const KeyEvent& keyEvent)
     }
 }
 
+void PlaylistView::paint(const Rectangle& rect)
+{
+    PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
+    plsModel->prefetchSongsInfo(viewportFirstItem(), viewportLastItem());
+    ListViewAppIntegrated::paint(rect);
+}
+
 void PlaylistView::onItemEntered(int item)
 {
     PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
@@ -206,21 +238,8 @@ void PlaylistView::selectSongsByRegExp()
     // it uses SongDisplayFormatParser for this job.
     auto resultCallback = [this](const std::string& pattern, LineEdit::Result result)
     {
-        if (result == LineEdit::Result::Accepted) {
-            GRegex *regex = g_regex_new(pattern.c_str(), G_REGEX_OPTIMIZE,
-                                        (GRegexMatchFlags)0, nullptr);
-            if (!regex)
-                return;
-
-            PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
-            PlaylistItemDelegate *delegate = static_cast<PlaylistItemDelegate*>(itemDelegate());
-
-            selectItems([plsModel, delegate, regex](int item){
-                return delegate->matchFormattedString(plsModel->song(item), regex);
-            });
-            g_regex_unref(regex);
-            StatusArea::showMessage("%d items selected", selectedItems().size());
-        }
+        if (result == LineEdit::Result::Accepted)
+            matchSongsByRegExp(pattern, true);
     };
     StatusArea::askQuestion("Select items: ", resultCallback, ".*");
 }
@@ -230,25 +249,33 @@ void PlaylistView::unselectSongsByRegExp()
     // The same story here...
     auto resultCallback = [this](const std::string& pattern, LineEdit::Result result)
     {
-        if (result == LineEdit::Result::Accepted) {
-            GRegex *regex = g_regex_new(pattern.c_str(), G_REGEX_OPTIMIZE,
-                                        (GRegexMatchFlags)0, nullptr);
-            if (!regex)
-                return;
-
-            PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
-            PlaylistItemDelegate *delegate = static_cast<PlaylistItemDelegate*>(itemDelegate());
-
-            unselectItems([plsModel, delegate, regex](int item){
-                return delegate->matchFormattedString(plsModel->song(item), regex);
-            });
-            g_regex_unref(regex);
-            StatusArea::showMessage("%d items selected", selectedItems().size());
-        }
+        if (result == LineEdit::Result::Accepted)
+            matchSongsByRegExp(pattern, false);
     };
     StatusArea::askQuestion("Unselect items: ", resultCallback, ".*");
 }
 
+void PlaylistView::matchSongsByRegExp(const std::string& pattern, bool select)
+{
+    PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
+
+    // Only selected items can be unselected, there is no need to match others
+    m_selectMatchedSongs = select;
+    if (select)
+        m_songsMatcher.start(plsModel, pattern);
+    else
+        m_songsMatcher.start(plsModel, pattern, selectedItems().items());
+}
+
+void PlaylistView::onSongsMatched(const std::vector<int>& items)
+{
+    if (m_selectMatchedSongs)
+        selectItems(items);
+    else
+        unselectItems(items);
+    StatusArea::showMessage("%d items selected", selectedItems().size());
+}
+
 void PlaylistView::removeSelectedSongs()
 {
     PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
@@ -256,7 +283,7 @@ void PlaylistView::removeSelectedSongs()
         //   Actually we don't have to make copy of selectedItems, since removeEntry
         // doesn't modify it immediately, but this is not obvious and may lead to
         // problems in the future.
-        const std::vector<int> selectedSongs = selectedItems();
+        const std::vector<int> selectedSongs = selectedItems().items();
         if (!selectedSongs.empty()) {
             assert(std::is_sorted(selectedSongs.begin(), selectedSongs.end()));
             std::for_each(selectedSongs.rbegin(), selectedSongs.rend(), [&](int item){
@@ -272,7 +299,7 @@ void PlaylistView::removeSelectedSongs()
 void PlaylistView::moveSelectedSongs()
 {
     PlaylistModel *plsModel = static_cast<PlaylistModel*>(model());
-    const std::vector<int> selectedSongs  = selectedItems();
+    const std::vector<int> selectedSongs  = selectedItems().items();
     assert(std::is_sorted(selectedSongs.begin(), selectedSongs.end()));
     
     if (isCurrentItemHidden() || selectedSongs.empty())
@@ -17,6 +17,7 @@
 #ifndef PLAYLISTVIEW_H
 #define PLAYLISTVIEW_H
 
+#include "SongsRegExpMatcher.h"
 #include "../XmmsUtils/Client.h"
 #include "../ListViewAppIntegrated/ListViewAppIntegrated.h"
 
@@ -32,14 +33,20 @@ public:
     void setDisplayFormat(const std::string& format);
 
     void setLazyLoadPlaylist(bool enable);
+    void setLazyLoadPrefetchWindow(int behind, int ahead);
     
     virtual void keyPressedEvent(const KeyEvent& keyEvent);
 
     // Signals:
     NCXMMS2_SIGNAL(showSongInfo, int)
     
+protected:
+    virtual void paint(const Rectangle& rect);
+
 private:
     xmms2::Client *m_xmmsClient;
+    SongsRegExpMatcher m_songsMatcher;
+    bool m_selectMatchedSongs;
 
     void onItemEntered(int item);
     void addPath(const std::string& path);
@@ -47,6 +54,8 @@ private:
     void addUrl(const std::string& url);
     void selectSongsByRegExp();
     void unselectSongsByRegExp();
+    void matchSongsByRegExp(const std::string& pattern, bool select);
+    void onSongsMatched(const std::vector<int>& items);
     void removeSelectedSongs();
     void moveSelectedSongs();
 };
@@ -0,0 +1,298 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <glib.h>
+
+#include "SongsRegExpMatcher.h"
+#include "PlaylistModel.h"
+
+#include "../lib/Timer.h"
+#include "../lib/FlatHashMap.h"
+
+namespace ncxmms2 {
+
+class SongsRegExpMatcherPrivate
+{
+public:
+    SongsRegExpMatcherPrivate(SongsRegExpMatcher *q_) :
+        q(q_),
+        regex(nullptr),
+        songsDone(0),
+        cancelled(false) {}
+
+    SongsRegExpMatcher *q;
+
+    // Snapshot, it is not modified while workers are running
+    std::string strings;
+    std::vector<SearchTextArena::Span> songs; // Texts of distinct songs in strings
+    std::vector<int> items;
+    std::vector<int> itemSongs;               // Index of song for every item
+    GRegex *regex;
+
+    // Every worker writes only its own range of songs
+    std::vector<char> songMatched;
+    std::atomic<size_t> songsDone;
+    std::atomic<bool> cancelled;
+    std::vector<std::thread> workers;
+
+    Timer progressTimer;
+    std::vector<Signals::Connection> modelConnections;
+
+    const SearchTextArena& makeSnapshot(PlaylistModel *model);
+    size_t songsCount() const {return songs.size();}
+    bool matchSong(size_t song) const;
+    void matchSongs(size_t first, size_t last);
+    void findSubstring(const std::string& buffer, const std::string& needle);
+    void checkProgress();
+    void finish();
+    void abort();
+    void stop();
+};
+} // ncxmms2
+
+using namespace ncxmms2;
+
+SongsRegExpMatcher::SongsRegExpMatcher(Object *parent) :
+    Object(parent),
+    d(new SongsRegExpMatcherPrivate(this))
+{
+    d->progressTimer.timeout_Connect(&SongsRegExpMatcherPrivate::checkProgress, d.get());
+}
+
+SongsRegExpMatcher::~SongsRegExpMatcher()
+{
+    d->stop();
+}
+
+bool SongsRegExpMatcher::start(PlaylistModel *model, const std::string& pattern)
+{
+    std::vector<int> items(model->itemsCount());
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i] = i;
+    }
+    return start(model, pattern, items);
+}
+
+bool SongsRegExpMatcher::start(PlaylistModel *model, const std::string& pattern, const std::vector<int>& items)
+{
+    d->stop();
+
+    // Search texts are case folded, for a pattern without special characters
+    // a substring search over the whole arena is enough
+    if (pattern.find_first_of("\\^$.|?*+()[]{}") == std::string::npos) {
+        d->items = items;
+        const SearchTextArena& arena = d->makeSnapshot(model);
+        std::string needle;
+        SearchTextArena::fold(pattern.data(), pattern.size(), &needle);
+        d->songMatched.assign(d->songsCount(), 0);
+        d->findSubstring(arena.buffer(), needle);
+        d->finish();
+        return true;
+    }
+
+    GRegex *regex = g_regex_new(pattern.c_str(), (GRegexCompileFlags)(G_REGEX_OPTIMIZE | G_REGEX_CASELESS),
+                                (GRegexMatchFlags)0, nullptr);
+    if (!regex)
+        return false;
+
+    d->items = items;
+    d->strings = d->makeSnapshot(model).buffer();
+    d->regex = regex;
+    d->songMatched.assign(d->songsCount(), 0);
+
+    // Spawning threads costs more than matching a few thousand songs
+    const size_t minSongsPerWorker = 2048;
+    const size_t workersCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u),
+                                                 d->songsCount() / minSongsPerWorker);
+    if (workersCount < 2) {
+        d->matchSongs(0, d->songsCount());
+        d->finish();
+        return true;
+    }
+
+    const size_t songsPerWorker = (d->songsCount() + workersCount - 1) / workersCount;
+    for (size_t first = 0; first < d->songsCount(); first += songsPerWorker) {
+        const size_t last = std::min(first + songsPerWorker, d->songsCount());
+        d->workers.push_back(std::thread(&SongsRegExpMatcherPrivate::matchSongs, d.get(), first, last));
+    }
+
+    d->modelConnections.push_back(model->reset_Connect(std::bind(&SongsRegExpMatcherPrivate::abort, d.get())));
+    d->modelConnections.push_back(model->itemsInserted_Connect(std::bind(&SongsRegExpMatcherPrivate::abort, d.get())));
+    d->modelConnections.push_back(model->itemsRemoved_Connect(std::bind(&SongsRegExpMatcherPrivate::abort, d.get())));
+    d->modelConnections.push_back(model->itemMoved_Connect(std::bind(&SongsRegExpMatcherPrivate::abort, d.get())));
+
+    d->progressTimer.startMs(100);
+    return true;
+}
+
+void SongsRegExpMatcher::cancel()
+{
+    d->stop();
+}
+
+bool SongsRegExpMatcher::isRunning() const
+{
+    return !d->workers.empty();
+}
+
+const SearchTextArena& SongsRegExpMatcherPrivate::makeSnapshot(PlaylistModel *model)
+{
+    std::vector<SearchTextArena::Span> spans;
+    const SearchTextArena& arena = model->searchTexts(items, &spans);
+
+    // Entries of the same song share its text. Songs which are not loaded
+    // yet have empty spans, they all go to one song which never matches.
+    FlatHashMap<int64_t, int> songIndexes;
+    songs.clear();
+    itemSongs.clear();
+    itemSongs.reserve(items.size());
+    for (const auto& span : spans) {
+        const int64_t key = span.size ? span.offset : -1;
+        auto it = songIndexes.find(key);
+        if (it != songIndexes.end()) {
+            itemSongs.push_back((*it).second);
+            continue;
+        }
+        const int index = songs.size();
+        songIndexes[key] = index;
+        itemSongs.push_back(index);
+        songs.push_back(span);
+    }
+    return arena;
+}
+
+bool SongsRegExpMatcherPrivate::matchSong(size_t song) const
+{
+    const char *str = strings.data() + songs[song].offset;
+    const char *end = str + songs[song].size;
+    while (str < end) {
+        if (g_regex_match(regex, str, (GRegexMatchFlags)0, nullptr))
+            return true;
+        str += std::strlen(str) + 1;
+    }
+    return false;
+}
+
+void SongsRegExpMatcherPrivate::matchSongs(size_t first, size_t last)
+{
+    // Progress is published in batches, so that workers don't fight
+    // for the cache line of the counter
+    const size_t batchSize = 256;
+    for (size_t batch = first; batch < last; batch += batchSize) {
+        if (cancelled.load(std::memory_order_relaxed))
+            return;
+        const size_t batchEnd = std::min(batch + batchSize, last);
+        for (size_t song = batch; song < batchEnd; ++song) {
+            songMatched[song] = matchSong(song);
+        }
+        songsDone += batchEnd - batch;
+    }
+}
+
+void SongsRegExpMatcherPrivate::findSubstring(const std::string& buffer, const std::string& needle)
+{
+    // The whole arena is scanned at once, every hit is mapped back to
+    // the song by its offset. Hits in texts of songs which are not matched
+    // and in garbage between texts are skipped.
+    std::vector<int> order;
+    for (size_t song = 0; song < songs.size(); ++song) {
+        if (songs[song].size)
+            order.push_back(song);
+    }
+    std::sort(order.begin(), order.end(), [this](int left, int right){
+        return songs[left].offset < songs[right].offset;
+    });
+
+    size_t pos = buffer.find(needle);
+    while (pos != std::string::npos) {
+        auto it = std::upper_bound(order.begin(), order.end(), pos, [this](size_t pos, int song){
+            return pos < songs[song].offset;
+        });
+        if (it != order.begin()) {
+            const int song = *(it - 1);
+            const size_t songEnd = songs[song].offset + songs[song].size;
+            if (pos + needle.size() < songEnd) {
+                songMatched[song] = 1;
+                pos = buffer.find(needle, songEnd);
+                continue;
+            }
+        }
+        pos = buffer.find(needle, pos + 1);
+    }
+}
+
+void SongsRegExpMatcherPrivate::checkProgress()
+{
+    const size_t done = songsDone;
+    if (done == songsCount()) {
+        finish();
+    } else {
+        q->progressChanged(done * 100 / songsCount());
+    }
+}
+
+void SongsRegExpMatcherPrivate::finish()
+{
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<int> matchedItems;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (songMatched[itemSongs[i]])
+            matchedItems.push_back(items[i]);
+    }
+    stop();
+    q->finished(matchedItems);
+}
+
+void SongsRegExpMatcherPrivate::abort()
+{
+    stop();
+    q->aborted();
+}
+
+void SongsRegExpMatcherPrivate::stop()
+{
+    cancelled = true;
+    for (auto& worker : workers) {
+        if (worker.joinable())
+            worker.join();
+    }
+    workers.clear();
+    cancelled = false;
+    songsDone = 0;
+
+    progressTimer.stop();
+    for (auto& connection : modelConnections) {
+        connection.disconnect();
+    }
+    modelConnections.clear();
+
+    if (regex) {
+        g_regex_unref(regex);
+        regex = nullptr;
+    }
+    strings.clear();
+    songs.clear();
+    items.clear();
+    itemSongs.clear();
+    songMatched.clear();
+}
@@ -0,0 +1,64 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#ifndef SONGSREGEXPMATCHER_H
+#define SONGSREGEXPMATCHER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "../lib/Object.h"
+
+namespace ncxmms2 {
+
+class PlaylistModel;
+class SongsRegExpMatcherPrivate;
+
+/*   SongsRegExpMatcher matches search texts of playlist songs against a case
+ * insensitive regular expression in worker threads. The search text arena of
+ * the model is copied into an immutable snapshot first, so workers never touch
+ * the model, and every distinct song is matched only once. Patterns without
+ * special characters are found with a plain scan over the arena instead.
+ *   Matching is aborted if entries of the playlist are inserted, removed or moved
+ * before it is finished, as matched positions are not valid anymore.
+ */
+class SongsRegExpMatcher : public Object
+{
+public:
+    explicit SongsRegExpMatcher(Object *parent = nullptr);
+    ~SongsRegExpMatcher();
+
+    // Previous matching is cancelled. Small playlists are matched right away,
+    // so finished may be emitted before start returns. Returns false if
+    // pattern is not a valid regular expression.
+    bool start(PlaylistModel *model, const std::string& pattern);
+    // The same, but only given items are matched, items must be sorted
+    bool start(PlaylistModel *model, const std::string& pattern, const std::vector<int>& items);
+    void cancel();
+    bool isRunning() const;
+
+    // Signals
+    NCXMMS2_SIGNAL(progressChanged, int) // Percent of matched songs
+    NCXMMS2_SIGNAL(finished, const std::vector<int>&) // Sorted list of matched items
+    NCXMMS2_SIGNAL(aborted)
+
+private:
+    std::unique_ptr<SongsRegExpMatcherPrivate> d;
+    friend class SongsRegExpMatcherPrivate;
+};
+} // ncxmms2
+
+#endif // SONGSREGEXPMATCHER_H
@@ -56,6 +56,8 @@ PlaylistsBrowser::PlaylistsBrowser(xmms2::Client *xmmsClient, const Rectangle& r
         throw std::runtime_error(std::string("PlaylistsBrowser: ").append(error.what()));
     }
     m_plsViewer->setLazyLoadPlaylist(true);
+    m_plsViewer->setLazyLoadPrefetchWindow(Settings::value("PlaylistsBrowserScreen", "lazyLoadPrefetchBehind", 50),
+                                           Settings::value("PlaylistsBrowserScreen", "lazyLoadPrefetchAhead", 100));
     m_plsViewer->setHideCurrentItemInterval(0);
     m_plsViewer->hideCurrentItem();
     m_plsViewer->focusLost_Connect([this](){
@@ -65,7 +67,7 @@ PlaylistsBrowser::PlaylistsBrowser(xmms2::Client *xmmsClient, const Rectangle& r
         m_plsViewer->showCurrentItem();
     });
 
-    m_plsListView->currentItemChanged_Connect(&PlaylistsBrowser::setPlsViewerPlaylist, this);
+    m_plsListView->currentItemSettled_Connect(&PlaylistsBrowser::setPlsViewerPlaylist, this);
     m_plsViewer->showSongInfo_Connect(&PlaylistsBrowser::emitShowSongInfo, this);
 }
 
@@ -70,7 +70,7 @@ void PlaylistsListView::keyPressedEvent(const KeyEvent& keyEvent)
         case Hotkeys::Screens::PlaylistsBrowser::RemovePlaylist:
         {
             if (plsModel->itemsCount() > 1) {
-                const std::vector<int>& _selectedItems = selectedItems();
+                const ItemSelection& _selectedItems = selectedItems();
                 if (!_selectedItems.empty()) {
                     for (int item : _selectedItems) {
                         m_xmmsClient->playlistRemove(plsModel->playlist(item));
@@ -19,7 +19,74 @@
 
 using namespace ncxmms2;
 
-void Song::loadInfo(const xmms2::PropDict& info)
+Song::Song(const Song& other) :
+    m_id(other.m_id),
+    m_durartion(other.m_durartion),
+    m_timesPlayed(other.m_timesPlayed),
+    m_bitrate(other.m_bitrate),
+    m_samplerate(other.m_samplerate),
+    m_trackNumber(other.m_trackNumber)
+{
+    for (int i = 0; i < StringsCount; ++i) {
+        m_strings[i] = other.m_strings[i];
+        StringPool::addRef(m_strings[i]);
+    }
+}
+
+Song& Song::operator=(const Song& other)
+{
+    if (this != &other) {
+        m_id          = other.m_id;
+        m_durartion   = other.m_durartion;
+        m_timesPlayed = other.m_timesPlayed;
+        m_bitrate     = other.m_bitrate;
+        m_samplerate  = other.m_samplerate;
+        m_trackNumber = other.m_trackNumber;
+        for (int i = 0; i < StringsCount; ++i) {
+            StringPool::addRef(other.m_strings[i]);
+            StringPool::release(m_strings[i]);
+            m_strings[i] = other.m_strings[i];
+        }
+    }
+    return *this;
+}
+
+Song::Song(Song&& other) noexcept :
+    m_id(other.m_id),
+    m_durartion(other.m_durartion),
+    m_timesPlayed(other.m_timesPlayed),
+    m_bitrate(other.m_bitrate),
+    m_samplerate(other.m_samplerate),
+    m_trackNumber(other.m_trackNumber)
+{
+    std::copy(std::begin(other.m_strings), std::end(other.m_strings), std::begin(m_strings));
+    std::fill(std::begin(other.m_strings), std::end(other.m_strings), 0);
+}
+
+Song& Song::operator=(Song&& other) noexcept
+{
+    if (this != &other) {
+        m_id          = other.m_id;
+        m_durartion   = other.m_durartion;
+        m_timesPlayed = other.m_timesPlayed;
+        m_bitrate     = other.m_bitrate;
+        m_samplerate  = other.m_samplerate;
+        m_trackNumber = other.m_trackNumber;
+        for (int i = 0; i < StringsCount; ++i) {
+            std::swap(m_strings[i], other.m_strings[i]);
+        }
+    }
+    return *this;
+}
+
+Song::~Song()
+{
+    for (StringPool::Handle handle : m_strings) {
+        StringPool::release(handle);
+    }
+}
+
+void Song::loadInfo(const xmms2::Dict& info)
 {
     m_id          = info.value<int>("id");
     m_durartion   = info.value<int>("duration"   , -1);
@@ -28,26 +95,68 @@ void Song::loadInfo(const xmms2::PropDict& info)
     m_bitrate     = info.value<int>("bitrate"    , -1);
     m_samplerate  = info.value<int>("samplerate" , -1);
     
-#define GET_STRING_TAG_VALUE(var, tag) var = info.value<StringRef>(getTagKey(Tag::tag).c_str(), "").c_str()
-    GET_STRING_TAG_VALUE(m_title,       Title);
-    GET_STRING_TAG_VALUE(m_artist,      Artist);
-    GET_STRING_TAG_VALUE(m_album,       Album);
-    GET_STRING_TAG_VALUE(m_albumArtist, AlbumArtist);
-    GET_STRING_TAG_VALUE(m_performer,   Performer);
-    GET_STRING_TAG_VALUE(m_composer,    Composer);
-    GET_STRING_TAG_VALUE(m_date,        Year);
-    GET_STRING_TAG_VALUE(m_genre,       Genre);
+#define GET_STRING_TAG_VALUE(index, tag) setString(index, info.value<StringRef>(getTagKey(Tag::tag).c_str(), "").c_str())
+    GET_STRING_TAG_VALUE(StringTitle,       Title);
+    GET_STRING_TAG_VALUE(StringArtist,      Artist);
+    GET_STRING_TAG_VALUE(StringAlbum,       Album);
+    GET_STRING_TAG_VALUE(StringAlbumArtist, AlbumArtist);
+    GET_STRING_TAG_VALUE(StringPerformer,   Performer);
+    GET_STRING_TAG_VALUE(StringComposer,    Composer);
+    GET_STRING_TAG_VALUE(StringDate,        Year);
+    GET_STRING_TAG_VALUE(StringGenre,       Genre);
 #undef GET_STRING_TAG_VALUE
     
-    m_url.clear();
-    m_fileName.clear();
     StringRef urlRef = info.value<StringRef>("url");
     if (!urlRef.isNull()) {
-        m_url = xmms2::decodeUrl(urlRef.c_str());
-        m_fileName = xmms2::getFileNameFromUrl(m_url);
+        const std::string url = xmms2::decodeUrl(urlRef.c_str());
+        setString(StringUrl, url);
+        setString(StringFileName, xmms2::getFileNameFromUrl(url));
+    } else {
+        setString(StringUrl, "");
+        setString(StringFileName, "");
     }
 }
 
+void Song::setString(int index, const char *str)
+{
+    // Intern before release, so an unchanged string is not freed and reinterned
+    const StringPool::Handle handle = StringPool::intern(str);
+    StringPool::release(m_strings[index]);
+    m_strings[index] = handle;
+}
+
+void Song::setString(int index, const char *str, size_t size)
+{
+    const StringPool::Handle handle = StringPool::intern(str, size);
+    StringPool::release(m_strings[index]);
+    m_strings[index] = handle;
+}
+
+void Song::setString(int index, const std::string& str)
+{
+    const StringPool::Handle handle = StringPool::intern(str);
+    StringPool::release(m_strings[index]);
+    m_strings[index] = handle;
+}
+
+const std::vector<std::string>& Song::infoKeys()
+{
+    static const std::vector<std::string> keys =
+    {
+        "id", "duration", "tracknr", "timesplayed", "bitrate", "samplerate",
+        getTagKey(Tag::Title).c_str(),
+        getTagKey(Tag::Artist).c_str(),
+        getTagKey(Tag::Album).c_str(),
+        getTagKey(Tag::AlbumArtist).c_str(),
+        getTagKey(Tag::Performer).c_str(),
+        getTagKey(Tag::Composer).c_str(),
+        getTagKey(Tag::Year).c_str(),
+        getTagKey(Tag::Genre).c_str(),
+        "url"
+    };
+    return keys;
+}
+
 StringRef Song::getTagKey(Song::Tag tag)
 {
     switch (tag) {
@@ -18,12 +18,17 @@
 #define SONG_H
 
 #include <string>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
 #include "lib/StringRef.h"
+#include "lib/StringPool.h"
 
 namespace ncxmms2 {
 
 namespace xmms2 {
-class PropDict;
+class Dict;
 }
 
 class Song
@@ -32,12 +37,24 @@ public:
     Song() :
         m_id(0),
         m_durartion(-1),
-        m_trackNumber(-1),
         m_timesPlayed(-1),
         m_bitrate(-1),
-        m_samplerate(-1) {}
+        m_samplerate(-1),
+        m_trackNumber(-1)
+    {
+        std::fill(std::begin(m_strings), std::end(m_strings), 0);
+    }
+
+    Song(const Song& other);
+    Song& operator=(const Song& other);
+    Song(Song&& other) noexcept;
+    Song& operator=(Song&& other) noexcept;
+    ~Song();
 
-    void loadInfo(const xmms2::PropDict& info);
+    void loadInfo(const xmms2::Dict& info);
+    
+    // Medialib keys used by loadInfo, suitable as fetch list for collection queries
+    static const std::vector<std::string>& infoKeys();
 
     int id() const                            {return m_id;}
     int duration() const                      {return m_durartion;}
@@ -45,16 +62,16 @@ public:
     int timesPlayed() const                   {return m_timesPlayed;}
     int bitrate() const                       {return m_bitrate;}
     int samplerate() const                    {return m_samplerate;}
-    const std::string& title() const          {return m_title;}
-    const std::string& artist() const         {return m_artist;}
-    const std::string& album() const          {return m_album;}
-    const std::string& albumArtist() const    {return m_albumArtist;}
-    const std::string& performer() const      {return m_performer;}
-    const std::string& composer() const       {return m_composer;}
-    const std::string& date() const           {return m_date;}
-    const std::string& genre() const          {return m_genre;}
-    const std::string& url() const            {return m_url;}
-    const std::string& fileName() const       {return m_fileName;}
+    const std::string& title() const          {return string(StringTitle);}
+    const std::string& artist() const         {return string(StringArtist);}
+    const std::string& album() const          {return string(StringAlbum);}
+    const std::string& albumArtist() const    {return string(StringAlbumArtist);}
+    const std::string& performer() const      {return string(StringPerformer);}
+    const std::string& composer() const       {return string(StringComposer);}
+    const std::string& date() const           {return string(StringDate);}
+    const std::string& genre() const          {return string(StringGenre);}
+    const std::string& url() const            {return string(StringUrl);}
+    const std::string& fileName() const       {return string(StringFileName);}
 
     enum class Tag
     {
@@ -71,22 +88,37 @@ public:
     static StringRef getTagKey(Tag tag);
 
 private:
-    int m_id;
-    int m_durartion;
-    int m_trackNumber;
-    int m_timesPlayed;
-    int m_bitrate;
-    int m_samplerate;
-    std::string m_title;
-    std::string m_artist;
-    std::string m_album;
-    std::string m_albumArtist;
-    std::string m_performer;
-    std::string m_composer;
-    std::string m_date;
-    std::string m_genre;
-    std::string m_url;
-    std::string m_fileName;
+    // Strings are interned in StringPool, song keeps only their handles,
+    // so songs from the same album share artist, album, genre, etc.
+    enum
+    {
+        StringTitle,
+        StringArtist,
+        StringAlbum,
+        StringAlbumArtist,
+        StringPerformer,
+        StringComposer,
+        StringDate,
+        StringGenre,
+        StringUrl,
+        StringFileName,
+        StringsCount
+    };
+
+    int32_t m_id;
+    int32_t m_durartion;
+    int32_t m_timesPlayed;
+    int32_t m_bitrate;
+    int32_t m_samplerate;
+    int32_t m_trackNumber;
+    StringPool::Handle m_strings[StringsCount];
+
+    const std::string& string(int index) const {return StringPool::get(m_strings[index]);}
+    void setString(int index, const char *str);
+    void setString(int index, const char *str, size_t size);
+    void setString(int index, const std::string& str);
+
+    friend class SongInfoCache;
 };
 } // ncxmms2
 
@@ -24,7 +24,9 @@
 
 using namespace ncxmms2;
 
-SongDisplayFormatParser::SongDisplayFormatParser()
+SongDisplayFormatParser::SongDisplayFormatParser() :
+    m_sectionsVariables(0),
+    m_columnsSizeWidth(-1)
 {
 
 }
@@ -32,6 +34,11 @@ SongDisplayFormatParser::SongDisplayFormatParser()
 bool SongDisplayFormatParser::setDisplayFormat(const std::string& formatString)
 {
     m_columns.clear();
+    m_program.clear();
+    m_variables.clear();
+    m_sections.clear();
+    m_sectionsVariables = 0;
+    m_columnsSizeWidth = -1;
 
     auto ensureNotNullChar = [](const char *ptr)
     {
@@ -56,6 +63,30 @@ bool SongDisplayFormatParser::setDisplayFormat(const std::string& formatString)
         return result;
     };
 
+    bool haveOpenedBrace = false;
+    bool haveSectionOr = false;
+    int openedSection = -1;
+    std::vector<int> sectionEnds; // Ends of sections connected with or
+
+    auto finishSections = [this, &sectionEnds]()
+    {
+        for (int sectionEnd : sectionEnds) {
+            m_program[sectionEnd].jump = m_program.size();
+        }
+        sectionEnds.clear();
+    };
+
+    auto addInstruction = [&](Instruction::Op op, int arg) -> int
+    {
+        // Anything but a section connected with or ends the previous sections
+        if (!haveOpenedBrace && !haveSectionOr)
+            finishSections();
+        haveSectionOr = false;
+        const Instruction instruction = {op, arg, 0};
+        m_program.push_back(instruction);
+        return m_program.size() - 1;
+    };
+
     try
     {
         if (formatString.empty())
@@ -64,15 +95,18 @@ bool SongDisplayFormatParser::setDisplayFormat(const std::string& formatString)
         if (formatString[0] != '[')
             throw ParsingError("Unexpected symbol '%c' at position 0, expected '['.", formatString[0]);
 
-        bool haveOpenedBrace = false;
         for (const char *p = formatString.c_str(); *p; ++p) {
             switch (*p) {
                 case '[': // Column spec begin
                 {
                     if (haveOpenedBrace)
                         throw ParsingError("Unbalanced braces.");
+                    finishSections();
+                    if (!m_columns.empty())
+                        m_columns.back().setEnd(m_program.size());
                     m_columns.emplace_back();
                     Column& column = m_columns.back();
+                    column.setBegin(m_program.size());
                     ensureNotNullChar(++p);
                     switch (*p) {
                         case 'r': column.setAlign(Column::Alignment::Right);  break;
@@ -98,10 +132,20 @@ bool SongDisplayFormatParser::setDisplayFormat(const std::string& formatString)
                 case '$': // Variable
                 {
                     ensureNotNullChar(++p);
-                    Token& token = m_columns.back().addToken(Token::Type::Variable);
-                    if (!token.setVariable(*p))
-                        throw ParsingError("Unknown variable $%c at position %d.",
-                                           *p, p - formatString.c_str() - 1);
+                    size_t variable = 0;
+                    while (variable < m_variables.size() && m_variables[variable].key() != *p)
+                        ++variable;
+                    if (variable == m_variables.size()) {
+                        m_variables.emplace_back();
+                        if (!m_variables.back().init(*p))
+                            throw ParsingError("Unknown variable $%c at position %d.",
+                                               *p, p - formatString.c_str() - 1);
+                    }
+                    if (haveOpenedBrace) {
+                        m_sections.back() |= uint64_t(1) << variable;
+                        m_sectionsVariables |= uint64_t(1) << variable;
+                    }
+                    addInstruction(Instruction::Op::Variable, variable);
                     break;
                 }
 
@@ -109,27 +153,30 @@ bool SongDisplayFormatParser::setDisplayFormat(const std::string& formatString)
                 {
                     const char *pStart = p;
                     ensureNotNullChar(++p);
-                    Token& token = m_columns.back().addToken(Token::Type::Color);
                     const int value = readNumber(formatString.c_str(), &p, 'c');
                     const int color = getColorByKey(value);
                     if (color == -1)
                         throw ParsingError("Unknown color %d at position %d.",
                                            value, pStart - formatString.c_str());
-                    token.setColor(static_cast<Color>(color));
+                    addInstruction(Instruction::Op::Color, color);
                     break;
                 }
 
                 case '{': // Section begin
-                    m_columns.back().addToken(Token::Type::SectionOpenBrace);
                     if (haveOpenedBrace)
                         throw ParsingError("Sections can't be nested.");
+                    if (m_sections.size() == 64)
+                        throw ParsingError("Too many sections, at most 64 are supported.");
+                    m_sections.push_back(0);
+                    openedSection = addInstruction(Instruction::Op::Section, m_sections.size() - 1);
                     haveOpenedBrace = true;
                     break;
 
                 case '}': // Section end
-                    m_columns.back().addToken(Token::Type::SectionCloseBrace);
                     if (!haveOpenedBrace)
                         throw ParsingError("Unbalanced braces.");
+                    sectionEnds.push_back(addInstruction(Instruction::Op::SectionEnd, 0));
+                    m_program[openedSection].jump = m_program.size();
                     haveOpenedBrace = false;
                     break;
 
@@ -141,7 +188,7 @@ bool SongDisplayFormatParser::setDisplayFormat(const std::string& formatString)
                     if (*(p + 1) != '{')
                         throw ParsingError("Unexpected symbol '%c' at position %d, expected '{'.",
                                            *(p + 1), p + 1 - formatString.c_str());
-                    m_columns.back().addToken(Token::Type::SectionOr);
+                    haveSectionOr = true;
                     break;
 
                 case '\\': // Escape
@@ -152,19 +199,24 @@ bool SongDisplayFormatParser::setDisplayFormat(const std::string& formatString)
                     if (!g_ascii_isprint(*p))
                         throw ParsingError("Unexpected symbol '%c' at position %d.",
                                            *p, p - formatString.c_str());
-                    Token& token = m_columns.back().addToken(Token::Type::Character);
-                    token.setCharacter(*p);
+                    addInstruction(Instruction::Op::Character, *p);
                     break;
                 }
             }
         }
         if (haveOpenedBrace)
             throw ParsingError("Unbalanced braces.");
+        finishSections();
+        m_columns.back().setEnd(m_program.size());
     }
     catch (const ParsingError& error)
     {
         m_errorString = error.what();
         m_columns.clear();
+        m_program.clear();
+        m_variables.clear();
+        m_sections.clear();
+        m_sectionsVariables = 0;
         return false;
     }
 
@@ -173,6 +225,9 @@ bool SongDisplayFormatParser::setDisplayFormat(const std::string& formatString)
 
 void SongDisplayFormatParser::calculateColumnsSize(const Rectangle& rect)
 {
+    if (rect.cols() == m_columnsSizeWidth)
+        return;
+
     int factorsSum = 0;
     int sizeLeft = rect.cols();
     int notFixedColumnCount = 0;
@@ -206,34 +261,91 @@ void SongDisplayFormatParser::calculateColumnsSize(const Rectangle& rect)
     }
     if (lastNotFixedColumn >= 0)
         m_columns[lastNotFixedColumn].setSize(sizeLeft);
+    m_columnsSizeWidth = rect.cols();
+}
+
+uint64_t SongDisplayFormatParser::emptySections(const Song& song) const
+{
+    if (!m_sectionsVariables)
+        return 0;
+
+    uint64_t emptyVariables = 0;
+    for (size_t i = 0; i < m_variables.size(); ++i) {
+        const uint64_t variable = uint64_t(1) << i;
+        if ((m_sectionsVariables & variable) && m_variables[i].isEmpty(song))
+            emptyVariables |= variable;
+    }
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < m_sections.size(); ++i) {
+        if (m_sections[i] & emptyVariables)
+            result |= uint64_t(1) << i;
+    }
+    return result;
+}
+
+int SongDisplayFormatParser::columnContentSize(const Column& column, const Song& song,
+                                               uint64_t emptySections) const
+{
+    int size = 0;
+    runColumn(column, emptySections, [this, &song, &size](const Instruction& instruction)
+    {
+        switch (instruction.op) {
+            case Instruction::Op::Variable:
+                size += m_variables[instruction.arg].size(song);
+                break;
+
+            case Instruction::Op::Character:
+                ++size;
+                break;
+
+            default:
+                break;
+        }
+        return true;
+    });
+    return size;
 }
 
 void SongDisplayFormatParser::paint(const Song& song, Painter *painter,
-                                    const Rectangle& rect, bool ignoreColors)
+                                    const Rectangle& rect, bool ignoreColors,
+                                    RenderedRow *row)
 {
+    if (row)
+        row->clear();
+
     if (G_UNLIKELY(m_columns.empty()))
         return;
     
     calculateColumnsSize(rect);
+    const uint64_t songEmptySections = emptySections(song);
+
+    auto move = [painter, &rect, row](int x)
+    {
+        painter->move(x, rect.y());
+        if (row)
+            row->addCommand(RenderedRow::Command::Type::Move, x - rect.x());
+    };
+    std::string value;
     
     int xPos = rect.x();
     for (auto& column : m_columns) {
         int sizeLeft = 0;
         switch (column.align()) {
             case Column::Alignment::Left:
-                painter->move(xPos, rect.y());
+                move(xPos);
                 sizeLeft = column.size();
                 break;
 
             case Column::Alignment::Center:
             {
-                const int contentSize = column.calculateContentSize(song);
+                const int contentSize = columnContentSize(column, song, songEmptySections);
                 const int xShift = (column.size() - contentSize) / 2;
                 if (xShift > 0) {
-                    painter->move(xPos + xShift, rect.y());
+                    move(xPos + xShift);
                     sizeLeft = column.size() - xShift;
                 } else {
-                    painter->move(xPos, rect.y());
+                    move(xPos);
                     sizeLeft = column.size();
                 }
                 break;
@@ -241,13 +353,13 @@ void SongDisplayFormatParser::paint(const Song& song, Painter *painter,
 
             case Column::Alignment::Right:
             {
-                const int contentSize = column.calculateContentSize(song);
+                const int contentSize = columnContentSize(column, song, songEmptySections);
                 const int xShift = column.size() - contentSize;
                 if (xShift > 0) {
-                    painter->move(xPos + xShift, rect.y());
+                    move(xPos + xShift);
                     sizeLeft = column.size() - xShift;
                 } else {
-                    painter->move(xPos, rect.y());
+                    move(xPos);
                     sizeLeft = column.size();
                 }
                 break;
@@ -255,91 +367,115 @@ void SongDisplayFormatParser::paint(const Song& song, Painter *painter,
 
         }
 
-        for (auto it = column.getFormatTokenIterator(song); it.isValid(); it.next()) {
-            const auto& token = it.get();
-            switch (token.type()) {
-                case Token::Type::Variable:
+        runColumn(column, songEmptySections, [&](const Instruction& instruction)
+        {
+            switch (instruction.op) {
+                case Instruction::Op::Variable:
                 {
                     const int oldX = painter->x();
-                    token.variable().print(painter, song, sizeLeft);
+                    if (row) {
+                        value.clear();
+                        m_variables[instruction.arg].appendTo(song, &value);
+                        Painter::squeeze(&value, sizeLeft);
+                        painter->printString(value);
+                        row->addText(value.data(), value.size());
+                    } else {
+                        m_variables[instruction.arg].print(painter, song, sizeLeft);
+                    }
                     sizeLeft -= painter->x() - oldX;
                     break;
                 }
 
-                case Token::Type::Character:
-                    painter->printChar(token.character());
+                case Instruction::Op::Character:
+                {
+                    const char ch = static_cast<char>(instruction.arg);
+                    painter->printChar(ch);
+                    if (row)
+                        row->addText(&ch, 1);
                     --sizeLeft;
                     break;
+                }
 
-                case Token::Type::Color:
+                case Instruction::Op::Color:
                     if (!ignoreColors)
-                        painter->setColor(token.color());
+                        painter->setColor(static_cast<Color>(instruction.arg));
+                    if (row)
+                        row->addCommand(RenderedRow::Command::Type::Color, instruction.arg);
                     break;
 
                 default:
                     assert(false);
                     break;
             }
-            if (sizeLeft <= 0)
-                break;
-        }
+            return sizeLeft > 0;
+        });
         xPos += column.size();
     }
+
+    if (row)
+        row->m_cols = rect.cols();
 }
 
-bool SongDisplayFormatParser::matchFormattedString(const Song& song, const GRegex *regex)
+void SongDisplayFormatParser::paint(const RenderedRow& row, Painter *painter,
+                                    const Rectangle& rect, bool ignoreColors)
 {
-    for (auto& column : m_columns) {
-        for (auto it = column.getFormatTokenIterator(song); it.isValid(); it.next()) {
-            const auto& token = it.get();
-            switch (token.type()) {
-                case Token::Type::Variable:
-                {
-                    const bool match = g_regex_match(regex, token.variable().toString(song).c_str(),
-                                                     (GRegexMatchFlags)0, nullptr);
-                    if (match)
-                        return true;
-                    break;
-                }
+    assert(row.cols() == rect.cols());
+    const char *text = row.m_text.data();
+    for (const auto& command : row.m_commands) {
+        switch (command.type) {
+            case RenderedRow::Command::Type::Move:
+                painter->move(rect.x() + command.value, rect.y());
+                break;
 
-               // NOTE: Current implementation ignores single characters.
-               //       Is it OK ?
-                case Token::Type::Character:
-                case Token::Type::Color:
-                    break;
+            case RenderedRow::Command::Type::Color:
+                if (!ignoreColors)
+                    painter->setColor(static_cast<Color>(command.value));
+                break;
 
-                default:
-                    assert(false);
-                    break;
-            }
+            case RenderedRow::Command::Type::Text:
+                painter->printString(text + command.value, text + command.value + command.size);
+                break;
         }
     }
-    return false;
+}
+
+void SongDisplayFormatParser::appendMatchStrings(const Song& song, std::string *buffer) const
+{
+    // NOTE: Current implementation ignores single characters.
+    //       Is it OK ?
+    const uint64_t songEmptySections = emptySections(song);
+    for (auto& column : m_columns) {
+        runColumn(column, songEmptySections, [this, &song, buffer](const Instruction& instruction)
+        {
+            if (instruction.op == Instruction::Op::Variable) {
+                m_variables[instruction.arg].appendTo(song, buffer);
+                buffer->push_back('\0');
+            }
+            return true;
+        });
+    }
 }
 
 std::string SongDisplayFormatParser::formattedString(const Song& song, int column) const
 {
     assert((size_t)column < m_columns.size());
     std::string str;
-    for (auto it = m_columns[column].getFormatTokenIterator(song); it.isValid(); it.next()) {
-        const auto& token = it.get();
-        switch (token.type()) {
-            case Token::Type::Variable:
-                str.append(token.variable().toString(song));
-                break;
-           
-            case Token::Type::Character:
-                str.push_back(token.character());
+    runColumn(m_columns[column], emptySections(song), [this, &song, &str](const Instruction& instruction)
+    {
+        switch (instruction.op) {
+            case Instruction::Op::Variable:
+                m_variables[instruction.arg].appendTo(song, &str);
                 break;
 
-            case Token::Type::Color:
+            case Instruction::Op::Character:
+                str.push_back(static_cast<char>(instruction.arg));
                 break;
 
             default:
-                assert(false);
                 break;
         }
-    }
+        return true;
+    });
     return str;
 }
 
@@ -391,6 +527,7 @@ int SongDisplayFormatParser::getColorByKey(char key)
 
 bool SongDisplayFormatParser::Variable::init(char key)
 {
+    m_key = key;
     m_songStrRefFuncPtr = nullptr;
     switch (key) {
         case 'a': m_songStrRefFuncPtr = &Song::artist;      break;
@@ -537,6 +674,56 @@ std::string SongDisplayFormatParser::Variable::toString(const Song& song) const
     return std::string();
 }
 
+void SongDisplayFormatParser::Variable::appendTo(const Song& song, std::string *buffer) const
+{
+    switch (m_type) {
+        case Type::StringRef:
+            buffer->append((song.*m_songStrRefFuncPtr)());
+            break;
+
+        case Type::String:
+            buffer->append((*m_stringFuncPtr)(song));
+            break;
+
+        case Type::Integer:
+        {
+            const int value = (song.*m_songIntFuncPtr)();
+            if (value != -1) {
+                char str[16];
+                buffer->append(str, std::sprintf(str, "%d", value));
+            }
+            break;
+        }
+
+        case Type::None:
+            assert(false);
+    }
+}
+
+void SongDisplayFormatParser::RenderedRow::clear()
+{
+    m_cols = -1;
+    m_commands.clear();
+    m_text.clear();
+}
+
+void SongDisplayFormatParser::RenderedRow::addCommand(Command::Type type, int value, int size)
+{
+    const Command command = {type, value, size};
+    m_commands.push_back(command);
+}
+
+void SongDisplayFormatParser::RenderedRow::addText(const char *str, size_t size)
+{
+    // Adjacent pieces of text are printed at once
+    if (!m_commands.empty() && m_commands.back().type == Command::Type::Text) {
+        m_commands.back().size += size;
+    } else {
+        addCommand(Command::Type::Text, m_text.size(), size);
+    }
+    m_text.append(str, size);
+}
+
 std::string SongDisplayFormatParser::Variable::durationStringGenerator(const Song& song)
 {
     return song.duration() != -1 ? Utils::getTimeStringFromInt(song.duration()) : std::string();
@@ -557,29 +744,3 @@ std::string SongDisplayFormatParser::Variable::samplerateStringGenerator(const S
 
     return std::to_string(song.samplerate()).append("Hz");
 }
-
-
-int SongDisplayFormatParser::Column::calculateContentSize(const Song& song) const
-{
-    int size = 0;
-    for (auto it = getFormatTokenIterator(song); it.isValid(); it.next()) {
-        const auto& token = it.get();
-        switch (token.type()) {
-            case Token::Type::Variable:
-                size += token.variable().size(song);
-                break;
-
-            case Token::Type::Character:
-                ++size;
-                break;
-
-            case Token::Type::Color:
-                break;
-
-            default:
-                assert(false);
-                break;
-        }
-    }
-    return size;
-}
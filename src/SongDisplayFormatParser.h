@@ -19,6 +19,7 @@
 
 #include <vector>
 #include <utility>
+#include <cstdint>
 #include <stdexcept>
 #include <assert.h>
 
@@ -28,8 +29,6 @@
 #include "lib/Colors.h"
 #include "lib/Rectangle.h"
 
-typedef struct _GRegex GRegex;
-
 namespace ncxmms2 {
 
 class Painter;
@@ -93,9 +92,52 @@ public:
 
     const std::string& errorString() const {return m_errorString;}
 
-    void paint(const Song& song, Painter *painter, const Rectangle& rect, bool ignoreColors = false);
+    //   Row painted for a song, recorded as painter commands relative to the
+    // rectangle, so that an unchanged row is painted again without formatting
+    // the song. Colors are recorded even when they are ignored.
+    class RenderedRow
+    {
+    public:
+        RenderedRow() : m_cols(-1) {}
+
+        int cols() const {return m_cols;} // Width of the row, -1 if nothing is recorded
+        void clear();
+
+    private:
+        friend class SongDisplayFormatParser;
+
+        struct Command
+        {
+            enum class Type : uint8_t
+            {
+                Move,
+                Color,
+                Text
+            };
+
+            Type type;
+            int value; // Column, color or offset of text
+            int size;  // Size of text
+        };
+
+        int m_cols;
+        std::vector<Command> m_commands;
+        std::string m_text;
 
-    bool matchFormattedString(const Song& song, const GRegex *regex); // Used to select items in PlaylistView
+        void addCommand(Command::Type type, int value, int size = 0);
+        void addText(const char *str, size_t size);
+    };
+
+    // Painted row is recorded to row when it is not null
+    void paint(const Song& song, Painter *painter, const Rectangle& rect,
+               bool ignoreColors = false, RenderedRow *row = nullptr);
+    // Paints recorded row, rect must be of the same width
+    static void paint(const RenderedRow& row, Painter *painter, const Rectangle& rect,
+                      bool ignoreColors = false);
+
+    // Appends strings of all variables shown for the song, each one is terminated
+    // by '\0'. Used to select items in PlaylistView by regular expression.
+    void appendMatchStrings(const Song& song, std::string *buffer) const;
     
     std::string formattedString(const Song& song, int column) const;
     
@@ -107,13 +149,16 @@ private:
     {
     public:
         Variable() :
-            m_type(Type::None) {}
+            m_type(Type::None),
+            m_key('\0') {}
 
         bool init(char key);
+        char key() const {return m_key;}
         bool isEmpty(const Song& song) const;
         int size(const Song& song) const;
         void print(Painter *painter, const Song& song, int maxLength) const;
         std::string toString(const Song& song) const;
+        void appendTo(const Song& song, std::string *buffer) const;
 
     private:
         enum class Type
@@ -125,6 +170,7 @@ private:
         };
 
         Type m_type;
+        char m_key;
         union
         {
             const std::string& (Song::*m_songStrRefFuncPtr)() const;
@@ -137,146 +183,25 @@ private:
         static std::string samplerateStringGenerator(const Song& song);
     };
 
-    class Token
+    //   Format string is compiled into a flat program, every column is a range
+    // of its instructions. Section instruction jumps over the section when it
+    // is empty for the song, i.e. when any of its variables is empty, to the
+    // next section connected with or or past the sections. SectionEnd jumps
+    // past the rest of sections connected with or.
+    struct Instruction
     {
-    public:
-        enum class Type
+        enum class Op : uint8_t
         {
             Character,
             Variable,
             Color,
-            SectionOpenBrace,
-            SectionCloseBrace,
-            SectionOr
-        };
-
-        Token(Type type) : m_type(type)
-        {
-            if (m_type == Type::Variable)
-                new (&m_variable) Variable();
-        }
-
-        Type type() const {return m_type;}
-
-        char character() const
-        {
-            assert(m_type == Type::Character);
-            return m_character;
-        }
-
-        const Variable& variable() const
-        {
-            assert(m_type == Type::Variable);
-            return m_variable;
-        }
-
-        Color color() const
-        {
-            assert(m_type == Type::Color);
-            return m_color;
-        }
-
-        void setCharacter(char ch)
-        {
-            assert(m_type == Type::Character);
-            m_character = ch;
-        }
-
-        bool setVariable(char key)
-        {
-            assert(m_type == Type::Variable);
-            return m_variable.init(key);
-        }
-
-        void setColor(Color color)
-        {
-            assert(m_type == Type::Color);
-            m_color = color;
-        }
-        
-    private:
-        Type m_type;
-        union
-        {
-            char m_character;
-            Variable m_variable;
-            Color m_color;
+            Section,
+            SectionEnd
         };
-    };
 
-    //   FormatTokenIterator allows to iterate through first not empty
-    // section of the column.
-    template <typename Iterator>
-    class FormatTokenIterator
-    {
-    public:
-        FormatTokenIterator(const Song& song, Iterator begin, Iterator end) :
-            m_song(song),
-            m_it(begin),
-            m_itEnd(end)
-        {
-            checkIterator();
-        }
-
-        bool isValid() const {return m_it != m_itEnd;}
-
-        void next()
-        {
-            ++m_it;
-            checkIterator();
-        }
-
-        const Token& get() const
-        {
-            assert(m_it->type() != Token::Type::SectionOpenBrace);
-            assert(m_it->type() != Token::Type::SectionCloseBrace);
-            assert(m_it->type() != Token::Type::SectionOr);
-            return *m_it;
-        }
-
-    private:
-        const Song& m_song;
-        Iterator m_it;
-        Iterator m_itEnd;
-
-        // Checks if an iterator points inside not empty section,
-        // otherwise find first non empty one if exists.
-        void checkIterator()
-        {
-            if (m_it == m_itEnd)
-                return;
-
-            if (m_it->type() == Token::Type::SectionOpenBrace) {
-                ++m_it;
-                bool isSectionEmpty = false;
-                auto it = m_it;
-                for (; it->type() != Token::Type::SectionCloseBrace; ++it) {
-                    if (!isSectionEmpty && it->type() == Token::Type::Variable) {
-                        if (it->variable().isEmpty(m_song))
-                            isSectionEmpty = true;
-                    }
-                }
-
-                if (isSectionEmpty) {
-                    m_it = it + 1;
-                    if (m_it == m_itEnd)
-                        return;
-                    if (m_it->type() == Token::Type::SectionOr) {
-                        ++m_it;
-                        checkIterator();
-                    }
-
-                }
-            } else if (m_it->type() == Token::Type::SectionCloseBrace) {
-                ++m_it;
-                if (m_it == m_itEnd)
-                    return;
-                if (m_it->type() == Token::Type::SectionOr)
-                    for (; m_it->type() != Token::Type::SectionCloseBrace; ++m_it);
-
-                checkIterator();
-            }
-        }
+        Op op;
+        int arg;  // Character, index of variable, color or index of section
+        int jump; // Section and SectionEnd only
     };
 
     class Column
@@ -285,7 +210,9 @@ private:
         Column() :
             m_align(Alignment::Left),
             m_factor(0),
-            m_size(0) {}
+            m_size(0),
+            m_begin(0),
+            m_end(0) {}
 
         enum class Alignment
         {
@@ -297,32 +224,21 @@ private:
         Alignment align() const        {return m_align;}
         int factor() const             {return m_factor;}
         int size() const               {return m_size;}
-        int calculateContentSize(const Song& song) const;
+        int begin() const              {return m_begin;}
+        int end() const                {return m_end;}
 
         void setAlign(Alignment align) {m_align = align;}
         void setFactor(int factor)     {m_factor = factor;}
         void setSize(int size)         {m_size = size;}
-
-        Token& addToken(Token::Type type)
-        {
-            m_tokens.emplace_back(type);
-            return m_tokens.back();
-        }
-
-        FormatTokenIterator<std::vector<Token>::const_iterator>
-        getFormatTokenIterator(const Song& song) const
-        {
-            return FormatTokenIterator<std::vector<Token>::const_iterator>(song,
-                                                                           m_tokens.cbegin(),
-                                                                           m_tokens.cend());
-        }
+        void setBegin(int begin)       {m_begin = begin;}
+        void setEnd(int end)           {m_end = end;}
 
     private:
         Alignment m_align;
         int m_factor;
         int m_size;
-        std::vector<Token> m_tokens;
-
+        int m_begin;
+        int m_end;
     };
 
     class ParsingError : public std::runtime_error
@@ -336,8 +252,46 @@ private:
 
     std::string m_errorString;
     std::vector<Column> m_columns;
+    std::vector<Instruction> m_program;
+    std::vector<Variable> m_variables; // Distinct variables of the format
+    std::vector<uint64_t> m_sections;  // Mask of variables of every section
+    uint64_t m_sectionsVariables;      // Mask of variables used in sections
+
+    // Sizes of not fixed columns are calculated once per width of the rectangle
+    int m_columnsSizeWidth;
 
     void calculateColumnsSize(const Rectangle& rect);
+    // Mask of sections empty for the song, evaluated once per painted song
+    uint64_t emptySections(const Song& song) const;
+    int columnContentSize(const Column& column, const Song& song, uint64_t emptySections) const;
+
+    // Calls f for Character, Variable and Color instructions of the column
+    // which are shown for the song, until f returns false
+    template <typename F>
+    void runColumn(const Column& column, uint64_t emptySections, F f) const
+    {
+        const Instruction *program = m_program.data();
+        int pc = column.begin();
+        while (pc < column.end()) {
+            const Instruction& instruction = program[pc];
+            switch (instruction.op) {
+                case Instruction::Op::Section:
+                    pc = emptySections & (uint64_t(1) << instruction.arg) ? instruction.jump : pc + 1;
+                    break;
+
+                case Instruction::Op::SectionEnd:
+                    pc = instruction.jump;
+                    break;
+
+                default:
+                    if (!f(instruction))
+                        return;
+                    ++pc;
+                    break;
+            }
+        }
+    }
+
     static int getColorByKey(char key);
 };
 } // ncxmms2
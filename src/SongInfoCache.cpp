@@ -0,0 +1,405 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <glib.h>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SongInfoCache.h"
+#include "Log.h"
+
+using namespace ncxmms2;
+
+namespace {
+
+// Cache is a local file, all values are stored in the native byte order
+const char cacheMagic[8] = {'N', 'C', 'X', 'M', 'M', 'S', '2', 'C'};
+const uint32_t cacheVersion = 2;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t serverHash;
+    uint32_t count;
+};
+
+uint32_t hashString(const std::string& str)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : str) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+bool readValue(const char **data, const char *end, T *value)
+{
+    if ((size_t)(end - *data) < sizeof(T))
+        return false;
+    std::memcpy(value, *data, sizeof(T));
+    *data += sizeof(T);
+    return true;
+}
+
+template <typename T>
+void writeValue(std::vector<char> *buffer, T value)
+{
+    const char *data = reinterpret_cast<const char*>(&value);
+    buffer->insert(buffer->end(), data, data + sizeof(T));
+}
+
+}
+
+SongInfoCache::SongInfoCache() :
+    m_isOpen(false),
+    m_modified(false),
+    m_serverHash(0),
+    m_data(nullptr),
+    m_dataSize(0),
+    m_index(nullptr),
+    m_indexSize(0),
+    m_deadBytes(0)
+{
+
+}
+
+SongInfoCache::~SongInfoCache()
+{
+    unmap();
+}
+
+bool SongInfoCache::open(const std::string& filePath, const std::string& serverId)
+{
+    SongInfoCache& cache = instance();
+    close();
+
+    cache.m_filePath = filePath;
+    cache.m_serverHash = hashString(serverId);
+    cache.m_isOpen = true;
+
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd == -1) {
+        // No cache yet, it's created on save
+        gchar *cacheDir = g_path_get_dirname(filePath.c_str());
+        const int err = g_mkdir_with_parents(cacheDir, 0755);
+        g_free(cacheDir);
+        if (err == -1) {
+            NCXMMS2_LOG_ERROR("Can't create songs info cache directory for %s", filePath);
+            cache.m_isOpen = false;
+        }
+        return cache.m_isOpen;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(FileHeader)) {
+        void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            cache.m_data = static_cast<const char*>(data);
+            cache.m_dataSize = st.st_size;
+        }
+    }
+    ::close(fd);
+
+    if (!cache.m_data)
+        return true;
+
+    FileHeader header;
+    std::memcpy(&header, cache.m_data, sizeof(header));
+    const bool valid = std::equal(std::begin(cacheMagic), std::end(cacheMagic), header.magic)
+                       && header.version == cacheVersion
+                       && header.count <= (cache.m_dataSize - sizeof(FileHeader)) / sizeof(IndexEntry);
+    if (!valid) {
+        // Outdated or broken file, it is rewritten on save
+        NCXMMS2_LOG_ERROR("Ignoring invalid songs info cache %s", filePath);
+        cache.unmap();
+        cache.m_modified = true;
+        return true;
+    }
+
+    if (header.serverHash != cache.m_serverHash) {
+        // Medialib ids of another server mean nothing here
+        cache.unmap();
+        cache.m_modified = true;
+        return true;
+    }
+
+    cache.m_index = reinterpret_cast<const IndexEntry*>(cache.m_data + sizeof(FileHeader));
+    cache.m_indexSize = header.count;
+    return true;
+}
+
+bool SongInfoCache::isOpen()
+{
+    return instance().m_isOpen;
+}
+
+bool SongInfoCache::save()
+{
+    SongInfoCache& cache = instance();
+    if (!cache.m_isOpen || !cache.m_modified)
+        return true;
+
+    struct SavedRecord
+    {
+        int32_t id;
+        const char *data;
+        uint32_t size;
+    };
+
+    // Records untouched in this session are copied from the mapped file,
+    // broken ones are dropped
+    std::vector<SavedRecord> records;
+    records.reserve(cache.m_indexSize + cache.m_updatedRecords.size());
+    for (uint32_t i = 0; i < cache.m_indexSize; ++i) {
+        const IndexEntry *entry = cache.m_index + i;
+        if (cache.m_updatedRecords.count(entry->id))
+            continue;
+        uint32_t size = 0;
+        const char *data = cache.mappedRecord(entry, &size);
+        if (data)
+            records.push_back({entry->id, data, size});
+    }
+    for (auto it = cache.m_updatedRecords.begin(); it != cache.m_updatedRecords.end(); ++it) {
+        const Record& record = (*it).second;
+        if (record.offset != UINT32_MAX)
+            records.push_back({(*it).first, cache.m_records.data() + record.offset, record.size});
+    }
+    std::sort(records.begin(), records.end(), [](const SavedRecord& left, const SavedRecord& right){
+        return left.id < right.id;
+    });
+
+    // Records follow the index in the same order, so a record ends
+    // where the next one begins
+    size_t offset = sizeof(FileHeader) + records.size() * sizeof(IndexEntry);
+    std::vector<char> file;
+    file.reserve(offset + cache.m_records.size());
+
+    FileHeader header;
+    std::copy(std::begin(cacheMagic), std::end(cacheMagic), header.magic);
+    header.version = cacheVersion;
+    header.serverHash = cache.m_serverHash;
+    header.count = records.size();
+    writeValue(&file, header);
+    for (const SavedRecord& record : records) {
+        writeValue(&file, IndexEntry{record.id, (uint32_t)offset});
+        offset += record.size;
+    }
+    for (const SavedRecord& record : records) {
+        file.insert(file.end(), record.data, record.data + record.size);
+    }
+
+    // File is written to a temporary one and renamed, so the mapping stays valid
+    GError *error = nullptr;
+    if (!g_file_set_contents(cache.m_filePath.c_str(), file.data(), file.size(), &error)) {
+        NCXMMS2_LOG_ERROR("Can't save songs info cache: %s", error->message);
+        g_error_free(error);
+        return false;
+    }
+    cache.m_modified = false;
+    return true;
+}
+
+void SongInfoCache::close()
+{
+    SongInfoCache& cache = instance();
+    if (!cache.m_isOpen)
+        return;
+
+    save();
+    cache.unmap();
+    cache.m_updatedRecords.clear();
+    std::vector<char>().swap(cache.m_records);
+    std::vector<char>().swap(cache.m_encodeBuffer);
+    cache.m_deadBytes = 0;
+    cache.m_modified = false;
+    cache.m_isOpen = false;
+}
+
+bool SongInfoCache::lookup(int id, Song *song)
+{
+    const SongInfoCache& cache = instance();
+    if (!cache.m_isOpen)
+        return false;
+
+    auto it = cache.m_updatedRecords.find(id);
+    if (it != cache.m_updatedRecords.end()) {
+        const Record& record = (*it).second;
+        return record.offset != UINT32_MAX
+               && decodeSong(id, cache.m_records.data() + record.offset, record.size, song);
+    }
+
+    uint32_t size = 0;
+    const char *data = cache.mappedRecord(cache.findIndexEntry(id), &size);
+    return data && decodeSong(id, data, size, song);
+}
+
+void SongInfoCache::store(const Song& song)
+{
+    SongInfoCache& cache = instance();
+    if (!cache.m_isOpen || song.id() <= 0)
+        return;
+
+    std::vector<char>& encoded = cache.m_encodeBuffer;
+    encoded.clear();
+    encodeSong(song, &encoded);
+
+    // Songs are mostly the same as the cached ones, those are left alone
+    auto equalsEncoded = [&encoded](const char *data, uint32_t size) {
+        return data && size == encoded.size() && std::memcmp(data, encoded.data(), size) == 0;
+    };
+
+    auto it = cache.m_updatedRecords.find(song.id());
+    if (it != cache.m_updatedRecords.end()) {
+        Record& record = (*it).second;
+        if (record.offset != UINT32_MAX) {
+            if (equalsEncoded(cache.m_records.data() + record.offset, record.size))
+                return;
+            cache.m_deadBytes += record.size;
+        }
+    } else {
+        uint32_t size = 0;
+        if (equalsEncoded(cache.mappedRecord(cache.findIndexEntry(song.id()), &size), size))
+            return;
+    }
+
+    const Record record = {(uint32_t)cache.m_records.size(), (uint32_t)encoded.size()};
+    cache.m_records.insert(cache.m_records.end(), encoded.begin(), encoded.end());
+    cache.m_updatedRecords[song.id()] = record;
+    cache.m_modified = true;
+    cache.compactRecords();
+}
+
+void SongInfoCache::invalidate(int id)
+{
+    SongInfoCache& cache = instance();
+    if (!cache.m_isOpen)
+        return;
+
+    auto it = cache.m_updatedRecords.find(id);
+    if (it != cache.m_updatedRecords.end()) {
+        Record& record = (*it).second;
+        if (record.offset != UINT32_MAX) {
+            cache.m_deadBytes += record.size;
+            record.offset = UINT32_MAX;
+            record.size = 0;
+            cache.m_modified = true;
+        }
+    } else if (cache.findIndexEntry(id)) {
+        cache.m_updatedRecords[id] = Record{UINT32_MAX, 0};
+        cache.m_modified = true;
+    }
+}
+
+void SongInfoCache::unmap()
+{
+    if (m_data)
+        munmap(const_cast<char*>(m_data), m_dataSize);
+    m_data = nullptr;
+    m_dataSize = 0;
+    m_index = nullptr;
+    m_indexSize = 0;
+}
+
+const SongInfoCache::IndexEntry *SongInfoCache::findIndexEntry(int id) const
+{
+    const IndexEntry *end = m_index + m_indexSize;
+    const IndexEntry *entry = std::lower_bound(m_index, end, id, [](const IndexEntry& entry, int id){
+        return entry.id < id;
+    });
+    return entry != end && entry->id == id ? entry : nullptr;
+}
+
+const char *SongInfoCache::mappedRecord(const IndexEntry *entry, uint32_t *size) const
+{
+    if (!entry)
+        return nullptr;
+
+    const IndexEntry *next = entry + 1;
+    const size_t recordsOffset = sizeof(FileHeader) + m_indexSize * sizeof(IndexEntry);
+    const size_t end = next != m_index + m_indexSize ? next->offset : m_dataSize;
+    if (entry->offset < recordsOffset || entry->offset > end || end > m_dataSize)
+        return nullptr;
+
+    *size = end - entry->offset;
+    return m_data + entry->offset;
+}
+
+void SongInfoCache::compactRecords()
+{
+    if (m_deadBytes < 1024 * 1024 || m_deadBytes < m_records.size() / 2)
+        return;
+
+    std::vector<char> records;
+    records.reserve(m_records.size() - m_deadBytes);
+    for (auto it = m_updatedRecords.begin(); it != m_updatedRecords.end(); ++it) {
+        Record& record = (*it).second;
+        if (record.offset == UINT32_MAX)
+            continue;
+        const char *data = m_records.data() + record.offset;
+        record.offset = records.size();
+        records.insert(records.end(), data, data + record.size);
+    }
+    m_records.swap(records);
+    m_deadBytes = 0;
+}
+
+bool SongInfoCache::decodeSong(int id, const char *data, uint32_t size, Song *song)
+{
+    const char *end = data + size;
+
+    Song result;
+    result.m_id = id;
+    if (!readValue(&data, end, &result.m_durartion)
+        || !readValue(&data, end, &result.m_timesPlayed)
+        || !readValue(&data, end, &result.m_bitrate)
+        || !readValue(&data, end, &result.m_samplerate)
+        || !readValue(&data, end, &result.m_trackNumber)) {
+        return false;
+    }
+
+    for (int i = 0; i < Song::StringsCount; ++i) {
+        uint32_t stringSize = 0;
+        if (!readValue(&data, end, &stringSize) || (size_t)(end - data) < stringSize)
+            return false;
+        result.setString(i, data, stringSize);
+        data += stringSize;
+    }
+
+    *song = std::move(result);
+    return true;
+}
+
+void SongInfoCache::encodeSong(const Song& song, std::vector<char> *buffer)
+{
+    writeValue(buffer, song.m_durartion);
+    writeValue(buffer, song.m_timesPlayed);
+    writeValue(buffer, song.m_bitrate);
+    writeValue(buffer, song.m_samplerate);
+    writeValue(buffer, song.m_trackNumber);
+    for (int i = 0; i < Song::StringsCount; ++i) {
+        const std::string& str = song.string(i);
+        writeValue(buffer, (uint32_t)str.size());
+        buffer->insert(buffer->end(), str.begin(), str.end());
+    }
+}
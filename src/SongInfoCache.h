@@ -0,0 +1,113 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifndef SONGINFOCACHE_H
+#define SONGINFOCACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Song.h"
+#include "lib/FlatHashMap.h"
+
+namespace ncxmms2 {
+
+/*   SongInfoCache keeps songs info between sessions, so that playlists can be
+ * painted right after startup, while actual info is requested from the server
+ * in the background. Cache file is memory mapped and consists of a header,
+ * an index of (id, offset) pairs sorted by id and song records, so only looked
+ * up songs are decoded. Songs stored during the session are kept encoded in one
+ * buffer, only the ones differing from the file, and merged into the file on save.
+ *   Cache is bound to the server it was filled from, the file is ignored when
+ * opened for another one. It is disabled until opened.
+ */
+class SongInfoCache
+{
+public:
+    static bool open(const std::string& filePath, const std::string& serverId);
+    static bool isOpen();
+    static bool save();
+    static void close();
+
+    // Returns true and fills song when info of the given id is cached
+    static bool lookup(int id, Song *song);
+    static void store(const Song& song);
+    static void invalidate(int id);
+
+private:
+    SongInfoCache();
+    SongInfoCache(const SongInfoCache&);
+    SongInfoCache& operator=(const SongInfoCache&);
+    ~SongInfoCache();
+
+    static SongInfoCache& instance()
+    {
+        static SongInfoCache inst;
+        return inst;
+    }
+
+    struct IndexEntry
+    {
+        int32_t id;
+        uint32_t offset;
+    };
+
+    struct Record
+    {
+        uint32_t offset; // UINT32_MAX for invalidated entries
+        uint32_t size;
+    };
+
+    bool m_isOpen;
+    bool m_modified;
+    std::string m_filePath;
+    uint32_t m_serverHash;
+
+    const char *m_data;
+    size_t m_dataSize;
+    const IndexEntry *m_index;
+    uint32_t m_indexSize;
+
+    // Records of songs stored during the session, replaced records are
+    // left in the buffer until their size makes it worth compacting
+    FlatHashMap<int, Record> m_updatedRecords;
+    std::vector<char> m_records;
+    size_t m_deadBytes;
+    std::vector<char> m_encodeBuffer;
+
+    void unmap();
+    const IndexEntry *findIndexEntry(int id) const;
+    const char *mappedRecord(const IndexEntry *entry, uint32_t *size) const;
+    void compactRecords();
+    static bool decodeSong(int id, const char *data, uint32_t size, Song *song);
+    static void encodeSong(const Song& song, std::vector<char> *buffer);
+};
+
+// Closes the cache when it goes out of scope, so that the session's songs
+// are saved on any exit path and before static objects are destroyed
+class SongInfoCacheCloser
+{
+public:
+    SongInfoCacheCloser() {}
+    ~SongInfoCacheCloser() {SongInfoCache::close();}
+
+private:
+    SongInfoCacheCloser(const SongInfoCacheCloser&);
+    SongInfoCacheCloser& operator=(const SongInfoCacheCloser&);
+};
+} // ncxmms2
+
+#endif // SONGINFOCACHE_H
@@ -35,10 +35,12 @@ QuestionWindow::QuestionWindow(int xPos, int yPos, int cols, Window *parent) :
 
 void QuestionWindow::askQuestion(const std::string& question,
                                  const LineEdit::ResultCallback& answerCallback,
-                                 const std::string& initialAnswer)
+                                 const std::string& initialAnswer,
+                                 const LineEdit::TextChangedCallback& answerChangedCallback)
 {
     m_htmlParser.parse(question);
     m_answerEdit->edit(answerCallback, initialAnswer);
+    m_answerEdit->setTextChangedCallback(answerChangedCallback);
     adjustSize();
 }
 
@@ -33,7 +33,8 @@ public:
 
     void askQuestion(const std::string& question,
                      const LineEdit::ResultCallback& answerCallback,
-                     const std::string& initialAnswer=std::string());
+                     const std::string& initialAnswer=std::string(),
+                     const LineEdit::TextChangedCallback& answerChangedCallback=nullptr);
 
 protected:
     virtual void resizeChildren(const Size &size);
@@ -99,6 +99,19 @@ void StatusArea::showMessage(const std::string& message)
     }
 }
 
+void StatusArea::showActivePlaylistAddErrors(int failedCount, int count, const char *description,
+                                             const std::vector<xmms2::RequestGroup::ItemError>& errors)
+{
+    if (errors.empty())
+        return;
+
+    showMessage("Failed to add %d of %d %s to active playlist: %s",
+                failedCount, count, description, errors.front().error);
+    for (const auto& error : errors) {
+        NCXMMS2_LOG_ERROR("%s", error.error);
+    }
+}
+
 void StatusArea::_showMessage(const std::string& message)
 {
     static_cast<Label*>(m_stackedWindow->window(StackedMessageWindow))->setText(message);
@@ -108,10 +121,11 @@ void StatusArea::_showMessage(const std::string& message)
 
 void StatusArea::askQuestion(const std::string& question,
                              const LineEdit::ResultCallback& answerCallback,
-                             const std::string& initialAnswer)
+                             const std::string& initialAnswer,
+                             const LineEdit::TextChangedCallback& answerChangedCallback)
 {
     if (inst) {
-        inst->_askQuestion(question, answerCallback, initialAnswer);
+        inst->_askQuestion(question, answerCallback, initialAnswer, answerChangedCallback);
     } else {
         throw std::runtime_error(std::string(__PRETTY_FUNCTION__).append(" : there is no instance of StatusArea!"));
     }
@@ -119,7 +133,8 @@ void StatusArea::askQuestion(const std::string& question,
 
 void StatusArea::_askQuestion(const std::string& question,
                               const LineEdit::ResultCallback& answerCallback,
-                              const std::string& initialAnswer)
+                              const std::string& initialAnswer,
+                              const LineEdit::TextChangedCallback& answerChangedCallback)
 {
     auto resultCallback = [answerCallback, this](const std::string& answer, LineEdit::Result result)
     {
@@ -129,7 +144,7 @@ void StatusArea::_askQuestion(const std::string& question,
     };
 
     QuestionWindow *questionWin = static_cast<QuestionWindow*>(m_stackedWindow->window(StackedQuestionWindow));
-    questionWin->askQuestion(question, resultCallback, initialAnswer);
+    questionWin->askQuestion(question, resultCallback, initialAnswer, answerChangedCallback);
     m_stackedWindow->setCurrentIndex(StackedQuestionWindow);
     m_timer.stop();
 }
@@ -47,9 +47,16 @@ public:
         showMessage(Utils::format(fmt, std::forward<Arg>(arg), std::forward<Args>(args)...));
     }
 
+    // Shows how many of the items failed to be added to the active playlist
+    // with the first error, all errors are logged. Nothing is shown if there are no errors
+    static void showActivePlaylistAddErrors(int failedCount, int count, const char *description,
+                                            const std::vector<xmms2::RequestGroup::ItemError>& errors);
+
+    // Answer changed callback is called on every change of the answer while it is typed
     static void askQuestion(const std::string& question,
                             const LineEdit::ResultCallback& answerCallback,
-                            const std::string& initialAnswer = std::string());
+                            const std::string& initialAnswer = std::string(),
+                            const LineEdit::TextChangedCallback& answerChangedCallback = nullptr);
 
     xmms2::PlaybackStatus playbackStatus() const;
 
@@ -82,7 +89,8 @@ private:
     void _showMessage(const std::string& message);
     void _askQuestion(const std::string& question,
                       const LineEdit::ResultCallback& answerCallback,
-                      const std::string& initialAnswer = std::string());
+                      const std::string& initialAnswer,
+                      const LineEdit::TextChangedCallback& answerChangedCallback);
     
     void getPlaytime(const xmms2::Expected<int>& playtime);
 };
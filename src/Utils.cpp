@@ -14,6 +14,8 @@
  *  GNU General Public License for more details.
  */
 
+#include <glib.h>
+
 #include "Utils.h"
 #include "lib/StringRef.h"
 #include "lib/StringAlgo.h"
@@ -56,3 +58,13 @@ Utils::FileType Utils::getFileType(const std::string& path)
 
      return Utils::FileType::Unknown;
 }
+
+int Utils::compareMedialibStrings(const std::string& str1, const std::string& str2)
+{
+    gchar *folded1 = g_utf8_casefold(str1.c_str(), str1.size());
+    gchar *folded2 = g_utf8_casefold(str2.c_str(), str2.size());
+    const int result = g_utf8_collate(folded1, folded2);
+    g_free(folded1);
+    g_free(folded2);
+    return result;
+}
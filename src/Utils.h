@@ -36,6 +36,10 @@ enum class FileType
 
 FileType getFileType(const std::string& path);
 
+// Compares strings the way medialib sorts them in query results:
+// case insensitive, according to the current locale collation rules
+int compareMedialibStrings(const std::string& str1, const std::string& str2);
+
 template <typename... Args>
 std::string format(const char *fmt, Args&&... args)
 {
@@ -50,7 +50,7 @@ public:
     template <typename T>
     void connectBroadcastOrSignal(xmmsc_result_t *result, Signals::Signal<T>& signal)
     {
-        auto *callback = new XmmsValueFunctionWrapper<T>(std::ref(signal));
+        auto *callback = new XmmsValueFunctionWrapper<T>(std::ref(signal), detail::RequestToken());
         xmmsc_result_notifier_set_full(result, callback->get(), callback,
                                        XmmsValueFunctionWrapper<T>::free);
         xmmsc_result_unref(result);
@@ -256,6 +256,7 @@ bool xmms2::Client::connect(const std::string& patch)
     d->connectBroadcastOrSignal(xmmsc_broadcast_playback_current_id(d->m_connection), playbackCurrentIdChanged);
     d->connectBroadcastOrSignal(xmmsc_broadcast_medialib_entry_changed(d->m_connection), medialibEntryChanged);
     d->connectBroadcastOrSignal(xmmsc_broadcast_medialib_entry_added(d->m_connection), medialibEntryAdded);
+    d->connectBroadcastOrSignal(xmmsc_broadcast_medialib_entry_removed(d->m_connection), medialibEntryRemoved);
     d->connectBroadcastOrSignal(xmmsc_broadcast_playlist_loaded(d->m_connection), playlistLoaded);
     d->connectBroadcastOrSignal(xmmsc_broadcast_playlist_current_pos(d->m_connection), playlistCurrentPositionChanged);
     d->connectBroadcastOrSignal(xmmsc_broadcast_playlist_changed(d->m_connection), playlistChanged);
@@ -413,12 +414,22 @@ xmms2::VoidResult xmms2::Client::playlistAddIdList(const std::string& playlist,
     return {d->m_connection, xmmsc_playlist_add_idlist(d->m_connection, playlist.c_str(), idList.m_coll)};
 }
 
-void xmms2::Client::playlistAddPlaylistFile(const std::string& playlist, const std::string& file)
+void xmms2::Client::playlistAddPlaylistFile(const std::string& playlist, const std::string& file,
+                                            RequestGroup *group)
 {
     CLIENT_CHECK_CONNECTION;
-    collectionGetIdListFromPlaylistFile(file)([playlist, this](const Expected<Collection>& idlist){
+    if (!group) {
+        collectionGetIdListFromPlaylistFile(file)([playlist, this](const Expected<Collection>& idlist){
+            if (idlist.isValid())
+                playlistAddIdList(playlist, idlist.value());
+        });
+        return;
+    }
+    
+    RequestGroup groupRef = *group;
+    group->add(collectionGetIdListFromPlaylistFile(file), [playlist, groupRef, this](const Expected<Collection>& idlist) mutable {
         if (idlist.isValid())
-            playlistAddIdList(playlist, idlist.value());
+            groupRef.add(playlistAddIdList(playlist, idlist.value()));
     });
 }
 
@@ -75,7 +75,8 @@ public:
     VoidResult playlistAddCollection(const std::string& playlist, const Collection& coll,
                                      const std::vector<std::string>& order);
     VoidResult playlistAddIdList(const std::string& playlist, const Collection& idList);
-    void playlistAddPlaylistFile(const std::string& playlist, const std::string& file);
+    void playlistAddPlaylistFile(const std::string& playlist, const std::string& file,
+                                 RequestGroup *group = nullptr);
     
     VoidResult playlistRemoveEntry(const std::string& playlist, int entry);
     VoidResult playlistMoveEntry(const std::string& playlist, int from, int to);
@@ -105,6 +106,7 @@ public:
     
     NCXMMS2_SIGNAL(medialibEntryChanged, const Expected<int>&)
     NCXMMS2_SIGNAL(medialibEntryAdded, const Expected<int>&)
+    NCXMMS2_SIGNAL(medialibEntryRemoved, const Expected<int>&)
         
     /* **************************************
        ********* Collection subsystem *******
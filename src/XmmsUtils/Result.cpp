@@ -15,12 +15,18 @@
  */
 
 #include <string>
+#include <algorithm>
+#include <assert.h>
 
 #include "Result.h"
 #include "../Log.h"
 
 using namespace ncxmms2;
 
+namespace {
+unsigned totalDiscardedRepliesCount = 0;
+}
+
 std::ostream& xmms2::operator<<(std::ostream& os, const xmms2::Error& error)
 {
     os << error.toString();
@@ -46,6 +52,105 @@ void xmms2::ResultBase::setResultCallback(int (*callback)(xmmsv_t *, void *), vo
     xmmsc_result_notifier_set_full(m_result, callback, userData, freeCallback);
 }
 
+unsigned xmms2::RequestKey::totalDiscardedReplies()
+{
+    return totalDiscardedRepliesCount;
+}
+
+bool xmms2::detail::RequestToken::acceptReply() const
+{
+    if (!m_state || m_state->generation == m_generation)
+        return true;
+
+    ++m_state->discardedReplies;
+    ++totalDiscardedRepliesCount;
+    NCXMMS2_DEBUG("Superseded reply discarded, %u replies discarded in total\n", totalDiscardedRepliesCount);
+    return false;
+}
+
+struct xmms2::RequestGroup::State
+{
+    State() : count(0), pending(0), finished(false) {}
+    
+    int count;
+    int pending;
+    bool finished;
+    std::vector<ItemError> errors;
+    CompletionFunction completion;
+};
+
+namespace {
+struct GroupRequest
+{
+    xmms2::RequestGroup group;
+    int index;
+};
+}
+
+xmms2::RequestGroup::RequestGroup() :
+    m_state(std::make_shared<State>())
+{
+    
+}
+
+int xmms2::RequestGroup::size() const
+{
+    return m_state->count;
+}
+
+void xmms2::RequestGroup::finish(const CompletionFunction& f)
+{
+    assert(!m_state->finished);
+    m_state->finished = true;
+    m_state->completion = f;
+    if (m_state->pending == 0)
+        completeRequest(-1, nullptr);
+}
+
+void xmms2::RequestGroup::addResult(ResultBase *result)
+{
+    auto *request = new GroupRequest{*this, beginRequest()};
+    result->setResultCallback(&RequestGroup::replyFunction, request, &RequestGroup::freeFunction);
+}
+
+int xmms2::RequestGroup::beginRequest()
+{
+    ++m_state->pending;
+    return m_state->count++;
+}
+
+void xmms2::RequestGroup::completeRequest(int index, const char *error) const
+{
+    if (index >= 0) {
+        if (error)
+            m_state->errors.push_back(ItemError{index, error});
+        --m_state->pending;
+    }
+    
+    if (m_state->pending == 0 && m_state->finished && m_state->completion) {
+        // Callback may release the last reference to the state
+        std::shared_ptr<State> state = m_state;
+        CompletionFunction completion;
+        completion.swap(state->completion);
+        std::sort(state->errors.begin(), state->errors.end(), [](const ItemError& left, const ItemError& right){
+            return left.index < right.index;
+        });
+        completion(state->count, state->errors);
+    }
+}
+
+int xmms2::RequestGroup::replyFunction(xmmsv_t *value, void *data)
+{
+    const GroupRequest *request = static_cast<GroupRequest*>(data);
+    request->group.completeRequest(request->index, detail::getErrorString(value).c_str());
+    return 1;
+}
+
+void xmms2::RequestGroup::freeFunction(void *data)
+{
+    delete static_cast<GroupRequest*>(data);
+}
+
 StringRef xmms2::detail::getErrorString(xmmsv_t *value)
 {
     const char *error = nullptr;
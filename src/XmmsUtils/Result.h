@@ -18,6 +18,7 @@
 #define RESULT_H
 
 #include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <type_traits>
@@ -33,6 +34,8 @@ typedef struct xmmsv_St xmmsv_t;
 namespace ncxmms2 {
 namespace xmms2 {
 
+class RequestGroup;
+
 class Error
 {
 public:
@@ -170,6 +173,69 @@ inline Expected<T> expectedFromError(Str&& error)
     return Expected<T>(Error(std::forward<Str>(error)));
 }
 
+namespace detail {
+struct RequestKeyState
+{
+    RequestKeyState() : generation(0), discardedReplies(0) {}
+    unsigned generation;
+    unsigned discardedReplies;
+};
+
+// Request issued with a RequestKey, reply is accepted if no newer
+// request was issued with the same key since then
+class RequestToken
+{
+public:
+    RequestToken() : m_generation(0) {}
+    explicit RequestToken(const std::shared_ptr<RequestKeyState>& state) :
+        m_state(state),
+        m_generation(state->generation) {}
+
+    // Returns false and counts the reply as discarded for superseded request
+    bool acceptReply() const;
+
+private:
+    std::shared_ptr<RequestKeyState> m_state;
+    unsigned m_generation;
+};
+} // detail
+
+/*   RequestKey identifies requests where only the latest one matters, e.g. songs
+ * of the currently selected album. A request issued with the key supersedes
+ * previous ones: their replies are dropped before they are decoded and callbacks
+ * are not called. Destroying the key cancels its pending requests, so the
+ * callbacks of an object holding the key are never called after its destruction.
+ * Usage: client->collectionQueryInfos(...).supersede(m_requestKey)(callback);
+ */
+class RequestKey
+{
+public:
+    RequestKey() : m_state(std::make_shared<detail::RequestKeyState>()) {}
+    ~RequestKey() {cancel();}
+
+    RequestKey(const RequestKey&) = delete;
+    RequestKey& operator=(const RequestKey&) = delete;
+
+    // Cancels all pending requests issued with the key
+    void cancel() {++m_state->generation;}
+
+    // Number of replies dropped for this key and for all keys
+    unsigned discardedReplies() const {return m_state->discardedReplies;}
+    static unsigned totalDiscardedReplies();
+
+private:
+    template <typename T>
+    friend class Result;
+
+    detail::RequestToken issueRequest()
+    {
+        cancel();
+        return detail::RequestToken(m_state);
+    }
+
+    std::shared_ptr<detail::RequestKeyState> m_state;
+};
+
 namespace detail {
 StringRef getErrorString(xmmsv_t *value);
 
@@ -199,8 +265,9 @@ public:
     typedef int (*PlainFunctionType)(xmmsv_t*, void*);
 
     template <typename F>
-    XmmsValueFunctionWrapper(F&& f) :
-        m_function(std::forward<F>(f)) {}
+    XmmsValueFunctionWrapper(F&& f, const detail::RequestToken& token) :
+        m_function(std::forward<F>(f)),
+        m_token(token) {}
 
     PlainFunctionType get() const {return &plainFunction;}
 
@@ -211,11 +278,13 @@ public:
     
 private:
     FunctionType m_function;
+    detail::RequestToken m_token;
 
     static int plainFunction(xmmsv_t *value, void *data)
     {
         auto *wrapper = static_cast<XmmsValueFunctionWrapper*>(data);
-        detail::decodeValue(value, wrapper->m_function);
+        if (wrapper->m_token.acceptReply())
+            detail::decodeValue(value, wrapper->m_function);
         return 1;
     }
 };
@@ -228,8 +297,9 @@ public:
     typedef int (*PlainFunctionType)(xmmsv_t*, void*);
 
     template <typename F>
-    XmmsValueFunctionWrapper(F&& f) :
-        m_function(std::forward<F>(f)) {}
+    XmmsValueFunctionWrapper(F&& f, const detail::RequestToken& token) :
+        m_function(std::forward<F>(f)),
+        m_token(token) {}
 
     PlainFunctionType get() const {return &plainFunction;}
 
@@ -240,10 +310,13 @@ public:
     
 private:
     FunctionType m_function;
+    detail::RequestToken m_token;
 
     static int plainFunction(xmmsv_t *value, void *data)
     {
         auto *wrapper = static_cast<XmmsValueFunctionWrapper*>(data);
+        if (!wrapper->m_token.acceptReply())
+            return 1;
         const StringRef error = detail::getErrorString(value);
         if (!error.isNull()) {
             wrapper->m_function(Error(error.c_str()));
@@ -264,6 +337,8 @@ public:
     ResultBase& operator=(const ResultBase&) = delete;
     
 protected:
+    friend class RequestGroup;
+    
     ResultBase(xmmsc_connection_t *connection, xmmsc_result_t *result);
     ~ResultBase();
     
@@ -278,10 +353,17 @@ public:
     Result(xmmsc_connection_t *connection, xmmsc_result_t *result) :
         ResultBase(connection, result) {}
     
+    // Supersedes previous requests issued with the key, see RequestKey
+    Result& supersede(RequestKey& key)
+    {
+        m_token = key.issueRequest();
+        return *this;
+    }
+    
     template <typename F>
     void operator()(F&& f)
     {
-        auto *callback = new XmmsValueFunctionWrapper<T>(std::forward<F>(f));
+        auto *callback = new XmmsValueFunctionWrapper<T>(std::forward<F>(f), m_token);
         setResultCallback(callback->get(), callback, XmmsValueFunctionWrapper<T>::free);
     }
     
@@ -300,6 +382,10 @@ public:
         // that at the moment of callback call the object will be alive
         operator()(std::bind(func, obj, std::forward<Arg0>(arg0), std::forward<Args>(args)...));
     }
+    
+private:
+    friend class RequestGroup;
+    detail::RequestToken m_token;
 };
 
 template <>
@@ -308,6 +394,9 @@ class Result<void> : private ResultBase
 public:
     Result(xmmsc_connection_t *connection, xmmsc_result_t *result) :
         ResultBase(connection, result) {}
+    
+private:
+    friend class RequestGroup;
 };
 
 typedef Result<void>                             VoidResult;
@@ -321,6 +410,71 @@ typedef Result<const Expected<List<StringRef>>&> StringListResult;
 typedef Result<const Expected<List<Dict>>&>      DictListResult;
 typedef Result<const Expected<Collection>&>      CollectionResult;
 
+/*   RequestGroup tracks many requests at once and calls one completion callback
+ * when all of them are replied, instead of a callback and a status message per
+ * request. Requests are written to the socket back to back in the order they
+ * are issued, replies are not waited for between them.
+ *   Group is a handle to a shared state, copies of it refer to the same group,
+ * so it can be captured by callbacks which add more requests to it.
+ *   Usage:
+ *     RequestGroup group;
+ *     for (int id : ids)
+ *         group.add(client->playlistAddId(playlist, id));
+ *     group.finish([](int count, const std::vector<RequestGroup::ItemError>& errors){...});
+ */
+class RequestGroup
+{
+public:
+    struct ItemError
+    {
+        int index; // Index of the request in the order of adding
+        std::string error;
+    };
+    typedef std::function<void (int, const std::vector<ItemError>&)> CompletionFunction;
+    
+    RequestGroup();
+    
+    // Waits for the reply only, value is not decoded
+    template <typename T>
+    void add(Result<T>&& result)
+    {
+        ResultBase& resultBase = result;
+        addResult(&resultBase);
+    }
+    
+    // Calls f with the reply first, requests added to the group by f
+    // are waited for as well
+    template <typename T, typename F>
+    void add(Result<T>&& result, F&& f)
+    {
+        const int index = beginRequest();
+        const RequestGroup group = *this;
+        std::function<void (T)> function(std::forward<F>(f));
+        result([group, index, function](T value){
+            function(value);
+            group.completeRequest(index, value.isError() ? value.error().toString().c_str() : nullptr);
+        });
+    }
+    
+    // Number of requests added so far
+    int size() const;
+    
+    // No more requests are added except by callbacks of added ones,
+    // f is called once all requests are replied
+    void finish(const CompletionFunction& f);
+    
+private:
+    struct State;
+    std::shared_ptr<State> m_state;
+    
+    void addResult(ResultBase *result);
+    int beginRequest();
+    void completeRequest(int index, const char *error) const;
+    
+    static int replyFunction(xmmsv_t *value, void *data);
+    static void freeFunction(void *data);
+};
+
 } // xmms2
 } // ncxmms2
 
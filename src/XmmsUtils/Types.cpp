@@ -153,6 +153,37 @@ bool xmms2::ListIteratorBase::getValue(xmms2::Dict *val) const
     return false;
 }
 
+/* **************************************
+   ********** DictListDecoder ***********
+   ************************************** */
+bool xmms2::detail::DictListReader::fetchRow()
+{
+    xmmsv_t *listEntry;
+    if (xmmsv_list_iter_entry(m_it, &listEntry) && xmmsv_get_type(listEntry) == XMMSV_TYPE_DICT) {
+        m_dict = listEntry;
+        return true;
+    }
+    m_dict = nullptr;
+    return false;
+}
+
+bool xmms2::detail::DictListReader::getValue(const char *key, int *value) const
+{
+    xmmsv_t *dictEntry;
+    return m_dict && xmmsv_dict_get(m_dict, key, &dictEntry) && xmmsv_get_int(dictEntry, value);
+}
+
+bool xmms2::detail::DictListReader::getValue(const char *key, StringRef *value) const
+{
+    xmmsv_t *dictEntry;
+    const char *str;
+    if (m_dict && xmmsv_dict_get(m_dict, key, &dictEntry) && xmmsv_get_string(dictEntry, &str)) {
+        value->assign(str);
+        return true;
+    }
+    return false;
+}
+
 /* **************************************
    ******** PlaylistChangeEvent *********
    ************************************** */
@@ -336,6 +367,12 @@ int xmms2::Collection::at(int index) const
     return value;
 }
 
+void xmms2::Collection::append(int id)
+{
+    assert(m_type == Type::Idlist);
+    xmmsv_coll_idlist_append(m_coll, id);
+}
+
 xmms2::Collection xmms2::Collection::universe()
 {
     return Collection(xmmsc_coll_universe());
@@ -346,20 +383,54 @@ xmms2::Collection xmms2::Collection::universe()
    ************************************** */
 std::string xmms2::decodeUrl(const char *url)
 {
-    xmmsv_t *encoded, *decoded;
-    const unsigned char *decodedUrl;
-    unsigned int len;
     std::string decodedStr;
+    decodeUrl(url, &decodedStr);
+    return decodedStr;
+}
+
+bool xmms2::decodeUrl(const char *url, std::string *decoded)
+{
+    // Same decoding as xmmsv_decode_url does, but without creating
+    // two xmmsv values for every url
+    auto hexDigit = [](char c) -> int {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    };
     
-    encoded = xmmsv_new_string(url);
-    decoded = xmmsv_decode_url(encoded);
-    if (xmmsv_get_bin(decoded, &decodedUrl, &len)) {
-        decodedStr.assign(reinterpret_cast<const char*>(decodedUrl), len);
-    }    
-    xmmsv_unref(encoded);
-    xmmsv_unref(decoded);
+    decoded->clear();
+    for (const char *it = url; *it; ++it) {
+        if (*it == '+') {
+            decoded->push_back(' ');
+        } else if (*it == '%') {
+            const int high = hexDigit(it[1]);
+            const int low = high >= 0 ? hexDigit(it[2]) : -1;
+            if (low < 0) {
+                decoded->clear();
+                return false;
+            }
+            decoded->push_back((char)(high * 16 + low));
+            it += 2;
+        } else {
+            decoded->push_back(*it);
+        }
+    }
+    return true;
+}
+
+PooledString xmms2::getPooledFileNameFromUrl(const char *url, std::string *buffer)
+{
+    if (!decodeUrl(url, buffer))
+        return PooledString();
     
-    return decodedStr;
+    const std::string::size_type slashPos = buffer->rfind('/');
+    if (slashPos == std::string::npos || slashPos + 1 >= buffer->size())
+        return PooledString();
+    return PooledString(buffer->data() + slashPos + 1, buffer->size() - slashPos - 1);
 }
 
 std::string xmms2::getFileNameFromUrl(const std::string& url)
@@ -20,10 +20,12 @@
 #include <xmmsclient/xmmsclient.h>
 
 #include <string>
+#include <vector>
 #include <functional>
 #include <assert.h>
 
 #include "../lib/StringRef.h"
+#include "../lib/StringPool.h"
 
 namespace ncxmms2 {
 namespace xmms2 {
@@ -162,6 +164,9 @@ public:
     }
 };
 
+template <typename Row>
+class DictListDecoder;
+
 class ListBase
 {
 public:
@@ -190,6 +195,9 @@ public:
     
 protected:
      xmmsv_t *m_list;
+     
+     template <typename Row>
+     friend class DictListDecoder;
 };
 
 template <typename T>
@@ -201,6 +209,132 @@ public:
     ListIterator<T> getIterator() const {return ListIterator<T>(m_list);}
 };
 
+/* **************************************
+   ********** DictListDecoder ***********
+   ************************************** */
+namespace detail {
+// Iterates over a list of dicts without wrapping every entry into Dict
+class DictListReader : public ListIteratorBase
+{
+public:
+    explicit DictListReader(xmmsv_t *list) : ListIteratorBase(list), m_dict(nullptr) {}
+    
+    // Makes the current entry a row to read, returns false if it is not a dict
+    bool fetchRow();
+    
+    bool getValue(const char *key, int *value) const;
+    bool getValue(const char *key, StringRef *value) const;
+    
+private:
+    xmmsv_t *m_dict;
+};
+} // detail
+
+/*   DictListDecoder decodes dicts of a list straight into fields of a caller's
+ * row struct. Every key is looked up once per row. Strings are either referenced
+ * in place (StringRef fields, valid while the list exists) or interned into
+ * StringPool (PooledString fields), so decoding a long list doesn't allocate
+ * a string for every row.
+ *   Usage:
+ *     DictListDecoder<Row> decoder;
+ *     decoder.field("id", &Row::id).field("title", &Row::title);
+ *     decoder.decode(list, [](Row& row){...});
+ */
+template <typename Row>
+class DictListDecoder
+{
+public:
+    DictListDecoder& field(const char *key, int Row::*member, int defaultValue = 0)
+    {
+        m_intFields.push_back(IntField{key, member, defaultValue});
+        return *this;
+    }
+    
+    DictListDecoder& field(const char *key, StringRef Row::*member)
+    {
+        m_stringFields.push_back(StringField{key, member});
+        return *this;
+    }
+    
+    DictListDecoder& field(const char *key, PooledString Row::*member)
+    {
+        m_pooledFields.push_back(PooledField{key, member, false});
+        return *this;
+    }
+    
+    // Value is an url, only its decoded file name is kept
+    DictListDecoder& fileNameField(const char *key, PooledString Row::*member)
+    {
+        m_pooledFields.push_back(PooledField{key, member, true});
+        return *this;
+    }
+    
+    // Calls f(Row&) for every dict of the list. Row object is reused, so f should
+    // move out the pooled strings it keeps. Missing values are set to defaults.
+    template <typename F>
+    void decode(const List<Dict>& list, F&& f)
+    {
+        Row row;
+        for (detail::DictListReader reader(list.m_list); reader.isValid(); reader.next()) {
+            if (!reader.fetchRow())
+                continue;
+            
+            for (const IntField& field : m_intFields) {
+                int value = field.defaultValue;
+                reader.getValue(field.key, &value);
+                row.*field.member = value;
+            }
+            
+            for (const StringField& field : m_stringFields) {
+                StringRef value;
+                reader.getValue(field.key, &value);
+                row.*field.member = value;
+            }
+            
+            for (const PooledField& field : m_pooledFields) {
+                StringRef value;
+                if (!reader.getValue(field.key, &value)) {
+                    row.*field.member = PooledString();
+                } else if (field.isFileName) {
+                    row.*field.member = decodeFileName(value);
+                } else {
+                    row.*field.member = PooledString(value.c_str());
+                }
+            }
+            
+            f(row);
+        }
+    }
+    
+private:
+    struct IntField
+    {
+        const char *key;
+        int Row::*member;
+        int defaultValue;
+    };
+    
+    struct StringField
+    {
+        const char *key;
+        StringRef Row::*member;
+    };
+    
+    struct PooledField
+    {
+        const char *key;
+        PooledString Row::*member;
+        bool isFileName;
+    };
+    
+    std::vector<IntField> m_intFields;
+    std::vector<StringField> m_stringFields;
+    std::vector<PooledField> m_pooledFields;
+    std::string m_urlBuffer;
+    
+    PooledString decodeFileName(StringRef url);
+};
+
 /* **************************************
    ******** PlaylistChangeEvent *********
    ************************************** */
@@ -352,6 +486,7 @@ public:
     // For Idlist type
     int size() const;
     int at(int index) const;
+    void append(int id);
     
     static Collection universe();
 
@@ -367,6 +502,20 @@ private:
 std::string decodeUrl(const char *url);
 std::string getFileNameFromUrl(const std::string& url); // url is decoded
 
+// Decodes url into buffer, which may be reused to avoid allocations.
+// Returns false and clears buffer if url is malformed.
+bool decodeUrl(const char *url, std::string *decoded);
+
+// Same as getFileNameFromUrl(decodeUrl(url)), but the file name is interned
+// and buffer is used for decoding
+PooledString getPooledFileNameFromUrl(const char *url, std::string *buffer);
+
+template <typename Row>
+PooledString DictListDecoder<Row>::decodeFileName(StringRef url)
+{
+    return getPooledFileNameFromUrl(url.c_str(), &m_urlBuffer);
+}
+
 } // xmms2
 } // ncxmms2
 
@@ -30,6 +30,7 @@
 
 #include "Application.h"
 #include "Window.h"
+#include "Window_p.h"
 #include "KeyEvent.h"
 #include "MouseEvent.h"
 #include "Palette.h"
@@ -52,6 +53,7 @@ public:
         termKey(nullptr),
         termKeyReadTimeoutId(0),
         stdinPollSource(0),
+        screenUpdateSource(0),
         mouseEnabled(false),
         mouseDoubleClickInterval(300),
         mouseDoubleClickTimeExpired(true),
@@ -72,7 +74,10 @@ public:
     int stdinPollSource;
     static gboolean stdinEvent(GIOChannel *iochan, GIOCondition cond, gpointer data);
     static gboolean readKeyAfterTimeout(gpointer data);
-    void sendKeyPressedEvent(const TermKeyKey& key);
+    void sendKeyPressedEvent(const TermKeyKey& key, int repeatCount = 1);
+
+    int screenUpdateSource;
+    static gboolean updateScreen(gpointer data);
 
     bool mouseEnabled;
     Timer mouseDoubleClickTimer;
@@ -397,6 +402,35 @@ void Application::setTerminalWindowTitle(const std::string& title)
     }
 }
 
+void Application::scheduleScreenUpdate()
+{
+    CHECK_INST;
+    ApplicationPrivate *p = inst->d.get();
+    
+    // Idle priority makes the update run after all pending events (key presses,
+    // server replies and so on) are dispatched, so windows damaged while
+    // handling them are painted once and get to the terminal with a single doupdate.
+    if (!p->screenUpdateSource) {
+        p->screenUpdateSource = g_idle_add_full(G_PRIORITY_HIGH_IDLE, ApplicationPrivate::updateScreen,
+                                                NULL, NULL);
+    }
+}
+
+gboolean ApplicationPrivate::updateScreen(gpointer data)
+{
+    NCXMMS2_UNUSED(data);
+    
+    ApplicationPrivate *p = Application::inst->d.get();
+    WindowPrivate::paintDamagedWindows();
+    p->screenUpdateSource = 0;
+    doupdate();
+
+    // Windows damaged while painting others go to the next frame
+    if (!WindowPrivate::damagedWindows.empty())
+        Application::scheduleScreenUpdate();
+    return FALSE;
+}
+
 gboolean ApplicationPrivate::stdinEvent(GIOChannel *iochan, GIOCondition cond, gpointer data)
 {
     NCXMMS2_UNUSED(iochan);
@@ -412,6 +446,19 @@ gboolean ApplicationPrivate::stdinEvent(GIOChannel *iochan, GIOCondition cond, g
 
     termkey_advisereadable(p->termKey);
 
+    // Runs of the same navigation key read at once (key repeat, slow remote
+    // terminal) are folded into one event, so a list moves and reports its
+    // current item once per run instead of once per key press
+    TermKeyKey repeatedKey;
+    int repeatCount = 0;
+    auto sendRepeatedKey = [p, &repeatedKey, &repeatCount]()
+    {
+        if (repeatCount) {
+            p->sendKeyPressedEvent(repeatedKey, repeatCount);
+            repeatCount = 0;
+        }
+    };
+
     TermKeyResult res;
     TermKeyKey key;
     while((res = termkey_getkey(p->termKey, &key)) == TERMKEY_RES_KEY) {
@@ -419,10 +466,21 @@ gboolean ApplicationPrivate::stdinEvent(GIOChannel *iochan, GIOCondition cond, g
             case TERMKEY_TYPE_UNICODE:
             case TERMKEY_TYPE_KEYSYM:
             case TERMKEY_TYPE_FUNCTION:
-                p->sendKeyPressedEvent(key);
+                if (repeatCount && termkey_keycmp(p->termKey, &key, &repeatedKey) == 0) {
+                    ++repeatCount;
+                    break;
+                }
+                sendRepeatedKey();
+                if (KeyEvent(key).isNavigationKey()) {
+                    repeatedKey = key;
+                    repeatCount = 1;
+                } else {
+                    p->sendKeyPressedEvent(key);
+                }
                 break;
 
             case TERMKEY_TYPE_MOUSE:
+                sendRepeatedKey();
                 p->sendMouseEvent(key);
                 break;
 
@@ -430,6 +488,7 @@ gboolean ApplicationPrivate::stdinEvent(GIOChannel *iochan, GIOCondition cond, g
                 break;
         }
     }
+    sendRepeatedKey();
 
     if(res == TERMKEY_RES_AGAIN)
         p->termKeyReadTimeoutId = g_timeout_add(termkey_get_waittime(p->termKey),
@@ -465,10 +524,21 @@ gboolean ApplicationPrivate::readKeyAfterTimeout(gpointer data)
     return FALSE;
 }
 
-void ApplicationPrivate::sendKeyPressedEvent(const TermKeyKey& key)
+void ApplicationPrivate::sendKeyPressedEvent(const TermKeyKey& key, int repeatCount)
 {
     Window *win = grabbedFocusWindow ? grabbedFocusWindow : mainWindow;
-    win->keyPressedEvent(KeyEvent(key));
+
+    Window *focusedWin = win;
+    while (focusedWin->focusedWindow())
+        focusedWin = focusedWin->focusedWindow();
+
+    if (repeatCount == 1 || focusedWin->handlesKeyRepeatCount()) {
+        win->keyPressedEvent(KeyEvent(key, repeatCount));
+    } else {
+        for (int i = 0; i < repeatCount; ++i) {
+            win->keyPressedEvent(KeyEvent(key));
+        }
+    }
 }
 
 void ApplicationPrivate::sendMouseEvent(const TermKeyKey& key)
@@ -581,6 +651,9 @@ Application::~Application()
 
     g_source_remove(d->stdinPollSource);
 
+    if (d->screenUpdateSource)
+        g_source_remove(d->screenUpdateSource);
+
     if (g_main_loop_is_running(d->mainLoop))
         g_main_loop_quit(d->mainLoop);
 
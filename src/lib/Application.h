@@ -64,6 +64,10 @@ private:
     static Application *inst;
     std::unique_ptr<ApplicationPrivate> d;
     friend class ApplicationPrivate;
+
+    static void scheduleScreenUpdate();
+    friend class Painter;
+    friend class Window;
 };
 } // ncxmms2
 
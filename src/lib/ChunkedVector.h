@@ -0,0 +1,604 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifndef CHUNKEDVECTOR_H
+#define CHUNKEDVECTOR_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <assert.h>
+
+namespace ncxmms2 {
+
+/*   ChunkedVector is a sequence container with positional access, like
+ * std::vector, but with cheap insertion and removal at any position.
+ * Elements are stored in chunks of at most ChunkSize elements, chunks are
+ * nodes of a treap ordered by position, where every node knows the number
+ * of elements in its subtree. Thus element access, insert and erase take
+ * O(log(n / ChunkSize) + ChunkSize) instead of O(n), while elements of one
+ * chunk are still contiguous in memory. Ranges are inserted and erased by
+ * splitting and joining the treap, so only the chunks at the range edges
+ * are touched.
+ *   Optionally every element has a weight given by Weight functor, nodes
+ * also keep the sum of weights of their subtrees, so sum of any range of
+ * elements takes O(log(n / ChunkSize) + ChunkSize) as well.
+ */
+struct NoWeight
+{
+    template <typename T>
+    int64_t operator()(const T&) const {return 0;}
+};
+
+template <typename T, size_t ChunkSize = 256, typename Weight = NoWeight>
+class ChunkedVector
+{
+public:
+    typedef T value_type;
+    typedef size_t size_type;
+
+    ChunkedVector() : m_root(nullptr), m_seed(0x9E3779B9u) {}
+    ~ChunkedVector() {destroy(m_root);}
+
+    ChunkedVector(const ChunkedVector&) = delete;
+    ChunkedVector& operator=(const ChunkedVector&) = delete;
+
+    ChunkedVector(ChunkedVector&& other) noexcept :
+        m_root(other.m_root),
+        m_seed(other.m_seed)
+    {
+        other.m_root = nullptr;
+    }
+
+    ChunkedVector& operator=(ChunkedVector&& other) noexcept
+    {
+        if (this != &other) {
+            destroy(m_root);
+            m_root = other.m_root;
+            m_seed = other.m_seed;
+            other.m_root = nullptr;
+        }
+        return *this;
+    }
+
+    size_type size() const {return count(m_root);}
+    bool empty() const     {return !m_root;}
+
+    void clear()
+    {
+        destroy(m_root);
+        m_root = nullptr;
+    }
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);
+
+    const T& operator[](size_type pos) const
+    {
+        assert(pos < size());
+        const Node *node = m_root;
+        for (;;) {
+            const size_type leftCount = count(node->left);
+            if (pos < leftCount) {
+                node = node->left;
+            } else if (pos - leftCount < node->chunk.size()) {
+                return node->chunk[pos - leftCount];
+            } else {
+                pos -= leftCount + node->chunk.size();
+                node = node->right;
+            }
+        }
+    }
+
+    void push_back(const T& value) {insert(size(), value);}
+
+    void insert(size_type pos, const T& value)
+    {
+        assert(pos <= size());
+        m_root = insertAt(m_root, pos, value);
+    }
+
+    template <typename InputIt>
+    void insert(size_type pos, InputIt first, InputIt last)
+    {
+        assert(pos <= size());
+        Node *inserted = build(first, last);
+        if (!inserted)
+            return;
+        Node *left, *right;
+        split(m_root, pos, &left, &right);
+        m_root = join(join(left, inserted), right);
+    }
+
+    void erase(size_type pos)
+    {
+        assert(pos < size());
+        size_type chunkBegin = pos;
+        size_type chunkSize = 0;
+        m_root = eraseAt(m_root, pos, &chunkBegin, &chunkSize);
+        if (chunkSize > 0 && chunkSize < ChunkSize / 4 && chunkSize < size())
+            joinChunk(chunkBegin, chunkSize);
+    }
+
+    void erase(size_type first, size_type last)
+    {
+        assert(first <= last && last <= size());
+        if (first == last)
+            return;
+        Node *left, *middle, *right;
+        split(m_root, last, &middle, &right);
+        split(middle, first, &left, &middle);
+        destroy(middle);
+        m_root = join(left, right);
+    }
+
+    // Moves element at position from, so that it takes position to
+    void move(size_type from, size_type to)
+    {
+        assert(from < size() && to < size());
+        if (from == to)
+            return;
+        const T value = (*this)[from];
+        erase(from);
+        insert(to, value);
+    }
+
+    // Sum of weights of all elements
+    int64_t sum() const {return sum(m_root);}
+
+    // Sum of weights of elements in [first, last) range
+    int64_t sum(size_type first, size_type last) const
+    {
+        assert(first <= last && last <= size());
+        return prefixSum(last) - prefixSum(first);
+    }
+
+    // Calls f for every element, f returns true if it has changed the element.
+    // Sums are recalculated only for chunks with changed elements and their
+    // ancestors. Returns true if any element has changed.
+    template <typename F>
+    bool modify(F f) {return modify(m_root, f);}
+
+    // Calls f for every element in [first, last) range, walks chunks
+    // in order instead of looking up each position
+    template <typename F>
+    void forEach(size_type first, size_type last, F f) const
+    {
+        assert(first <= last && last <= size());
+        forEach(m_root, first, last, f);
+    }
+
+    template <typename F>
+    void forEach(F f) const {forEach(m_root, 0, size(), f);}
+
+    std::vector<T> toVector() const
+    {
+        std::vector<T> result;
+        result.reserve(size());
+        forEach([&result](const T& value){result.push_back(value);});
+        return result;
+    }
+
+    // Number of chunks, takes O(n / ChunkSize)
+    size_type chunksCount() const {return chunksCount(m_root);}
+
+private:
+    struct Node
+    {
+        Node(uint32_t priority_) :
+            left(nullptr),
+            right(nullptr),
+            count(0),
+            chunkSum(0),
+            sum(0),
+            priority(priority_) {}
+
+        std::vector<T> chunk;
+        Node *left;
+        Node *right;
+        size_type count; // Number of elements in the subtree
+        int64_t chunkSum; // Sum of weights of the chunk elements
+        int64_t sum;      // Sum of weights of the subtree elements
+        uint32_t priority;
+    };
+
+    Node *m_root;
+    uint32_t m_seed;
+
+    static size_type count(const Node *node) {return node ? node->count : 0;}
+    static int64_t sum(const Node *node)     {return node ? node->sum : 0;}
+
+    static int64_t chunkSum(const std::vector<T>& chunk)
+    {
+        int64_t result = 0;
+        for (const T& value : chunk) {
+            result += Weight()(value);
+        }
+        return result;
+    }
+
+    static void updateNode(Node *node)
+    {
+        node->count = count(node->left) + node->chunk.size() + count(node->right);
+        node->sum = sum(node->left) + node->chunkSum + sum(node->right);
+    }
+
+    static void updateNodes(Node *node)
+    {
+        if (node) {
+            updateNodes(node->left);
+            updateNodes(node->right);
+            updateNode(node);
+        }
+    }
+
+    uint32_t nextPriority()
+    {
+        // xorshift32
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 17;
+        m_seed ^= m_seed << 5;
+        return m_seed;
+    }
+
+    Node *newNode()
+    {
+        Node *node = new Node(nextPriority());
+        node->chunk.reserve(ChunkSize);
+        return node;
+    }
+
+    static void destroy(Node *node)
+    {
+        if (node) {
+            destroy(node->left);
+            destroy(node->right);
+            delete node;
+        }
+    }
+
+    static size_type chunksCount(const Node *node)
+    {
+        return node ? chunksCount(node->left) + 1 + chunksCount(node->right) : 0;
+    }
+
+    template <typename InputIt>
+    Node *build(InputIt first, InputIt last);
+
+    // Inserts node as the first one of the subtree
+    static Node *insertFront(Node *root, Node *node)
+    {
+        if (!root || node->priority > root->priority) {
+            node->right = root;
+            updateNode(node);
+            return node;
+        }
+        root->left = insertFront(root->left, node);
+        updateNode(root);
+        return root;
+    }
+
+    // Joins two subtrees, all elements of left go before elements of right
+    static Node *merge(Node *left, Node *right)
+    {
+        if (!left)
+            return right;
+        if (!right)
+            return left;
+
+        if (left->priority > right->priority) {
+            left->right = merge(left->right, right);
+            updateNode(left);
+            return left;
+        }
+        right->left = merge(left, right->left);
+        updateNode(right);
+        return right;
+    }
+
+    Node *insertAt(Node *node, size_type pos, const T& value)
+    {
+        if (!node) {
+            node = newNode();
+            node->chunk.push_back(value);
+            node->chunkSum = Weight()(value);
+            updateNode(node);
+            return node;
+        }
+
+        const size_type leftCount = count(node->left);
+        if (pos < leftCount || (pos == leftCount && node->left)) {
+            node->left = insertAt(node->left, pos, value);
+        } else if (pos - leftCount <= node->chunk.size()) {
+            auto& chunk = node->chunk;
+            chunk.insert(chunk.begin() + (pos - leftCount), value);
+            node->chunkSum += Weight()(value);
+            if (chunk.size() > ChunkSize) {
+                // Split overflowed chunk in halves, second half goes to the new node
+                // which becomes in-order successor of the current one
+                Node *next = newNode();
+                next->chunk.assign(chunk.begin() + chunk.size() / 2, chunk.end());
+                chunk.erase(chunk.begin() + chunk.size() / 2, chunk.end());
+                next->chunkSum = chunkSum(next->chunk);
+                node->chunkSum -= next->chunkSum;
+                node->right = insertFront(node->right, next);
+            }
+        } else {
+            node->right = insertAt(node->right, pos - leftCount - node->chunk.size(), value);
+        }
+
+        updateNode(node);
+        return node;
+    }
+
+    // Position of the chunk the element was erased from is subtracted from
+    // chunkBegin, chunkSize gets the number of elements left in the chunk
+    Node *eraseAt(Node *node, size_type pos, size_type *chunkBegin, size_type *chunkSize)
+    {
+        const size_type leftCount = count(node->left);
+        if (pos < leftCount) {
+            node->left = eraseAt(node->left, pos, chunkBegin, chunkSize);
+        } else if (pos - leftCount < node->chunk.size()) {
+            auto& chunk = node->chunk;
+            node->chunkSum -= Weight()(chunk[pos - leftCount]);
+            chunk.erase(chunk.begin() + (pos - leftCount));
+            *chunkBegin -= pos - leftCount;
+            *chunkSize = chunk.size();
+            if (chunk.empty()) {
+                Node *result = merge(node->left, node->right);
+                delete node;
+                return result;
+            }
+        } else {
+            node->right = eraseAt(node->right, pos - leftCount - node->chunk.size(), chunkBegin, chunkSize);
+        }
+
+        updateNode(node);
+        return node;
+    }
+
+    // Splits subtree into its first pos elements and the rest, a chunk
+    // containing the boundary is cut in two
+    void split(Node *node, size_type pos, Node **left, Node **right)
+    {
+        if (!node) {
+            *left = nullptr;
+            *right = nullptr;
+            return;
+        }
+
+        const size_type leftCount = count(node->left);
+        if (pos <= leftCount) {
+            split(node->left, pos, left, &node->left);
+            updateNode(node);
+            *right = node;
+        } else if (pos - leftCount < node->chunk.size()) {
+            auto& chunk = node->chunk;
+            Node *tail = newNode();
+            tail->chunk.assign(chunk.begin() + (pos - leftCount), chunk.end());
+            chunk.erase(chunk.begin() + (pos - leftCount), chunk.end());
+            tail->chunkSum = chunkSum(tail->chunk);
+            node->chunkSum -= tail->chunkSum;
+            updateNode(tail);
+
+            Node *rightSubtree = node->right;
+            node->right = nullptr;
+            updateNode(node);
+            *left = node;
+            *right = merge(tail, rightSubtree);
+        } else {
+            split(node->right, pos - leftCount - node->chunk.size(), &node->right, right);
+            updateNode(node);
+            *left = node;
+        }
+    }
+
+    // Detaches the first/last node of the subtree
+    static Node *removeFirst(Node *node, Node **first)
+    {
+        if (!node->left) {
+            *first = node;
+            Node *result = node->right;
+            node->right = nullptr;
+            updateNode(node);
+            return result;
+        }
+        node->left = removeFirst(node->left, first);
+        updateNode(node);
+        return node;
+    }
+
+    static Node *removeLast(Node *node, Node **last)
+    {
+        if (!node->right) {
+            *last = node;
+            Node *result = node->left;
+            node->left = nullptr;
+            updateNode(node);
+            return result;
+        }
+        node->right = removeLast(node->right, last);
+        updateNode(node);
+        return node;
+    }
+
+    // Like merge, but chunks meeting at the boundary are joined if they fit
+    // into one chunk, or rebalanced if one of them is less than quarter full
+    static Node *join(Node *left, Node *right)
+    {
+        if (!left || !right)
+            return merge(left, right);
+
+        Node *last, *first;
+        left = removeLast(left, &last);
+        right = removeFirst(right, &first);
+
+        auto& lastChunk = last->chunk;
+        auto& firstChunk = first->chunk;
+        const size_type total = lastChunk.size() + firstChunk.size();
+        if (total <= ChunkSize) {
+            lastChunk.insert(lastChunk.end(), firstChunk.begin(), firstChunk.end());
+            last->chunkSum += first->chunkSum;
+            updateNode(last);
+            delete first;
+            return merge(merge(left, last), right);
+        }
+
+        if (std::min(lastChunk.size(), firstChunk.size()) < ChunkSize / 4) {
+            lastChunk.insert(lastChunk.end(), firstChunk.begin(), firstChunk.end());
+            firstChunk.assign(lastChunk.begin() + total / 2, lastChunk.end());
+            lastChunk.erase(lastChunk.begin() + total / 2, lastChunk.end());
+            first->chunkSum = chunkSum(firstChunk);
+            last->chunkSum = chunkSum(lastChunk);
+            updateNode(first);
+            updateNode(last);
+        }
+        return merge(merge(left, last), merge(first, right));
+    }
+
+    // Joins underfull chunk with one of its neighbours
+    void joinChunk(size_type chunkBegin, size_type chunkSize)
+    {
+        Node *left, *right;
+        split(m_root, chunkBegin > 0 ? chunkBegin : chunkSize, &left, &right);
+        m_root = join(left, right);
+    }
+
+    // Sum of weights of elements in [0, pos) range
+    int64_t prefixSum(size_type pos) const
+    {
+        int64_t result = 0;
+        const Node *node = m_root;
+        while (node && pos > 0) {
+            const size_type leftCount = count(node->left);
+            if (pos <= leftCount) {
+                node = node->left;
+            } else if (pos - leftCount <= node->chunk.size()) {
+                result += sum(node->left);
+                pos -= leftCount;
+                if (pos == node->chunk.size()) {
+                    result += node->chunkSum;
+                } else {
+                    for (size_type i = 0; i < pos; ++i) {
+                        result += Weight()(node->chunk[i]);
+                    }
+                }
+                break;
+            } else {
+                result += sum(node->left) + node->chunkSum;
+                pos -= leftCount + node->chunk.size();
+                node = node->right;
+            }
+        }
+        return result;
+    }
+
+    template <typename F>
+    static bool modify(Node *node, F& f)
+    {
+        if (!node)
+            return false;
+
+        bool changed = modify(node->left, f);
+        bool chunkChanged = false;
+        for (T& value : node->chunk) {
+            if (f(value))
+                chunkChanged = true;
+        }
+        if (chunkChanged)
+            node->chunkSum = chunkSum(node->chunk);
+        changed |= modify(node->right, f);
+        changed |= chunkChanged;
+
+        if (changed)
+            updateNode(node);
+        return changed;
+    }
+
+    template <typename F>
+    static void forEach(const Node *node, size_type first, size_type last, F& f)
+    {
+        if (!node || first >= last)
+            return;
+
+        const size_type leftCount = count(node->left);
+        if (first < leftCount)
+            forEach(node->left, first, std::min(last, leftCount), f);
+
+        const size_type chunkSize = node->chunk.size();
+        if (last > leftCount && first < leftCount + chunkSize) {
+            const size_type begin = first > leftCount ? first - leftCount : 0;
+            const size_type end = std::min(last - leftCount, chunkSize);
+            for (size_type i = begin; i < end; ++i) {
+                f(node->chunk[i]);
+            }
+        }
+
+        const size_type rightBegin = leftCount + chunkSize;
+        if (last > rightBegin) {
+            forEach(node->right,
+                    first > rightBegin ? first - rightBegin : 0,
+                    last - rightBegin, f);
+        }
+    }
+};
+
+template <typename T, size_t ChunkSize, typename Weight>
+template <typename InputIt>
+void ChunkedVector<T, ChunkSize, Weight>::assign(InputIt first, InputIt last)
+{
+    clear();
+    m_root = build(first, last);
+}
+
+template <typename T, size_t ChunkSize, typename Weight>
+template <typename InputIt>
+typename ChunkedVector<T, ChunkSize, Weight>::Node *
+ChunkedVector<T, ChunkSize, Weight>::build(InputIt first, InputIt last)
+{
+    // Chunks are filled up to the half, so that following inserts
+    // don't split them right away. Tree is built in linear time with
+    // the usual stack based cartesian tree construction.
+    Node *root = nullptr;
+    std::vector<Node*> rightSpine;
+    Node *node = nullptr;
+    for (; first != last; ++first) {
+        if (!node || node->chunk.size() >= ChunkSize / 2) {
+            node = newNode();
+            Node *lastPopped = nullptr;
+            while (!rightSpine.empty() && rightSpine.back()->priority < node->priority) {
+                lastPopped = rightSpine.back();
+                rightSpine.pop_back();
+            }
+            node->left = lastPopped;
+            if (!rightSpine.empty())
+                rightSpine.back()->right = node;
+            else
+                root = node;
+            rightSpine.push_back(node);
+        }
+        node->chunk.push_back(*first);
+        node->chunkSum += Weight()(node->chunk.back());
+    }
+
+    updateNodes(root);
+    return root;
+}
+
+} // ncxmms2
+
+#endif // CHUNKEDVECTOR_H
@@ -0,0 +1,249 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <assert.h>
+
+namespace ncxmms2 {
+
+/*   FlatHashMap is an open addressing hash map for integer keys (e.g. medialib ids).
+ * All entries live in one array, lookup is a linear probe over adjacent slots
+ * instead of following a pointer to a heap allocated node as in std::unordered_map.
+ * Deletion shifts following entries of the probe sequence back, so there are no
+ * tombstones and lookups don't degrade after many erasures.
+ *   Note: unlike std::unordered_map, insertion and erasure may move other entries,
+ * so references and iterators are invalidated by them.
+ */
+template <typename Key, typename T>
+class FlatHashMap
+{
+    static_assert(std::is_integral<Key>::value, "FlatHashMap supports only integer keys");
+
+public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<Key, T> value_type;
+    typedef size_t size_type;
+
+    template <typename Map, typename Value>
+    class Iterator
+    {
+    public:
+        Iterator(Map *map, size_type slot) : m_map(map), m_slot(slot) {skipEmpty();}
+
+        Value& operator*() const  {return m_map->m_slots[m_slot].value;}
+        Value *operator->() const {return &m_map->m_slots[m_slot].value;}
+
+        Iterator& operator++()
+        {
+            ++m_slot;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {return m_slot == other.m_slot;}
+        bool operator!=(const Iterator& other) const {return m_slot != other.m_slot;}
+
+    private:
+        friend class FlatHashMap;
+        Map *m_map;
+        size_type m_slot;
+
+        void skipEmpty()
+        {
+            while (m_slot < m_map->m_slots.size() && !m_map->m_slots[m_slot].used)
+                ++m_slot;
+        }
+    };
+
+    typedef Iterator<FlatHashMap, value_type> iterator;
+    typedef Iterator<const FlatHashMap, const value_type> const_iterator;
+
+    FlatHashMap() : m_size(0), m_capacityBits(0) {}
+
+    size_type size() const {return m_size;}
+    bool empty() const     {return m_size == 0;}
+
+    iterator begin()             {return iterator(this, 0);}
+    iterator end()               {return iterator(this, m_slots.size());}
+    const_iterator begin() const {return const_iterator(this, 0);}
+    const_iterator end() const   {return const_iterator(this, m_slots.size());}
+
+    void clear()
+    {
+        m_slots.clear();
+        m_size = 0;
+        m_capacityBits = 0;
+    }
+
+    // Makes room for count entries without rehashing
+    void reserve(size_type count)
+    {
+        size_type capacity = 16;
+        while (capacity * MaxLoadNumerator < count * MaxLoadDenominator)
+            capacity *= 2;
+        if (capacity > m_slots.size())
+            rehash(capacity);
+    }
+
+    iterator find(Key key)
+    {
+        return iterator(this, findSlot(key));
+    }
+
+    const_iterator find(Key key) const
+    {
+        return const_iterator(this, findSlot(key));
+    }
+
+    size_type count(Key key) const {return findSlot(key) != m_slots.size() ? 1 : 0;}
+
+    // The longest distance of an entry from its ideal slot, takes O(capacity)
+    size_type maxProbeLength() const
+    {
+        size_type result = 0;
+        for (size_type slot = 0; slot < m_slots.size(); ++slot) {
+            if (m_slots[slot].used)
+                result = std::max(result, (slot - idealSlot(m_slots[slot].value.first)) & mask());
+        }
+        return result;
+    }
+
+    T& operator[](Key key)
+    {
+        size_type slot = findSlot(key);
+        if (slot != m_slots.size())
+            return m_slots[slot].value.second;
+
+        if ((m_size + 1) * MaxLoadDenominator > m_slots.size() * MaxLoadNumerator)
+            rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+
+        slot = idealSlot(key);
+        while (m_slots[slot].used)
+            slot = (slot + 1) & mask();
+
+        m_slots[slot].used = true;
+        m_slots[slot].value.first = key;
+        ++m_size;
+        return m_slots[slot].value.second;
+    }
+
+    void erase(iterator it)
+    {
+        assert(it.m_map == this && it.m_slot < m_slots.size() && m_slots[it.m_slot].used);
+        eraseSlot(it.m_slot);
+    }
+
+    size_type erase(Key key)
+    {
+        const size_type slot = findSlot(key);
+        if (slot == m_slots.size())
+            return 0;
+        eraseSlot(slot);
+        return 1;
+    }
+
+private:
+    // Maximum load factor is 3/4
+    enum {MaxLoadNumerator = 3, MaxLoadDenominator = 4};
+
+    // Occupancy flag is kept next to the entry, so that a probe
+    // touches one cache line per slot
+    struct Slot
+    {
+        Slot() : used(false) {}
+        bool used;
+        value_type value;
+    };
+
+    std::vector<Slot> m_slots;
+    size_type m_size;
+    unsigned m_capacityBits;
+
+    size_type mask() const {return m_slots.size() - 1;}
+
+    size_type idealSlot(Key key) const
+    {
+        // Fibonacci hashing of the whole key: the high bits of the product
+        // depend on every bit of the key, so sequential ids are spread over
+        // the table instead of filling one long probe run
+        return (size_type)(((uint64_t)key * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - m_capacityBits));
+    }
+
+    size_type findSlot(Key key) const
+    {
+        if (m_slots.empty())
+            return 0;
+
+        for (size_type slot = idealSlot(key); m_slots[slot].used; slot = (slot + 1) & mask()) {
+            if (m_slots[slot].value.first == key)
+                return slot;
+        }
+        return m_slots.size();
+    }
+
+    void eraseSlot(size_type slot)
+    {
+        // Backward shift deletion: entries following the erased one in the same
+        // probe run are moved back, unless they are already at or after their
+        // ideal slot relative to the hole
+        size_type hole = slot;
+        for (size_type next = (hole + 1) & mask(); m_slots[next].used; next = (next + 1) & mask()) {
+            const size_type ideal = idealSlot(m_slots[next].value.first);
+            const bool stays = hole <= next
+                               ? (hole < ideal && ideal <= next)
+                               : (hole < ideal || ideal <= next);
+            if (stays)
+                continue;
+            m_slots[hole].value = std::move(m_slots[next].value);
+            hole = next;
+        }
+        m_slots[hole].used = false;
+        m_slots[hole].value = value_type();
+        --m_size;
+    }
+
+    void rehash(size_type capacity)
+    {
+        assert((capacity & (capacity - 1)) == 0);
+
+        std::vector<Slot> slots(capacity);
+        slots.swap(m_slots);
+        for (m_capacityBits = 0; ((size_type)1 << m_capacityBits) < capacity; ++m_capacityBits) {}
+
+        for (Slot& oldSlot : slots) {
+            if (!oldSlot.used)
+                continue;
+            size_type slot = idealSlot(oldSlot.value.first);
+            while (m_slots[slot].used)
+                slot = (slot + 1) & mask();
+            m_slots[slot].used = true;
+            m_slots[slot].value = std::move(oldSlot.value);
+        }
+    }
+};
+
+} // ncxmms2
+
+#endif // FLATHASHMAP_H
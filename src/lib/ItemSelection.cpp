@@ -0,0 +1,609 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <algorithm>
+#include <utility>
+#include <assert.h>
+
+#include "ItemSelection.h"
+
+using namespace ncxmms2;
+
+namespace {
+
+// 64 bits of the bitset starting at pos, bits past its end are zero
+uint64_t readBits(const std::vector<uint64_t>& bits, int pos)
+{
+    const size_t word = pos >> 6;
+    const int offset = pos & 63;
+    uint64_t result = word < bits.size() ? bits[word] >> offset : 0;
+    if (offset && word + 1 < bits.size())
+        result |= bits[word + 1] << (64 - offset);
+    return result;
+}
+
+// Destination bits must be clear
+void copyBits(const std::vector<uint64_t>& src, int srcPos,
+              std::vector<uint64_t> *dst, int dstPos, int count)
+{
+    while (count > 0) {
+        const int n = std::min(count, 64 - (dstPos & 63));
+        uint64_t chunk = readBits(src, srcPos);
+        if (n < 64)
+            chunk &= (uint64_t(1) << n) - 1;
+        (*dst)[dstPos >> 6] |= chunk << (dstPos & 63);
+        srcPos += n;
+        dstPos += n;
+        count -= n;
+    }
+}
+
+size_t wordsCount(int itemsCount)
+{
+    return (itemsCount + 63) / 64;
+}
+
+} // namespace
+
+ItemSelection::ItemSelection(int itemsCount) :
+    m_itemsCount(itemsCount),
+    m_size(0),
+    m_dense(false)
+{
+
+}
+
+std::vector<int> ItemSelection::items() const
+{
+    std::vector<int> result;
+    result.reserve(m_size);
+    forEachRun([&result](int begin, int end) {
+        for (int item = begin; item < end; ++item) {
+            result.push_back(item);
+        }
+    });
+    return result;
+}
+
+bool ItemSelection::contains(int item) const
+{
+    if (item < 0 || item >= m_itemsCount)
+        return false;
+
+    if (m_dense)
+        return (m_bits[item >> 6] >> (item & 63)) & 1;
+
+    const int run = findRun(item);
+    return run != -1 && item < m_runs[run].end;
+}
+
+int ItemSelection::first() const
+{
+    if (m_dense)
+        return nextSetBit(0);
+    return m_runs.empty() ? -1 : m_runs.front().begin;
+}
+
+int ItemSelection::last() const
+{
+    if (m_dense)
+        return previousSetBit(m_itemsCount - 1);
+    return m_runs.empty() ? -1 : m_runs.back().end - 1;
+}
+
+int ItemSelection::next(int item) const
+{
+    if (m_dense)
+        return nextSetBit(item + 1);
+
+    const int run = findRun(item);
+    if (run != -1 && item + 1 < m_runs[run].end)
+        return item + 1;
+    return (size_t)(run + 1) < m_runs.size() ? m_runs[run + 1].begin : -1;
+}
+
+int ItemSelection::previous(int item) const
+{
+    if (m_dense)
+        return previousSetBit(item - 1);
+
+    const int run = findRun(item - 1);
+    return run != -1 ? std::min(item - 1, m_runs[run].end - 1) : -1;
+}
+
+void ItemSelection::select(int item)
+{
+    assert(item >= 0 && item < m_itemsCount);
+    if (m_dense) {
+        uint64_t& word = m_bits[item >> 6];
+        const uint64_t bit = uint64_t(1) << (item & 63);
+        if (!(word & bit)) {
+            word |= bit;
+            ++m_size;
+        }
+    } else {
+        selectRange(item, 1);
+    }
+}
+
+void ItemSelection::unselect(int item)
+{
+    assert(item >= 0 && item < m_itemsCount);
+    if (m_dense) {
+        uint64_t& word = m_bits[item >> 6];
+        const uint64_t bit = uint64_t(1) << (item & 63);
+        if (word & bit) {
+            word &= ~bit;
+            --m_size;
+        }
+    } else {
+        unselectRange(item, 1);
+    }
+}
+
+void ItemSelection::toggle(int item)
+{
+    if (contains(item)) {
+        unselect(item);
+    } else {
+        select(item);
+    }
+}
+
+void ItemSelection::selectRange(int first, int count)
+{
+    if (count <= 0)
+        return;
+    assert(first >= 0 && first + count <= m_itemsCount);
+
+    if (m_dense) {
+        setBits(first, count, true);
+        countBits();
+        return;
+    }
+
+    // Runs overlapping or adjacent to the range are merged with it
+    int begin = first;
+    int end = first + count;
+    auto lo = std::lower_bound(m_runs.begin(), m_runs.end(), begin,
+                               [](const Run& run, int item) {return run.end < item;});
+    auto hi = std::upper_bound(lo, m_runs.end(), end,
+                               [](int item, const Run& run) {return item < run.begin;});
+    if (lo == hi) {
+        m_runs.insert(lo, Run(begin, end));
+    } else {
+        begin = std::min(begin, lo->begin);
+        end = std::max(end, (hi - 1)->end);
+        for (auto it = lo; it != hi; ++it) {
+            m_size -= it->end - it->begin;
+        }
+        *lo = Run(begin, end);
+        m_runs.erase(lo + 1, hi);
+    }
+    m_size += end - begin;
+    adjustRepresentation();
+}
+
+void ItemSelection::unselectRange(int first, int count)
+{
+    if (count <= 0)
+        return;
+    assert(first >= 0 && first + count <= m_itemsCount);
+
+    if (m_dense) {
+        setBits(first, count, false);
+        countBits();
+        return;
+    }
+
+    const int end = first + count;
+    auto lo = std::lower_bound(m_runs.begin(), m_runs.end(), first,
+                               [](const Run& run, int item) {return run.end <= item;});
+    auto hi = std::lower_bound(lo, m_runs.end(), end,
+                               [](const Run& run, int item) {return run.begin < item;});
+    if (lo == hi)
+        return;
+
+    // Only the runs at the edges of the range may keep a part
+    const Run head(lo->begin, first);
+    const Run tail(end, (hi - 1)->end);
+    for (auto it = lo; it != hi; ++it) {
+        m_size -= it->end - it->begin;
+    }
+    auto it = m_runs.erase(lo, hi);
+    if (tail.begin < tail.end) {
+        it = m_runs.insert(it, tail);
+        m_size += tail.end - tail.begin;
+    }
+    if (head.begin < head.end) {
+        m_runs.insert(it, head);
+        m_size += head.end - head.begin;
+    }
+    adjustRepresentation();
+}
+
+void ItemSelection::selectAll()
+{
+    std::vector<Run> runs;
+    if (m_itemsCount > 0)
+        runs.push_back(Run(0, m_itemsCount));
+    setRuns(std::move(runs));
+}
+
+void ItemSelection::clear()
+{
+    setRuns(std::vector<Run>());
+}
+
+void ItemSelection::invert()
+{
+    if (m_dense) {
+        for (uint64_t& word : m_bits) {
+            word = ~word;
+        }
+        if (m_itemsCount & 63)
+            m_bits.back() &= (uint64_t(1) << (m_itemsCount & 63)) - 1;
+        m_size = m_itemsCount - m_size;
+        return;
+    }
+
+    std::vector<Run> inverted;
+    inverted.reserve(m_runs.size() + 1);
+    int begin = 0;
+    for (const Run& run : m_runs) {
+        if (run.begin > begin)
+            inverted.push_back(Run(begin, run.begin));
+        begin = run.end;
+    }
+    if (begin < m_itemsCount)
+        inverted.push_back(Run(begin, m_itemsCount));
+    setRuns(std::move(inverted));
+    adjustRepresentation();
+}
+
+void ItemSelection::unite(const ItemSelection& other)
+{
+    assert(other.m_itemsCount == m_itemsCount);
+    if (other.empty())
+        return;
+
+    if (m_dense) {
+        other.forEachRun([this](int begin, int end) {
+            setBits(begin, end - begin, true);
+        });
+        countBits();
+        adjustRepresentation();
+        return;
+    }
+
+    const std::vector<Run> otherRuns = other.runs();
+    std::vector<Run> merged;
+    merged.reserve(m_runs.size() + otherRuns.size());
+    auto append = [&merged](const Run& run) {
+        if (!merged.empty() && run.begin <= merged.back().end) {
+            merged.back().end = std::max(merged.back().end, run.end);
+        } else {
+            merged.push_back(run);
+        }
+    };
+
+    auto it = m_runs.begin();
+    auto otherIt = otherRuns.begin();
+    while (it != m_runs.end() || otherIt != otherRuns.end()) {
+        if (otherIt == otherRuns.end() || (it != m_runs.end() && it->begin < otherIt->begin)) {
+            append(*it++);
+        } else {
+            append(*otherIt++);
+        }
+    }
+    setRuns(std::move(merged));
+    adjustRepresentation();
+}
+
+void ItemSelection::subtract(const ItemSelection& other)
+{
+    assert(other.m_itemsCount == m_itemsCount);
+    if (other.empty() || empty())
+        return;
+
+    if (m_dense) {
+        other.forEachRun([this](int begin, int end) {
+            setBits(begin, end - begin, false);
+        });
+        countBits();
+        adjustRepresentation();
+        return;
+    }
+
+    const std::vector<Run> otherRuns = other.runs();
+    std::vector<Run> left;
+    auto otherIt = otherRuns.begin();
+    for (const Run& run : m_runs) {
+        while (otherIt != otherRuns.end() && otherIt->end <= run.begin) {
+            ++otherIt;
+        }
+        int begin = run.begin;
+        for (auto it = otherIt; it != otherRuns.end() && it->begin < run.end; ++it) {
+            if (it->begin > begin)
+                left.push_back(Run(begin, it->begin));
+            begin = std::max(begin, it->end);
+        }
+        if (begin < run.end)
+            left.push_back(Run(begin, run.end));
+    }
+    setRuns(std::move(left));
+    adjustRepresentation();
+}
+
+void ItemSelection::reset(int itemsCount)
+{
+    m_itemsCount = itemsCount;
+    clear();
+}
+
+void ItemSelection::itemsInserted(int first, int count)
+{
+    if (count <= 0)
+        return;
+    assert(first >= 0 && first <= m_itemsCount);
+
+    const int oldItemsCount = m_itemsCount;
+    m_itemsCount += count;
+
+    if (m_dense) {
+        std::vector<uint64_t> bits(wordsCount(m_itemsCount), 0);
+        copyBits(m_bits, 0, &bits, 0, first);
+        copyBits(m_bits, first, &bits, first + count, oldItemsCount - first);
+        m_bits.swap(bits);
+        return;
+    }
+
+    // Run containing the new items is split, the following ones are shifted
+    auto it = std::lower_bound(m_runs.begin(), m_runs.end(), first,
+                               [](const Run& run, int item) {return run.end <= item;});
+    if (it != m_runs.end() && it->begin < first) {
+        const Run tail(first + count, it->end + count);
+        it->end = first;
+        it = m_runs.insert(it + 1, tail) + 1;
+    }
+    for (; it != m_runs.end(); ++it) {
+        it->begin += count;
+        it->end += count;
+    }
+    adjustRepresentation();
+}
+
+void ItemSelection::itemsRemoved(int first, int count)
+{
+    if (count <= 0)
+        return;
+    assert(first >= 0 && first + count <= m_itemsCount);
+
+    const int oldItemsCount = m_itemsCount;
+    m_itemsCount -= count;
+
+    if (m_dense) {
+        std::vector<uint64_t> bits(wordsCount(m_itemsCount), 0);
+        copyBits(m_bits, 0, &bits, 0, first);
+        copyBits(m_bits, first + count, &bits, first, oldItemsCount - first - count);
+        m_bits.swap(bits);
+        countBits();
+        adjustRepresentation();
+        return;
+    }
+
+    // Removed items are cut out of the runs, runs around them may join
+    auto it = std::lower_bound(m_runs.begin(), m_runs.end(), first,
+                               [](const Run& run, int item) {return run.end < item;});
+    auto out = it;
+    for (; it != m_runs.end(); ++it) {
+        const int begin = it->begin < first ? it->begin : std::max(it->begin - count, first);
+        const int end = it->end <= first ? it->end : std::max(it->end - count, first);
+        m_size -= (it->end - it->begin) - (end - begin);
+        if (begin == end)
+            continue;
+        if (out != m_runs.begin() && (out - 1)->end == begin) {
+            (out - 1)->end = end;
+        } else {
+            *out++ = Run(begin, end);
+        }
+    }
+    m_runs.erase(out, m_runs.end());
+}
+
+void ItemSelection::itemsMoved(int first, int count, int to)
+{
+    if (count <= 0 || first == to)
+        return;
+
+    std::vector<Run> movedRuns;
+    const int end = first + count;
+    forEachRun([&movedRuns, first, end, to](int runBegin, int runEnd) {
+        const int begin = std::max(runBegin, first);
+        runEnd = std::min(runEnd, end);
+        if (begin < runEnd)
+            movedRuns.push_back(Run(begin - first + to, runEnd - first + to));
+    });
+
+    itemsRemoved(first, count);
+    itemsInserted(to, count);
+
+    if (!movedRuns.empty()) {
+        ItemSelection moved(m_itemsCount);
+        moved.setRuns(std::move(movedRuns));
+        unite(moved);
+    }
+}
+
+int ItemSelection::findRun(int item) const
+{
+    auto it = std::upper_bound(m_runs.begin(), m_runs.end(), item,
+                               [](int item, const Run& run) {return item < run.begin;});
+    return (it - m_runs.begin()) - 1;
+}
+
+template <typename F>
+void ItemSelection::forEachRun(F f) const
+{
+    if (!m_dense) {
+        for (const Run& run : m_runs) {
+            f(run.begin, run.end);
+        }
+        return;
+    }
+
+    int begin = nextSetBit(0);
+    while (begin != -1) {
+        const int end = nextClearBit(begin);
+        f(begin, end);
+        begin = nextSetBit(end);
+    }
+}
+
+std::vector<ItemSelection::Run> ItemSelection::runs() const
+{
+    if (!m_dense)
+        return m_runs;
+
+    std::vector<Run> result;
+    forEachRun([&result](int begin, int end) {
+        result.push_back(Run(begin, end));
+    });
+    return result;
+}
+
+void ItemSelection::setRuns(std::vector<Run> runs)
+{
+    m_dense = false;
+    std::vector<uint64_t>().swap(m_bits);
+    m_runs.swap(runs);
+    m_size = 0;
+    for (const Run& run : m_runs) {
+        m_size += run.end - run.begin;
+    }
+}
+
+int ItemSelection::runsCount() const
+{
+    if (!m_dense)
+        return m_runs.size();
+
+    // Count bits which are set while the previous ones are not
+    int count = 0;
+    uint64_t carry = 0;
+    for (uint64_t word : m_bits) {
+        count += __builtin_popcountll(word & ~((word << 1) | carry));
+        carry = word >> 63;
+    }
+    return count;
+}
+
+int ItemSelection::nextSetBit(int pos) const
+{
+    pos = std::max(pos, 0);
+    if (pos >= m_itemsCount)
+        return -1;
+
+    size_t word = pos >> 6;
+    uint64_t bits = m_bits[word] & (~uint64_t(0) << (pos & 63));
+    while (!bits) {
+        if (++word == m_bits.size())
+            return -1;
+        bits = m_bits[word];
+    }
+    return word * 64 + __builtin_ctzll(bits);
+}
+
+int ItemSelection::nextClearBit(int pos) const
+{
+    if (pos >= m_itemsCount)
+        return m_itemsCount;
+
+    size_t word = pos >> 6;
+    uint64_t bits = ~m_bits[word] & (~uint64_t(0) << (pos & 63));
+    while (!bits) {
+        if (++word == m_bits.size())
+            return m_itemsCount;
+        bits = ~m_bits[word];
+    }
+    return std::min<int>(word * 64 + __builtin_ctzll(bits), m_itemsCount);
+}
+
+int ItemSelection::previousSetBit(int pos) const
+{
+    pos = std::min(pos, m_itemsCount - 1);
+    if (pos < 0)
+        return -1;
+
+    int word = pos >> 6;
+    uint64_t bits = m_bits[word] & (~uint64_t(0) >> (63 - (pos & 63)));
+    while (!bits) {
+        if (--word < 0)
+            return -1;
+        bits = m_bits[word];
+    }
+    return word * 64 + 63 - __builtin_clzll(bits);
+}
+
+void ItemSelection::setBits(int first, int count, bool value)
+{
+    const int end = first + count;
+    while (first < end) {
+        const int offset = first & 63;
+        const int n = std::min(64 - offset, end - first);
+        const uint64_t mask = (n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1) << offset;
+        if (value) {
+            m_bits[first >> 6] |= mask;
+        } else {
+            m_bits[first >> 6] &= ~mask;
+        }
+        first += n;
+    }
+}
+
+void ItemSelection::countBits()
+{
+    m_size = 0;
+    for (uint64_t word : m_bits) {
+        m_size += __builtin_popcountll(word);
+    }
+}
+
+void ItemSelection::makeDense()
+{
+    m_bits.assign(wordsCount(m_itemsCount), 0);
+    for (const Run& run : m_runs) {
+        setBits(run.begin, run.end - run.begin, true);
+    }
+    std::vector<Run>().swap(m_runs);
+    m_dense = true;
+}
+
+void ItemSelection::makeSparse()
+{
+    setRuns(runs());
+}
+
+void ItemSelection::adjustRepresentation()
+{
+    // Thresholds differ, so a selection near the edge does not flip back and forth
+    if (!m_dense) {
+        if ((int)m_runs.size() > denseThreshold())
+            makeDense();
+    } else if (runsCount() < denseThreshold() / 4) {
+        makeSparse();
+    }
+}
@@ -0,0 +1,138 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#ifndef ITEMSELECTION_H
+#define ITEMSELECTION_H
+
+#include <vector>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+
+namespace ncxmms2 {
+
+/*   ItemSelection is a set of selected items of a list with itemsCount items.
+ * It is kept as a sorted list of runs of consecutive selected items, so
+ * selecting all items or inverting the selection of a large list takes
+ * constant memory, and items insertion, removal and moving only shift
+ * the runs. When the selection gets so fragmented that the runs would take
+ * more memory than a bit per item, it switches to a bitset and switches
+ * back once bulk operations leave a few runs.
+ *   Iteration yields selected items in ascending order.
+ */
+class ItemSelection
+{
+public:
+    explicit ItemSelection(int itemsCount = 0);
+
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int* pointer;
+        typedef int reference;
+
+        const_iterator() : m_selection(nullptr), m_item(-1) {}
+
+        int operator*() const {return m_item;}
+        const_iterator& operator++() {m_item = m_selection->next(m_item); return *this;}
+        const_iterator operator++(int) {const_iterator it = *this; ++(*this); return it;}
+
+        bool operator==(const const_iterator& other) const {return m_item == other.m_item;}
+        bool operator!=(const const_iterator& other) const {return m_item != other.m_item;}
+
+    private:
+        friend class ItemSelection;
+        const_iterator(const ItemSelection *selection, int item) : m_selection(selection), m_item(item) {}
+        const ItemSelection *m_selection;
+        int m_item;
+    };
+
+    const_iterator begin() const {return const_iterator(this, first());}
+    const_iterator end() const   {return const_iterator(this, -1);}
+    std::vector<int> items() const;
+
+    int itemsCount() const {return m_itemsCount;}
+    int size() const       {return m_size;}
+    bool empty() const     {return m_size == 0;}
+    bool isDense() const   {return m_dense;}
+
+    bool contains(int item) const;
+    // Return -1 if there is no such item
+    int first() const;
+    int last() const;
+    int next(int item) const;     // The first selected item after item
+    int previous(int item) const; // The last selected item before item
+
+    void select(int item);
+    void unselect(int item);
+    void toggle(int item);
+    void selectRange(int first, int count);
+    void unselectRange(int first, int count);
+    void selectAll();
+    void clear();
+    void invert();
+    // Both selections must have the same itemsCount
+    void unite(const ItemSelection& other);
+    void subtract(const ItemSelection& other);
+
+    // Drops the selection
+    void reset(int itemsCount);
+    // Keep selected the same items when the list is changed
+    void itemsInserted(int first, int count);
+    void itemsRemoved(int first, int count);
+    void itemsMoved(int first, int count, int to);
+
+private:
+    // Run of selected items [begin, end)
+    struct Run
+    {
+        Run(int begin_, int end_) : begin(begin_), end(end_) {}
+        int begin;
+        int end;
+    };
+
+    int m_itemsCount;
+    int m_size;
+    bool m_dense;
+    std::vector<Run> m_runs;       // Sorted, neither overlapping nor adjacent
+    std::vector<uint64_t> m_bits;  // Bit per item in dense mode
+
+    // Index of the last run starting not after item, or -1
+    int findRun(int item) const;
+    template <typename F>
+    void forEachRun(F f) const;
+    std::vector<Run> runs() const;
+    void setRuns(std::vector<Run> runs);
+    int runsCount() const;
+
+    // Bitset helpers, positions past itemsCount are always zero
+    int nextSetBit(int pos) const;
+    int nextClearBit(int pos) const;
+    int previousSetBit(int pos) const;
+    void setBits(int first, int count, bool value);
+    void countBits();
+
+    void makeDense();
+    void makeSparse();
+    // Picks representation taking less memory
+    void adjustRepresentation();
+    int denseThreshold() const {return 64 + m_itemsCount / 64;}
+};
+} // ncxmms2
+
+#endif // ITEMSELECTION_H
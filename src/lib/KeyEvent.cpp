@@ -23,7 +23,9 @@
 
 using namespace ncxmms2;
 
-KeyEvent::KeyEvent(const TermKeyKey& termKey) : m_key(0)
+KeyEvent::KeyEvent(const TermKeyKey& termKey, int repeatCount) :
+    m_key(0),
+    m_repeatCount(repeatCount)
 {
     static const folly::sorted_vector_map<char32_t, char32_t> keyMap
     {
@@ -76,6 +78,20 @@ KeyEvent::KeyEvent(const TermKeyKey& termKey) : m_key(0)
         m_key |= ModifierCtrl;
 }
 
+bool KeyEvent::isNavigationKey() const
+{
+    switch (m_key) {
+        case KeyUp:
+        case KeyDown:
+        case KeyPageUp:
+        case KeyPageDown:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
 std::string KeyEvent::keyName() const
 {
     static const folly::sorted_vector_map<key_t, const char*> keyNames
@@ -28,13 +28,18 @@ class KeyEvent
 public:
     typedef char32_t key_t;
 
-    explicit KeyEvent(const TermKeyKey& termKey);
-    explicit KeyEvent(key_t key) : m_key(key) {}
+    explicit KeyEvent(const TermKeyKey& termKey, int repeatCount = 1);
+    explicit KeyEvent(key_t key, int repeatCount = 1) : m_key(key), m_repeatCount(repeatCount) {}
 
     key_t key() const          {return m_key;}
     bool isFunctionKey() const {return (m_key & KeyCodeMask) > KeyLastUtf32Char;}
     std::string keyName() const;
 
+    // Number of presses of the key folded into this event, see
+    // Window::handlesKeyRepeatCount
+    int repeatCount() const    {return m_repeatCount;}
+    bool isNavigationKey() const;
+
     enum
     {
         KeyLastUtf32Char = 0x10FFFF,
@@ -81,6 +86,7 @@ public:
 
 private:
     key_t m_key;
+    int m_repeatCount;
 };
 } // ncxmms2
 
@@ -40,6 +40,7 @@ public:
     const LineEdit *q;
 
     LineEdit::ResultCallback resultCallback;
+    LineEdit::TextChangedCallback textChangedCallback;
 
     std::u32string text;
     bool textSelected;
@@ -184,6 +185,7 @@ void LineEdit::edit(const ResultCallback& resultCallback, const std::string& tex
 void LineEdit::edit(const ResultCallback& resultCallback, const std::u32string& text)
 {
     d->resultCallback = resultCallback;
+    d->textChangedCallback = nullptr;
     d->text = text;
     d->cursorPosition = text.size();
     d->textSelected = !text.empty();
@@ -192,8 +194,14 @@ void LineEdit::edit(const ResultCallback& resultCallback, const std::u32string&
     update();
 }
 
+void LineEdit::setTextChangedCallback(const TextChangedCallback& textChangedCallback)
+{
+    d->textChangedCallback = textChangedCallback;
+}
+
 void LineEdit::keyPressedEvent(const KeyEvent& keyEvent)
 {
+    const std::u32string oldText = d->text;
     if (keyEvent.isFunctionKey()) {
         switch(keyEvent.key()) {
             case KeyEvent::KeyEscape:    d->returnResult(Result::Rejected); return;
@@ -209,6 +217,9 @@ void LineEdit::keyPressedEvent(const KeyEvent& keyEvent)
         d->addChar(keyEvent.key());
     }
     update();
+
+    if (d->textChangedCallback && d->text != oldText)
+        d->textChangedCallback(u32stringToUtf8(d->text));
 }
 
 void LineEdit::resize(const Size& size)
@@ -34,9 +34,12 @@ public:
         Accepted
     };
     typedef std::function<void (const std::string&, Result)> ResultCallback;
+    typedef std::function<void (const std::string&)> TextChangedCallback;
 
     void edit(const ResultCallback& resultCallback, const std::string& text = std::string());
     void edit(const ResultCallback& resultCallback, const std::u32string& text = std::u32string());
+    // Called on every change of the text while it is edited, edit resets it
+    void setTextChangedCallback(const TextChangedCallback& textChangedCallback);
 
     virtual void keyPressedEvent(const KeyEvent& keyEvent);
     virtual void resize(const Size& size);
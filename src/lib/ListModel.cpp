@@ -15,6 +15,8 @@
  */
 
 #include "ListModel.h"
+#include "ListModelItemData.h"
+#include "SearchTextArena.h"
 
 using namespace ncxmms2;
 
@@ -32,3 +34,10 @@ void ListModel::refresh()
 {
 
 }
+
+void ListModel::searchText(int item, std::string *text) const
+{
+    ListModelItemData itemData;
+    data(item, &itemData);
+    SearchTextArena::fold(itemData.textPtr->data(), itemData.textPtr->size(), text);
+}
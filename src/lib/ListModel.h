@@ -17,6 +17,11 @@
 #ifndef LISTMODEL_H
 #define LISTMODEL_H
 
+#include <string>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
 #include "Object.h"
 
 namespace ncxmms2 {
@@ -32,16 +37,103 @@ public:
     virtual int itemsCount() const = 0;
     virtual void data(int item, ListModelItemData *itemData) const = 0;
 
+    // Appends case folded text the item is searched by, the text of
+    // its data by default
+    virtual void searchText(int item, std::string *text) const;
+
     virtual void refresh();
 
     // Signals
     NCXMMS2_SIGNAL(reset)
     NCXMMS2_SIGNAL(itemsChanged, int, int)
     NCXMMS2_SIGNAL(itemAdded)
+    NCXMMS2_SIGNAL(itemsAdded, int)
     NCXMMS2_SIGNAL(itemInserted, int)
+    NCXMMS2_SIGNAL(itemsInserted, int, int)  // first, count
     NCXMMS2_SIGNAL(itemRemoved, int)
+    NCXMMS2_SIGNAL(itemsRemoved, int, int)   // first, count
     NCXMMS2_SIGNAL(itemMoved, int, int)
+    NCXMMS2_SIGNAL(itemsMoved, int, int, int) // first, count, new position of first
+
+protected:
+    // Replaces rows with newRows, both sorted by less. Rows are merged in one pass,
+    // then every run of removed, inserted or changed rows is emitted at once, so
+    // views keep their current item. Scattered changes reset the model instead.
+    template <typename T, typename Less>
+    void updateSortedRows(std::vector<T> *rows, std::vector<T>&& newRows, Less less);
 };
+
+template <typename T, typename Less>
+void ListModel::updateSortedRows(std::vector<T> *rows, std::vector<T>&& newRows, Less less)
+{
+    // Positions of runs are the ones rows have when the preceding runs are applied
+    struct Run
+    {
+        enum Type {Removed, Inserted, Changed};
+        Type type;
+        int position;
+        int count;
+        int newRow; // First row of newRows, inserted and changed runs only
+    };
+    std::vector<Run> runs;
+    std::vector<Run> changedRuns;
+    auto addRow = [](std::vector<Run> *runs, typename Run::Type type, int position, int newRow) {
+        if (!runs->empty()) {
+            Run& last = runs->back();
+            const int next = type == Run::Removed ? last.position : last.position + last.count;
+            if (last.type == type && next == position) {
+                ++last.count;
+                return;
+            }
+        }
+        runs->push_back(Run{type, position, 1, newRow});
+    };
+
+    const int oldCount = rows->size();
+    const int newCount = newRows.size();
+    int oldRow = 0;
+    int newRow = 0;
+    int position = 0;
+    while (oldRow < oldCount || newRow < newCount) {
+        if (newRow == newCount || (oldRow < oldCount && less((*rows)[oldRow], newRows[newRow]))) {
+            addRow(&runs, Run::Removed, position, -1);
+            ++oldRow;
+        } else if (oldRow == oldCount || less(newRows[newRow], (*rows)[oldRow])) {
+            addRow(&runs, Run::Inserted, position++, newRow++);
+        } else {
+            if (!((*rows)[oldRow] == newRows[newRow]))
+                addRow(&changedRuns, Run::Changed, position, newRow);
+            ++oldRow;
+            ++newRow;
+            ++position;
+        }
+    }
+
+    // Every run is a range handler and a repaint in views
+    const size_t MaxRuns = 16;
+    if (runs.size() + changedRuns.size() > MaxRuns) {
+        rows->swap(newRows);
+        reset();
+        return;
+    }
+
+    for (const Run& run : runs) {
+        if (run.type == Run::Removed) {
+            rows->erase(rows->begin() + run.position, rows->begin() + run.position + run.count);
+            itemsRemoved(run.position, run.count);
+        } else {
+            auto first = std::make_move_iterator(newRows.begin() + run.newRow);
+            rows->insert(rows->begin() + run.position, first, first + run.count);
+            itemsInserted(run.position, run.count);
+        }
+    }
+    // Changed rows keep positions, as all runs after them are applied later
+    for (const Run& run : changedRuns) {
+        std::move(newRows.begin() + run.newRow, newRows.begin() + run.newRow + run.count,
+                  rows->begin() + run.position);
+        itemsChanged(run.position, run.position + run.count - 1);
+    }
+}
 } // ncxmms2
 
 #endif // LISTMODEL_H
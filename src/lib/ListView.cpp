@@ -27,6 +27,8 @@
 #include "ListModelItemData.h"
 #include "ListModelItemDelegate.h"
 #include "ListItemPaintOptions.h"
+#include "SearchTextArena.h"
+#include "TrigramIndex.h"
 #include "Timer.h"
 #include "Painter.h"
 
@@ -43,7 +45,9 @@ public:
         viewportBeginItem(-1),
         viewportEndItem(-1),
         currentItemHidden(false),
-        hideCurrentItemSelectionInterval(0) {}
+        hideCurrentItemSelectionInterval(0),
+        currentItemSettlePending(false),
+        searchMatchesValid(false) {}
 
     ListView *q;
     ListModel *model;
@@ -55,28 +59,48 @@ public:
 
     int itemLine(int item) const {return item - viewportBeginItem;}
 
-    std::vector<int> selectedItems;
+    ItemSelection selectedItems;
 
     Timer hideSelectionTimer;
     bool currentItemHidden;
     unsigned int hideCurrentItemSelectionInterval;
 
+    Timer currentItemSettleTimer;
+    bool currentItemSettlePending;
+    void currentItemSettleTimeout();
+
     std::vector<Signals::Connection> modelConnections;
     void disconnectModel();
 
+    // Index is built on the first search and dropped on structural changes
+    // of the model, changed texts of a few items are updated in place
+    TrigramIndex searchIndex;
+    std::string searchPattern;
+    std::string foldedSearchPattern;
+    std::vector<int> searchMatches;
+    bool searchMatchesValid;
+
+    void invalidateSearchIndex();
+    void updateSearchIndex(int first, int last);
+    void updateSearchMatches(const std::string& previousPattern);
+
     void reset();
     void itemsChanged(int first, int last);
     void itemAdded();
+    void itemsAdded(int count);
     void itemInserted(int item);
+    void itemsInserted(int first, int count);
     void itemRemoved(int item);
+    void itemsRemoved(int first, int count);
     void itemMoved(int from, int to);
+    void itemsMoved(int first, int count, int to);
 
     void changeCurrentItem(int item);
     void scrollUp();
     void scrollDown();
 
-    void cursorUp();
-    void cursorDown();
+    void cursorUp(int count = 1);
+    void cursorDown(int count = 1);
 
     void toggleSelection(int item);
     void jumpToNextSelectedItem();
@@ -94,6 +118,8 @@ ListView::ListView(const Rectangle& rect, Window *parent) :
     loadPalette("ListView");
     d->hideSelectionTimer.setSingleShot(true);
     d->hideSelectionTimer.timeout_Connect(&ListView::hideCurrentItem, this);
+    d->currentItemSettleTimer.setSingleShot(true);
+    d->currentItemSettleTimer.timeout_Connect(std::bind(&ListViewPrivate::currentItemSettleTimeout, d.get()));
 }
 
 ListView::~ListView()
@@ -127,21 +153,62 @@ void ListView::setModel(ListModel *model)
                 std::bind(&ListViewPrivate::itemAdded, d.get())
         ));
 
+        d->modelConnections.push_back(
+            model->itemsAdded_Connect(
+                std::bind(&ListViewPrivate::itemsAdded, d.get(), std::placeholders::_1)
+        ));
+
         d->modelConnections.push_back(
             model->itemInserted_Connect(
                 std::bind(&ListViewPrivate::itemInserted, d.get(), std::placeholders::_1)
         ));
 
+        d->modelConnections.push_back(
+            model->itemsInserted_Connect(
+                std::bind(&ListViewPrivate::itemsInserted, d.get(), std::placeholders::_1, std::placeholders::_2)
+        ));
+
         d->modelConnections.push_back(
             model->itemRemoved_Connect(
                 std::bind(&ListViewPrivate::itemRemoved, d.get(), std::placeholders::_1)
         ));
 
+        d->modelConnections.push_back(
+            model->itemsRemoved_Connect(
+                std::bind(&ListViewPrivate::itemsRemoved, d.get(), std::placeholders::_1, std::placeholders::_2)
+        ));
+
         d->modelConnections.push_back(
             model->itemMoved_Connect(
                 std::bind(&ListViewPrivate::itemMoved, d.get(), std::placeholders::_1, std::placeholders::_2)
         ));
+
+        d->modelConnections.push_back(
+            model->itemsMoved_Connect(
+                std::bind(&ListViewPrivate::itemsMoved, d.get(), std::placeholders::_1,
+                          std::placeholders::_2, std::placeholders::_3)
+        ));
+
+        // Positions of items are changed by any of these
+        auto invalidateSearchIndex = std::bind(&ListViewPrivate::invalidateSearchIndex, d.get());
+        d->modelConnections.push_back(model->reset_Connect(invalidateSearchIndex));
+        d->modelConnections.push_back(model->itemAdded_Connect(invalidateSearchIndex));
+        d->modelConnections.push_back(model->itemsAdded_Connect(invalidateSearchIndex));
+        d->modelConnections.push_back(model->itemInserted_Connect(invalidateSearchIndex));
+        d->modelConnections.push_back(model->itemsInserted_Connect(invalidateSearchIndex));
+        d->modelConnections.push_back(model->itemRemoved_Connect(invalidateSearchIndex));
+        d->modelConnections.push_back(model->itemsRemoved_Connect(invalidateSearchIndex));
+        d->modelConnections.push_back(model->itemMoved_Connect(invalidateSearchIndex));
+        d->modelConnections.push_back(model->itemsMoved_Connect(invalidateSearchIndex));
+
+        d->modelConnections.push_back(
+            model->itemsChanged_Connect(
+                std::bind(&ListViewPrivate::updateSearchIndex, d.get(), std::placeholders::_1, std::placeholders::_2)
+        ));
     }
+    d->searchPattern.clear();
+    d->foldedSearchPattern.clear();
+    d->invalidateSearchIndex();
     d->reset();
 }
 
@@ -180,6 +247,8 @@ void ListView::setCurrentItem(int item)
     if (item < 0 || item >= d->model->itemsCount())
         return;
 
+    const int oldCurrentItem = d->currentItem;
+    const int oldViewportBeginItem = d->viewportBeginItem;
     if (item < d->viewportBeginItem) {
         d->viewportBeginItem = item;
         d->viewportEndItem = d->viewportBeginItem + lines();
@@ -188,7 +257,8 @@ void ListView::setCurrentItem(int item)
         d->viewportBeginItem = d->viewportEndItem - lines();
     }
     d->changeCurrentItem(item);
-    update();
+    scrollContent(d->viewportBeginItem - oldViewportBeginItem);
+    d->itemsChanged(oldCurrentItem, oldCurrentItem);
     showCurrentItem();
 }
 
@@ -240,6 +310,8 @@ void ListView::scrollToItem(int item)
     if (item < 0 || item >= d->model->itemsCount())
         return;
 
+    const int oldCurrentItem = d->currentItem;
+    const int oldViewportBeginItem = d->viewportBeginItem;
     if (item < d->viewportBeginItem) {
         d->viewportBeginItem = item;
         d->viewportEndItem = d->viewportBeginItem + lines();
@@ -251,7 +323,11 @@ void ListView::scrollToItem(int item)
         if (!(d->currentItem >= d->viewportBeginItem && d->currentItem < d->viewportEndItem))
             d->changeCurrentItem(d->viewportBeginItem);
     }
-    update();
+    scrollContent(d->viewportBeginItem - oldViewportBeginItem);
+    if (d->currentItem != oldCurrentItem) {
+        d->itemsChanged(oldCurrentItem, oldCurrentItem);
+        d->itemsChanged(d->currentItem, d->currentItem);
+    }
 }
 
 int ListView::viewportFirstItem() const
@@ -276,6 +352,8 @@ void ListView::setViewportFirstItem(int item)
     if (itemsCount <= lines())
         return;
 
+    const int oldCurrentItem = d->currentItem;
+    const int oldViewportBeginItem = d->viewportBeginItem;
     if (item + lines() < itemsCount) {
         d->viewportBeginItem = item;
         d->viewportEndItem = d->viewportBeginItem + lines();
@@ -284,43 +362,37 @@ void ListView::setViewportFirstItem(int item)
         d->viewportBeginItem = d->viewportEndItem - lines();
     }
     d->changeCurrentItem(d->viewportBeginItem);
-    update();
+    scrollContent(d->viewportBeginItem - oldViewportBeginItem);
+    d->itemsChanged(oldCurrentItem, oldCurrentItem);
+    d->itemsChanged(d->currentItem, d->currentItem);
 }
 
-const std::vector<int>& ListView::selectedItems() const
+const ItemSelection& ListView::selectedItems() const
 {
     return d->selectedItems;
 }
 
 void ListView::selectItem(int item)
 {
-    if (!d->model)
+    if (!d->model || d->selectedItems.contains(item))
         return;
 
-    auto it = std::lower_bound(d->selectedItems.begin(), d->selectedItems.end(), item);
-    if (it != d->selectedItems.end() && *it == item) {
-        return;
-    }
-    d->selectedItems.insert(it, item);
+    d->selectedItems.select(item);
     d->itemsChanged(item, item);
 }
 
 void ListView::unselectItem(int item)
 {
-    if (!d->model)
+    if (!d->model || !d->selectedItems.contains(item))
         return;
 
-    auto it = std::lower_bound(d->selectedItems.begin(), d->selectedItems.end(), item);
-    if (it != d->selectedItems.end() && *it == item) {
-        d->selectedItems.erase(it);
-        d->itemsChanged(item, item);
-    }
+    d->selectedItems.unselect(item);
+    d->itemsChanged(item, item);
 }
 
 bool ListView::isItemSelected(int item) const
 {
-    return std::binary_search(d->selectedItems.begin(), d->selectedItems.end(),
-                              item);
+    return d->selectedItems.contains(item);
 }
 
 void ListView::clearSelection()
@@ -329,8 +401,8 @@ void ListView::clearSelection()
         return;
 
     if (!d->selectedItems.empty()) {
-        const int first = *d->selectedItems.begin();
-        const int last = *d->selectedItems.rbegin();
+        const int first = d->selectedItems.first();
+        const int last = d->selectedItems.last();
         d->selectedItems.clear();
         d->itemsChanged(first, last);
     }
@@ -341,15 +413,7 @@ void ListView::invertSelection()
     if (!d->model)
         return;
 
-    const int itemsCount = d->model->itemsCount();
-    std::vector<int> invertedSelection;
-    invertedSelection.reserve(itemsCount - d->selectedItems.size());
-    for (int item = 0; item < itemsCount; ++item) {
-        if (!isItemSelected(item)) {
-            invertedSelection.push_back(item);
-        }
-    }
-    d->selectedItems.swap(invertedSelection);
+    d->selectedItems.invert();
     update();
 }
 
@@ -366,16 +430,14 @@ void ListView::selectItemsByRegExp(const std::string& pattern)
     if (!regex)
         return;
 
+    ItemSelection matchedItems(itemsCount);
     for (int item = 0; item < itemsCount; ++item) {
         model->data(item, &itemData);
         if (g_regex_match(regex, itemData.textPtr->c_str(), (GRegexMatchFlags)0, nullptr)) {
-            auto it = std::lower_bound(d->selectedItems.begin(), d->selectedItems.end(), item);
-            if (it != d->selectedItems.end() && *it == item) {
-                continue;
-            }
-            d->selectedItems.insert(it, item);
+            matchedItems.select(item);
         }
     }
+    d->selectedItems.unite(matchedItems);
     update();
     g_regex_unref(regex);
 }
@@ -392,14 +454,14 @@ void ListView::unselectItemsByRegExp(const std::string &pattern)
     if (!regex)
         return;
 
-    std::vector<int> leftSelectedItems;
+    ItemSelection matchedItems(model->itemsCount());
     for (int item : d->selectedItems) {
         model->data(item, &itemData);
-        if (!g_regex_match(regex, itemData.textPtr->c_str(), (GRegexMatchFlags)0, nullptr)) {
-            leftSelectedItems.push_back(item);
+        if (g_regex_match(regex, itemData.textPtr->c_str(), (GRegexMatchFlags)0, nullptr)) {
+            matchedItems.select(item);
         }
     }
-    d->selectedItems.swap(leftSelectedItems);
+    d->selectedItems.subtract(matchedItems);
     update();
     g_regex_unref(regex);
 }
@@ -410,15 +472,13 @@ void ListView::selectItems(const std::function<bool (int)>& predicate)
         return;
 
     const int itemsCount = d->model->itemsCount();
+    ItemSelection matchedItems(itemsCount);
     for (int item = 0; item < itemsCount; ++item) {
         if (predicate(item)) {
-            auto it = std::lower_bound(d->selectedItems.begin(), d->selectedItems.end(), item);
-            if (it != d->selectedItems.end() && *it == item) {
-                continue;
-            }
-            d->selectedItems.insert(it, item);
+            matchedItems.select(item);
         }
     }
+    d->selectedItems.unite(matchedItems);
     update();
 }
 
@@ -427,21 +487,152 @@ void ListView::unselectItems(const std::function<bool (int)>& predicate)
     if (!d->model || !predicate)
         return;
 
-    std::vector<int> leftSelectedItems;
+    ItemSelection matchedItems(d->model->itemsCount());
     for (int item : d->selectedItems) {
-        if (!predicate(item)) {
-            leftSelectedItems.push_back(item);
+        if (predicate(item)) {
+            matchedItems.select(item);
         }
     }
-    d->selectedItems.swap(leftSelectedItems);
+    d->selectedItems.subtract(matchedItems);
     update();
 }
 
+void ListView::selectItems(const std::vector<int>& items)
+{
+    if (!d->model || items.empty())
+        return;
+
+    ItemSelection newItems(d->model->itemsCount());
+    for (int item : items) {
+        newItems.select(item);
+    }
+    d->selectedItems.unite(newItems);
+    update();
+}
+
+void ListView::unselectItems(const std::vector<int>& items)
+{
+    if (!d->model || items.empty())
+        return;
+
+    ItemSelection oldItems(d->model->itemsCount());
+    for (int item : items) {
+        oldItems.select(item);
+    }
+    d->selectedItems.subtract(oldItems);
+    update();
+}
+
+int ListView::setSearchPattern(const std::string& pattern)
+{
+    if (!d->model)
+        return 0;
+
+    const std::string previousPattern = d->foldedSearchPattern;
+    d->searchPattern = pattern;
+    d->foldedSearchPattern.clear();
+    SearchTextArena::fold(pattern.data(), pattern.size(), &d->foldedSearchPattern);
+    d->updateSearchMatches(previousPattern);
+
+    if (!d->searchMatches.empty()) {
+        auto it = std::lower_bound(d->searchMatches.begin(), d->searchMatches.end(), d->currentItem);
+        setCurrentItem(it != d->searchMatches.end() ? *it : d->searchMatches.front());
+    }
+    return d->searchMatches.size();
+}
+
+const std::string& ListView::searchPattern() const
+{
+    return d->searchPattern;
+}
+
+bool ListView::jumpToNextSearchMatch()
+{
+    if (!d->model)
+        return false;
+
+    d->updateSearchMatches(d->foldedSearchPattern);
+    if (d->searchMatches.empty())
+        return false;
+
+    auto it = std::upper_bound(d->searchMatches.begin(), d->searchMatches.end(), d->currentItem);
+    setCurrentItem(it != d->searchMatches.end() ? *it : d->searchMatches.front());
+    return true;
+}
+
+bool ListView::jumpToPreviousSearchMatch()
+{
+    if (!d->model)
+        return false;
+
+    d->updateSearchMatches(d->foldedSearchPattern);
+    if (d->searchMatches.empty())
+        return false;
+
+    auto it = std::lower_bound(d->searchMatches.begin(), d->searchMatches.end(), d->currentItem);
+    setCurrentItem(it != d->searchMatches.begin() ? *(it - 1) : d->searchMatches.back());
+    return true;
+}
+
 void ListViewPrivate::disconnectModel()
 {
     for (auto& connection : modelConnections) {
         connection.disconnect();
     }
+    modelConnections.clear();
+}
+
+void ListViewPrivate::invalidateSearchIndex()
+{
+    searchIndex.clear();
+    searchMatches.clear();
+    searchMatchesValid = false;
+}
+
+void ListViewPrivate::updateSearchIndex(int first, int last)
+{
+    searchMatchesValid = false;
+    if (!searchIndex.isBuilt())
+        return;
+
+    if (first < 0 || last >= searchIndex.itemsCount() || last - first >= 64) {
+        searchIndex.clear();
+        return;
+    }
+
+    auto text = std::bind(&ListModel::searchText, model, std::placeholders::_1, std::placeholders::_2);
+    for (int item = first; item <= last; ++item) {
+        searchIndex.updateItem(item, text);
+    }
+}
+
+void ListViewPrivate::updateSearchMatches(const std::string& previousPattern)
+{
+    if (foldedSearchPattern.empty()) {
+        searchMatches.clear();
+        searchMatchesValid = true;
+        return;
+    }
+
+    if (!searchIndex.isBuilt() || searchIndex.hasManyUpdatedItems()) {
+        searchIndex.build(model->itemsCount(),
+                          std::bind(&ListModel::searchText, model, std::placeholders::_1, std::placeholders::_2));
+        searchMatchesValid = false;
+    }
+
+    if (searchMatchesValid && previousPattern == foldedSearchPattern)
+        return;
+
+    // Typing one more character only narrows the matches found so far
+    if (searchMatchesValid && !previousPattern.empty()
+        && foldedSearchPattern.compare(0, previousPattern.size(), previousPattern) == 0) {
+        std::vector<int> candidates;
+        candidates.swap(searchMatches);
+        searchIndex.find(foldedSearchPattern, candidates, &searchMatches);
+    } else {
+        searchIndex.find(foldedSearchPattern, &searchMatches);
+    }
+    searchMatchesValid = true;
 }
 
 void ListView::paint(const Rectangle& rect)
@@ -454,10 +645,7 @@ void ListView::paint(const Rectangle& rect)
 
         for (; item < lastItem; ++item) {
             int stateFlags = ListItemStateRegular;
-            const bool selected = std::binary_search(d->selectedItems.begin(),
-                                                     d->selectedItems.end(),
-                                                     item);
-            if (selected)
+            if (d->selectedItems.contains(item))
                 stateFlags |= ListItemStateSelected;
 
             if (item == d->currentItem && !d->currentItemHidden)
@@ -495,16 +683,16 @@ void ListView::keyPressedEvent(const KeyEvent& keyEvent)
 
     switch (keyEvent.key()) {
         case KeyEvent::KeyUp:
-            d->cursorUp();
+            d->cursorUp(keyEvent.repeatCount());
             break;
 
         case KeyEvent::KeyDown:
-            d->cursorDown();
+            d->cursorDown(keyEvent.repeatCount());
             break;
 
         case KeyEvent::KeyPageUp:
             if (d->currentItem != -1) {
-                int nc = d->currentItem - (lines() / 2);
+                int nc = d->currentItem - (lines() / 2) * keyEvent.repeatCount();
                 if (nc < 0)
                     nc = 0;
                 setCurrentItem(nc);
@@ -513,7 +701,7 @@ void ListView::keyPressedEvent(const KeyEvent& keyEvent)
 
         case KeyEvent::KeyPageDown:
             if (d->currentItem != -1) {
-                int nc = d->currentItem + (lines() / 2);
+                int nc = d->currentItem + (lines() / 2) * keyEvent.repeatCount();
                 if (nc >= d->model->itemsCount())
                     nc = d->model->itemsCount() - 1;
                 setCurrentItem(nc);
@@ -604,6 +792,11 @@ void ListView::mouseEvent(const MouseEvent& ev)
     }
 }
 
+bool ListView::handlesKeyRepeatCount() const
+{
+    return true;
+}
+
 void ListView::resize(const Size& size)
 {
     const int itemsCount = d->model ? d->model->itemsCount() : 0;
@@ -648,7 +841,7 @@ void ListViewPrivate::reset()
 {
     const int itemsCount = model ? model->itemsCount() : 0;
 
-    selectedItems.clear();
+    selectedItems.reset(itemsCount);
 
     if (itemsCount > 0) {
         changeCurrentItem(0);
@@ -676,105 +869,147 @@ void ListViewPrivate::itemsChanged(int first, int last)
 
 void ListViewPrivate::itemAdded()
 {
-    if (currentItem == -1)
+    itemsAdded(1);
+}
+
+void ListViewPrivate::itemsAdded(int count)
+{
+    if (count <= 0)
+        return;
+
+    if (currentItem == -1) {
         reset();
+    } else {
+        selectedItems.itemsInserted(selectedItems.itemsCount(), count);
+    }
 
+    // Only a viewport which is not filled up yet can show new items
     const int itemsCount = model->itemsCount();
-    if (q->lines() >= itemsCount) {
-        viewportEndItem = itemsCount;
-        itemsChanged(itemsCount - 1, itemsCount - 1);
+    if (viewportEndItem - viewportBeginItem < q->lines()) {
+        viewportEndItem = std::min(itemsCount, viewportBeginItem + q->lines());
+        itemsChanged(itemsCount - count, itemsCount - 1);
     }
 }
 
 void ListViewPrivate::itemInserted(int item)
 {
-    if (currentItem == -1)
+    itemsInserted(item, 1);
+}
+
+void ListViewPrivate::itemsInserted(int first, int count)
+{
+    if (count <= 0)
+        return;
+
+    if (currentItem == -1) {
         reset();
+        return;
+    }
 
     const int itemsCount = model->itemsCount();
-    if (q->lines() >= itemsCount)
-        viewportEndItem = itemsCount;
 
-    auto it = std::lower_bound(selectedItems.begin(), selectedItems.end(), item);
-    if (it != selectedItems.end()) {
-        std::for_each(it, selectedItems.end(), [](int& item){
-             ++item;
-        });
+    selectedItems.itemsInserted(first, count);
+
+    // Keep showing the same items if the new ones are above the viewport
+    if (first < viewportBeginItem) {
+        viewportBeginItem += count;
+        viewportEndItem += count;
+    } else if (viewportEndItem - viewportBeginItem < q->lines()) {
+        viewportEndItem = std::min(itemsCount, viewportBeginItem + q->lines());
     }
 
-    itemsChanged(item, itemsCount - 1);
+    if (first <= currentItem)
+        changeCurrentItem(currentItem + count);
+
+    itemsChanged(first, itemsCount - 1);
 }
 
 void ListViewPrivate::itemRemoved(int item)
 {
+    itemsRemoved(item, 1);
+}
+
+void ListViewPrivate::itemsRemoved(int first, int count)
+{
+    if (count <= 0)
+        return;
+
     const int itemsCount = model->itemsCount();
+    const int last = first + count;
 
-    if (currentItem > item || currentItem == itemsCount) {
-        changeCurrentItem(currentItem - 1);
-    } else if (currentItem == item) {
-        /* Current item number is not changed, but items are moving,
-    so information corresponding to the current item is changed */
-        changeCurrentItem(currentItem);
+    selectedItems.itemsRemoved(first, count);
+
+    if (currentItem >= last) {
+        changeCurrentItem(currentItem - count);
+    } else if (currentItem >= first) {
+        /* Current item was removed, the item following the removed ones
+    becomes current, or the last one if they were at the end */
+        changeCurrentItem(std::min(first, itemsCount - 1));
     }
 
-    auto it = std::lower_bound(selectedItems.begin(), selectedItems.end(), item);
-    if (it != selectedItems.end()) {
-        std::for_each(it, selectedItems.end(), [](int& item){
-             --item;
-        });
-        if (*it + 1 == item)
-            selectedItems.erase(it);
+    if (last <= viewportBeginItem) {
+        // Visible items stay the same, only their numbers are changed
+        viewportBeginItem -= count;
+        viewportEndItem -= count;
+        return;
     }
 
-    if (q->lines() > itemsCount) {
-        viewportEndItem = itemsCount;
-        q->update();
+    const int oldViewportBeginItem = viewportBeginItem;
+    if (itemsCount == 0) {
+        viewportBeginItem = -1;
+        viewportEndItem = -1;
     } else {
-        if (item < viewportBeginItem) {
-            --viewportBeginItem;
-            --viewportEndItem;
-        } else if (item < viewportEndItem) {
-            if (itemsCount >= viewportEndItem) {
-                itemsChanged(item, viewportEndItem - 1);
-        } else {
-                --viewportBeginItem;
-                --viewportEndItem;
-                q->update();
-            }
-        }
+        if (first < viewportBeginItem)
+            viewportBeginItem = first;
+        viewportEndItem = std::min(viewportBeginItem + q->lines(), itemsCount);
+        viewportBeginItem = std::max(viewportEndItem - q->lines(), 0);
+    }
+
+    if (viewportBeginItem != oldViewportBeginItem || viewportBeginItem == -1) {
+        q->update();
+    } else if (first < viewportBeginItem + q->lines()) {
+        const int yPos = std::max(first - viewportBeginItem, 0);
+        q->update(Rectangle(0, yPos, q->cols(), q->lines() - yPos));
     }
 }
 
 void ListViewPrivate::itemMoved(int from, int to)
 {
-    auto it = std::lower_bound(selectedItems.begin(), selectedItems.end(), from);
-    bool itemSelected = false;
-    if (it != selectedItems.end()) {
-        std::for_each(it, selectedItems.end(), [](int& item){
-             --item;
-        });
-        if (*it + 1 == from) {
-            selectedItems.erase(it);
-            itemSelected = true;
-        }
-    }
+    itemsMoved(from, 1, to);
+}
 
-    it = std::lower_bound(selectedItems.begin(), selectedItems.end(), to);
-    if (it != selectedItems.end()) {
-        std::for_each(it, selectedItems.end(), [](int& item){
-             ++item;
-        });
-    }
-    if (itemSelected)
-        selectedItems.insert(it, to);
+void ListViewPrivate::itemsMoved(int first, int count, int to)
+{
+    if (count <= 0 || first == to)
+        return;
 
-    q->update();
+    selectedItems.itemsMoved(first, count, to);
+
+    itemsChanged(std::min(first, to), std::max(first, to) + count - 1);
 }
 
 void ListViewPrivate::changeCurrentItem(int item)
 {
     currentItem = item;
     q->currentItemChanged(item);
+
+    // The first change of a burst settles at once, the rest only when
+    // no change follows for a while
+    if (currentItemSettleTimer.isActive()) {
+        currentItemSettlePending = true;
+    } else {
+        currentItemSettlePending = false;
+        q->currentItemSettled(item);
+    }
+    currentItemSettleTimer.startMs(150);
+}
+
+void ListViewPrivate::currentItemSettleTimeout()
+{
+    if (currentItemSettlePending) {
+        currentItemSettlePending = false;
+        q->currentItemSettled(currentItem);
+    }
 }
 
 void ListViewPrivate::scrollUp()
@@ -788,10 +1023,9 @@ void ListViewPrivate::scrollUp()
         if (currentItem < viewportBeginItem) {
             --viewportBeginItem;
             --viewportEndItem;
-            q->update();
-        } else {
-            q->update(Rectangle(0, itemLine(currentItem), q->cols(), 2));
+            q->scrollContent(-1);
         }
+        q->update(Rectangle(0, itemLine(currentItem), q->cols(), 2));
     }
 }
 
@@ -805,29 +1039,34 @@ void ListViewPrivate::scrollDown()
         if (currentItem >= viewportEndItem) {
             ++viewportBeginItem;
             ++viewportEndItem;
-            q->update();
-        } else {
-            q->update(Rectangle(0, itemLine(currentItem - 1), q->cols(), 2));
+            q->scrollContent(1);
         }
+        q->update(Rectangle(0, itemLine(currentItem - 1), q->cols(), 2));
     }
 }
 
-void ListViewPrivate::cursorUp()
+void ListViewPrivate::cursorUp(int count)
 {
     if (currentItem == -1)
         return;
 
+    // The first press only shows hidden current item
     if (currentItemHidden) {
         currentItemHidden = false;
         q->update(Rectangle(0, itemLine(currentItem), q->cols(), 1));
-    } else {
+        --count;
+    }
+
+    if (count == 1) {
         scrollUp();
+    } else if (count > 1) {
+        q->setCurrentItem(std::max(currentItem - count, 0));
     }
     if (hideCurrentItemSelectionInterval)
         hideSelectionTimer.start(hideCurrentItemSelectionInterval);
 }
 
-void ListViewPrivate::cursorDown()
+void ListViewPrivate::cursorDown(int count)
 {
     if (currentItem == -1)
         return;
@@ -835,8 +1074,13 @@ void ListViewPrivate::cursorDown()
     if (currentItemHidden) {
         currentItemHidden = false;
         q->update(Rectangle(0, itemLine(currentItem), q->cols(), 1));
-    } else {
+        --count;
+    }
+
+    if (count == 1) {
         scrollDown();
+    } else if (count > 1) {
+        q->setCurrentItem(std::min(currentItem + count, model->itemsCount() - 1));
     }
     if (hideCurrentItemSelectionInterval)
         hideSelectionTimer.start(hideCurrentItemSelectionInterval);
@@ -845,12 +1089,7 @@ void ListViewPrivate::cursorDown()
 void ListViewPrivate::toggleSelection(int item)
 {
     assert(item >= 0 && item < q->model()->itemsCount());
-    auto it = std::lower_bound(selectedItems.begin(), selectedItems.end(), item);
-    if (it != selectedItems.end() && *it == item) {
-        selectedItems.erase(it);
-    } else {
-        selectedItems.insert(it, item);
-    }
+    selectedItems.toggle(item);
     itemsChanged(item, item);
 }
 
@@ -859,9 +1098,9 @@ void ListViewPrivate::jumpToNextSelectedItem()
     if (selectedItems.empty())
         return;
 
-    auto it = std::upper_bound(selectedItems.begin(), selectedItems.end(), currentItem);
-    if (it != selectedItems.end()) {
-        q->setCurrentItem(*it);
+    const int item = selectedItems.next(currentItem);
+    if (item != -1) {
+        q->setCurrentItem(item);
     } else {
         q->showCurrentItem();
     }
@@ -872,9 +1111,9 @@ void ListViewPrivate::jumpToPreviousSelectedItem()
     if (selectedItems.empty())
         return;
 
-    auto it = std::lower_bound(selectedItems.begin(), selectedItems.end(), currentItem);
-    if (it != selectedItems.begin()) {
-        q->setCurrentItem(*(--it));
+    const int item = selectedItems.previous(currentItem);
+    if (item != -1) {
+        q->setCurrentItem(item);
     } else {
         q->showCurrentItem();
     }
@@ -19,6 +19,7 @@
 
 #include <vector>
 #include "Window.h"
+#include "ItemSelection.h"
 
 namespace ncxmms2 {
 
@@ -53,7 +54,7 @@ public:
     void setViewportFirstItem(int item);
 
     // Selection routines
-    const std::vector<int>& selectedItems() const; // Returns sorted list of selected items
+    const ItemSelection& selectedItems() const; // Iterates selected items in ascending order
     void selectItem(int item);
     void unselectItem(int item);
     bool isItemSelected(int item) const;
@@ -63,13 +64,29 @@ public:
     void unselectItemsByRegExp(const std::string& pattern);
     void selectItems(const std::function<bool (int)>& predicate);
     void unselectItems(const std::function<bool (int)>& predicate);
+    void selectItems(const std::vector<int>& items);   // items must be sorted
+    void unselectItems(const std::vector<int>& items); // items must be sorted
+
+    // Type-ahead search: items containing the pattern (case insensitive) in
+    // their ListModel::searchText are matched, current item jumps to the first
+    // match starting from itself. Returns the number of matches.
+    int setSearchPattern(const std::string& pattern);
+    const std::string& searchPattern() const;
+    // Both wrap around the list, return false if there are no matches
+    bool jumpToNextSearchMatch();
+    bool jumpToPreviousSearchMatch();
 
     virtual void keyPressedEvent(const KeyEvent& keyEvent);
     virtual void mouseEvent(const MouseEvent& ev);
+    virtual bool handlesKeyRepeatCount() const;
     virtual void resize(const Size& size);
 
     // Signals
     NCXMMS2_SIGNAL(currentItemChanged, int)
+    // Emitted at once for a single change of the current item, but only after
+    // the last one of a burst of changes (e.g. a key held down), suitable for
+    // expensive reactions like server queries
+    NCXMMS2_SIGNAL(currentItemSettled, int)
     NCXMMS2_SIGNAL(itemEntered, int)
 
 protected:
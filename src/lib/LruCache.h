@@ -0,0 +1,179 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <assert.h>
+
+#include "FlatHashMap.h"
+
+namespace ncxmms2 {
+
+/*   LruCache keeps at most capacity values by integer keys, inserting into a full
+ * cache evicts the least recently used value. Values live in one array and are
+ * linked into the recency list by indices. Slot of an evicted or removed value is
+ * handed out again with the old value in it, so values owning buffers (strings,
+ * vectors) reuse them instead of allocating anew.
+ */
+template <typename Key, typename T>
+class LruCache
+{
+public:
+    explicit LruCache(size_t capacity) :
+        m_capacity(capacity),
+        m_head(npos),
+        m_tail(npos),
+        m_free(npos)
+    {
+        assert(capacity > 0 && capacity < npos);
+    }
+
+    size_t size() const     {return m_index.size();}
+    size_t capacity() const {return m_capacity;}
+    bool empty() const      {return m_index.empty();}
+
+    // Returns value of the key and makes it the most recently used one,
+    // nullptr if there is no such key
+    T *find(Key key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return nullptr;
+
+        const uint32_t node = (*it).second;
+        moveToFront(node);
+        return &m_nodes[node].value;
+    }
+
+    // Returns the most recently used slot for the key. A new slot may hold
+    // a stale value of another key, caller is supposed to assign it.
+    T& insert(Key key)
+    {
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            const uint32_t node = (*it).second;
+            moveToFront(node);
+            return m_nodes[node].value;
+        }
+
+        uint32_t node;
+        if (m_free != npos) {
+            node = m_free;
+            m_free = m_nodes[node].next;
+        } else if (m_nodes.size() < m_capacity) {
+            node = m_nodes.size();
+            m_nodes.emplace_back();
+        } else {
+            node = m_tail;
+            unlink(node);
+            m_index.erase(m_nodes[node].key);
+        }
+
+        m_nodes[node].key = key;
+        m_index[key] = node;
+        pushFront(node);
+        return m_nodes[node].value;
+    }
+
+    bool remove(Key key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return false;
+
+        const uint32_t node = (*it).second;
+        m_index.erase(it);
+        unlink(node);
+        m_nodes[node].next = m_free;
+        m_free = node;
+        return true;
+    }
+
+    void clear()
+    {
+        m_index.clear();
+        m_head = m_tail = npos;
+        m_free = npos;
+        for (size_t i = m_nodes.size(); i-- > 0;) {
+            m_nodes[i].next = m_free;
+            m_free = i;
+        }
+    }
+
+private:
+    static const uint32_t npos = UINT32_MAX;
+
+    struct Node
+    {
+        Node() : prev(npos), next(npos) {}
+
+        Key key;
+        T value;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    size_t m_capacity;
+    std::vector<Node> m_nodes;
+    FlatHashMap<Key, uint32_t> m_index;
+    uint32_t m_head; // The most recently used
+    uint32_t m_tail; // The least recently used
+    uint32_t m_free; // Free slots, linked by next
+
+    void unlink(uint32_t node)
+    {
+        Node& n = m_nodes[node];
+        if (n.prev != npos)
+            m_nodes[n.prev].next = n.next;
+        else
+            m_head = n.next;
+
+        if (n.next != npos)
+            m_nodes[n.next].prev = n.prev;
+        else
+            m_tail = n.prev;
+
+        n.prev = n.next = npos;
+    }
+
+    void pushFront(uint32_t node)
+    {
+        Node& n = m_nodes[node];
+        n.prev = npos;
+        n.next = m_head;
+        if (m_head != npos)
+            m_nodes[m_head].prev = node;
+        m_head = node;
+        if (m_tail == npos)
+            m_tail = node;
+    }
+
+    void moveToFront(uint32_t node)
+    {
+        if (node != m_head) {
+            unlink(node);
+            pushFront(node);
+        }
+    }
+};
+
+} // ncxmms2
+
+#endif // LRUCACHE_H
@@ -245,23 +245,33 @@ void Painter::squeezedPrint(const std::string& str, std::string::size_type maxLe
     if (str.size() <= maxLength) {
         waddstr(d->cursesWin, str.c_str());
     } else {
-        const char *c_str = str.c_str();
-        while (maxLength && *c_str) {
-            c_str = g_utf8_next_char(c_str);
-            --maxLength;
-        }
+        std::string squeezed(str);
+        squeeze(&squeezed, maxLength);
+        waddstr(d->cursesWin, squeezed.c_str());
+    }
+}
+
+void Painter::squeeze(std::string *str, std::string::size_type maxLength)
+{
+    if (str->size() <= maxLength)
+        return;
+
+    const char *c_str = str->c_str();
+    while (maxLength && *c_str) {
+        c_str = g_utf8_next_char(c_str);
+        --maxLength;
+    }
 
-       if (!maxLength && *c_str) {
-            for (int i = 0; i < 3; ++i) {
-                c_str = g_utf8_find_prev_char(str.c_str(), c_str);
-                if (!c_str)
-                    return;
+    if (!maxLength && *c_str) {
+        for (int i = 0; i < 3; ++i) {
+            c_str = g_utf8_find_prev_char(str->c_str(), c_str);
+            if (!c_str) {
+                str->clear();
+                return;
             }
-            waddnstr(d->cursesWin, str.c_str(), c_str - str.c_str());
-            waddstr(d->cursesWin, "...");
-        } else {
-            waddstr(d->cursesWin, str.c_str());
         }
+        str->resize(c_str - str->c_str());
+        str->append("...");
     }
 }
 
@@ -321,7 +331,10 @@ void Painter::drawBox(int vSymbol, int hSymbol)
 
 void Painter::flush()
 {
-    wrefresh(d->cursesWin);
+    // Only the virtual screen is updated here, the terminal is updated once
+    // per main loop iteration, see Application::scheduleScreenUpdate.
+    wnoutrefresh(d->cursesWin);
+    Application::scheduleScreenUpdate();
 }
 
 int Painter::x() const
@@ -61,6 +61,8 @@ public:
     void printString(const std::u32string& str);
     void printString(const char32_t *str, size_t maxLength);
     void squeezedPrint(const std::string& str, std::string::size_type maxLength);
+    // Shortens str to what squeezedPrint prints for it
+    static void squeeze(std::string *str, std::string::size_type maxLength);
 
     void drawHLine(int startX, int startY, int length, int symbol = 0);
     void drawVLine(int startX, int startY, int length, int symbol = 0);
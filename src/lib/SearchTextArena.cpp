@@ -0,0 +1,104 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#include <cstring>
+#include <glib.h>
+
+#include "SearchTextArena.h"
+
+using namespace ncxmms2;
+
+bool SearchTextArena::find(int key, Span *span) const
+{
+    auto it = m_spans.find(key);
+    if (it == m_spans.end())
+        return false;
+    *span = (*it).second;
+    return true;
+}
+
+void SearchTextArena::insert(int key, const char *text, size_t size)
+{
+    remove(key);
+    if (m_garbage > m_buffer.size() / 2)
+        compact();
+
+    Span span;
+    span.offset = m_buffer.size();
+    const char *end = text + size;
+    while (text < end) {
+        const char *strEnd = static_cast<const char*>(std::memchr(text, '\0', end - text));
+        if (!strEnd)
+            strEnd = end;
+        fold(text, strEnd - text, &m_buffer);
+        m_buffer.push_back('\0');
+        text = strEnd < end ? strEnd + 1 : end;
+    }
+    span.size = m_buffer.size() - span.offset;
+    m_spans[key] = span;
+}
+
+void SearchTextArena::remove(int key)
+{
+    auto it = m_spans.find(key);
+    if (it != m_spans.end()) {
+        m_garbage += (*it).second.size;
+        m_spans.erase(it);
+    }
+}
+
+void SearchTextArena::clear()
+{
+    m_buffer.clear();
+    m_spans.clear();
+    m_garbage = 0;
+}
+
+void SearchTextArena::fold(const char *str, size_t size, std::string *result)
+{
+    // Most of tags are ASCII, they are folded without allocations
+    const size_t begin = result->size();
+    result->append(str, size);
+    bool ascii = true;
+    for (size_t i = begin; i < result->size(); ++i) {
+        char& ch = (*result)[i];
+        if ((unsigned char)ch >= 0x80) {
+            ascii = false;
+            break;
+        }
+        ch = g_ascii_tolower(ch);
+    }
+    if (ascii)
+        return;
+
+    result->resize(begin);
+    gchar *folded = g_utf8_casefold(str, size);
+    result->append(folded);
+    g_free(folded);
+}
+
+void SearchTextArena::compact()
+{
+    std::string buffer;
+    buffer.reserve(m_buffer.size() - m_garbage);
+    for (auto& value : m_spans) {
+        Span& span = value.second;
+        const uint32_t offset = buffer.size();
+        buffer.append(m_buffer, span.offset, span.size);
+        span.offset = offset;
+    }
+    m_buffer.swap(buffer);
+    m_garbage = 0;
+}
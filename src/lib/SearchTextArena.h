@@ -0,0 +1,70 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#ifndef SEARCHTEXTARENA_H
+#define SEARCHTEXTARENA_H
+
+#include <string>
+#include <cstdint>
+
+#include "FlatHashMap.h"
+
+namespace ncxmms2 {
+
+/*   SearchTextArena keeps case folded search texts of items (e.g. songs keyed by
+ * medialib id) in one contiguous buffer, so searching through all of them is
+ * a linear scan over memory instead of formatting and folding every item again.
+ *   Text of an item is a sequence of strings, each one is terminated by '\0'.
+ * Replaced and removed texts are left in the buffer as garbage until it takes
+ * more than half of the buffer, then the buffer is compacted, so offsets of
+ * texts are valid only until the next insertion.
+ */
+class SearchTextArena
+{
+public:
+    struct Span
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    SearchTextArena() : m_garbage(0) {}
+
+    size_t size() const {return m_spans.size();}
+    bool contains(int key) const {return m_spans.count(key);}
+    bool find(int key, Span *span) const;
+
+    // Text is case folded before it is stored, a string of text which
+    // is not terminated by '\0' gets terminated here
+    void insert(int key, const char *text, size_t size);
+    void insert(int key, const std::string& text) {insert(key, text.data(), text.size());}
+    void remove(int key);
+    void clear();
+
+    const std::string& buffer() const {return m_buffer;}
+
+    // Appends case folded str to result
+    static void fold(const char *str, size_t size, std::string *result);
+
+private:
+    std::string m_buffer;
+    FlatHashMap<int, Span> m_spans;
+    size_t m_garbage;
+
+    void compact();
+};
+} // ncxmms2
+
+#endif // SEARCHTEXTARENA_H
@@ -0,0 +1,105 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <cstring>
+#include "StringPool.h"
+
+using namespace ncxmms2;
+
+StringPool::StringPool()
+{
+    m_entries.push_back(Entry{std::string(), 0});
+}
+
+StringPool::Handle StringPool::intern(const char *str)
+{
+    return intern(str, std::strlen(str));
+}
+
+StringPool::Handle StringPool::intern(const char *str, size_t size)
+{
+    if (!size)
+        return 0;
+
+    StringPool& pool = instance();
+
+    auto it = pool.m_handles.find(Key{str, size});
+    if (it != pool.m_handles.end()) {
+        ++pool.m_entries[it->second].refs;
+        return it->second;
+    }
+
+    Handle handle;
+    if (!pool.m_freeHandles.empty()) {
+        handle = pool.m_freeHandles.back();
+        pool.m_freeHandles.pop_back();
+        pool.m_entries[handle].str.assign(str, size);
+        pool.m_entries[handle].refs = 1;
+    } else {
+        handle = pool.m_entries.size();
+        pool.m_entries.push_back(Entry{std::string(str, size), 1});
+    }
+
+    const std::string& stored = pool.m_entries[handle].str;
+    pool.m_handles.insert(std::make_pair(Key{stored.data(), stored.size()}, handle));
+    return handle;
+}
+
+void StringPool::addRef(Handle handle)
+{
+    if (handle) {
+        StringPool& pool = instance();
+        assert(handle < pool.m_entries.size() && pool.m_entries[handle].refs > 0);
+        ++pool.m_entries[handle].refs;
+    }
+}
+
+void StringPool::release(Handle handle)
+{
+    if (!handle)
+        return;
+
+    StringPool& pool = instance();
+    assert(handle < pool.m_entries.size() && pool.m_entries[handle].refs > 0);
+    Entry& entry = pool.m_entries[handle];
+    if (--entry.refs == 0) {
+        pool.m_handles.erase(Key{entry.str.data(), entry.str.size()});
+        // Free the memory, not just clear the string
+        std::string().swap(entry.str);
+        pool.m_freeHandles.push_back(handle);
+    }
+}
+
+size_t StringPool::size()
+{
+    return instance().m_handles.size();
+}
+
+size_t StringPool::KeyHash::operator()(const Key& key) const
+{
+    // FNV-1a
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < key.size; ++i) {
+        hash ^= (unsigned char)key.data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool StringPool::KeyEqual::operator()(const Key& lhs, const Key& rhs) const
+{
+    return lhs.size == rhs.size && std::memcmp(lhs.data, rhs.data, lhs.size) == 0;
+}
@@ -0,0 +1,167 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <assert.h>
+
+namespace ncxmms2 {
+
+/*   StringPool keeps a single copy of every interned string, strings are referred
+ * by 32-bit handles. Handles are reference counted, string is freed when the last
+ * reference is released and its slot is reused later. Handle 0 always refers to
+ * an empty string and doesn't need to be released.
+ *   Strings are never moved in memory, so references returned by get stay valid
+ * while the handle is referenced.
+ */
+class StringPool
+{
+public:
+    typedef uint32_t Handle;
+
+    static Handle intern(const char *str);
+    static Handle intern(const char *str, size_t size);
+    static Handle intern(const std::string& str) {return intern(str.c_str(), str.size());}
+
+    static void addRef(Handle handle);
+    static void release(Handle handle);
+
+    static const std::string& get(Handle handle)
+    {
+        const StringPool& pool = instance();
+        assert(handle < pool.m_entries.size());
+        return pool.m_entries[handle].str;
+    }
+
+    // Number of strings currently stored, not counting the empty one
+    static size_t size();
+
+private:
+    StringPool();
+    StringPool(const StringPool&);
+    StringPool& operator=(const StringPool&);
+
+    static StringPool& instance()
+    {
+        static StringPool inst;
+        return inst;
+    }
+
+    struct Entry
+    {
+        std::string str;
+        uint32_t refs;
+    };
+
+    struct Key
+    {
+        const char *data;
+        size_t size;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct KeyEqual
+    {
+        bool operator()(const Key& lhs, const Key& rhs) const;
+    };
+
+    std::deque<Entry> m_entries; // Deque doesn't move elements on growth
+    std::vector<Handle> m_freeHandles;
+    std::unordered_map<Key, Handle, KeyHash, KeyEqual> m_handles;
+};
+
+/*   PooledString owns a reference to a string interned in StringPool, so rows of
+ * models can hold strings without allocating a copy for each of them.
+ */
+class PooledString
+{
+public:
+    PooledString() : m_handle(0) {}
+    explicit PooledString(const char *str) : m_handle(StringPool::intern(str)) {}
+    PooledString(const char *str, size_t size) : m_handle(StringPool::intern(str, size)) {}
+    explicit PooledString(const std::string& str) : m_handle(StringPool::intern(str)) {}
+    ~PooledString() {StringPool::release(m_handle);}
+
+    PooledString(const PooledString& other) :
+        m_handle(other.m_handle)
+    {
+        StringPool::addRef(m_handle);
+    }
+
+    PooledString& operator=(const PooledString& other)
+    {
+        StringPool::addRef(other.m_handle);
+        StringPool::release(m_handle);
+        m_handle = other.m_handle;
+        return *this;
+    }
+
+    PooledString(PooledString&& other) noexcept :
+        m_handle(other.m_handle)
+    {
+        other.m_handle = 0;
+    }
+
+    PooledString& operator=(PooledString&& other) noexcept
+    {
+        if (this != &other) {
+            StringPool::release(m_handle);
+            m_handle = other.m_handle;
+            other.m_handle = 0;
+        }
+        return *this;
+    }
+
+    // Takes a new reference to already interned string
+    static PooledString fromHandle(StringPool::Handle handle)
+    {
+        StringPool::addRef(handle);
+        PooledString result;
+        result.m_handle = handle;
+        return result;
+    }
+
+    const std::string& str() const    {return StringPool::get(m_handle);}
+    StringPool::Handle handle() const {return m_handle;}
+    bool empty() const                {return !m_handle;}
+
+    // Equal strings are interned into the same handle
+    friend bool operator==(const PooledString& lhs, const PooledString& rhs)
+    {
+        return lhs.m_handle == rhs.m_handle;
+    }
+
+    friend bool operator!=(const PooledString& lhs, const PooledString& rhs)
+    {
+        return lhs.m_handle != rhs.m_handle;
+    }
+
+private:
+    StringPool::Handle m_handle;
+};
+} // ncxmms2
+
+#endif // STRINGPOOL_H
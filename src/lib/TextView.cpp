@@ -173,17 +173,25 @@ void TextView::setText(const std::string& text)
 
 void TextView::keyPressedEvent(const KeyEvent& keyEvent)
 {
-    switch (keyEvent.key()) {
-        case KeyEvent::KeyUp:       d->scrollUp();       break;
-        case KeyEvent::KeyDown:     d->scrollDown();     break;
-        case KeyEvent::KeyHome:     d->scrollHome();     break;
-        case KeyEvent::KeyEnd:      d->scrollEnd();      break;
-        case KeyEvent::KeyPageUp:   d->scrollPageUp();   break;
-        case KeyEvent::KeyPageDown: d->scrollPageDown(); break;
-        default: break;
+    // Scrolling only damages lines, they are painted once after all steps
+    for (int i = 0; i < keyEvent.repeatCount(); ++i) {
+        switch (keyEvent.key()) {
+            case KeyEvent::KeyUp:       d->scrollUp();       break;
+            case KeyEvent::KeyDown:     d->scrollDown();     break;
+            case KeyEvent::KeyHome:     d->scrollHome();     break;
+            case KeyEvent::KeyEnd:      d->scrollEnd();      break;
+            case KeyEvent::KeyPageUp:   d->scrollPageUp();   break;
+            case KeyEvent::KeyPageDown: d->scrollPageDown(); break;
+            default: break;
+        }
     }
 }
 
+bool TextView::handlesKeyRepeatCount() const
+{
+    return true;
+}
+
 void TextView::mouseEvent(const MouseEvent& ev)
 {
     if (ev.type() != MouseEvent::Type::ButtonPress)
@@ -44,6 +44,7 @@ public:
     void setText(const std::string& text);
     
     virtual void keyPressedEvent(const KeyEvent& keyEvent);
+    virtual bool handlesKeyRepeatCount() const;
     virtual void mouseEvent(const MouseEvent& ev);
     virtual void resize(const Size& size);
 
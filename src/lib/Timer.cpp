@@ -61,6 +61,11 @@ void Timer::stop()
     }
 }
 
+bool Timer::isActive() const
+{
+    return d->id != 0;
+}
+
 void Timer::setSingleShot(bool singleShot)
 {
     d->isSingleShot = singleShot;
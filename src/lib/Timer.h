@@ -32,6 +32,7 @@ public:
     void start(unsigned int sec);
     void startMs(unsigned int msec);
     void stop();
+    bool isActive() const;
 
     void setSingleShot(bool singleShot);
     bool isSingleShot() const;
@@ -0,0 +1,220 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#include <algorithm>
+#include <iterator>
+
+#include "TrigramIndex.h"
+
+using namespace ncxmms2;
+
+TrigramIndex::TrigramIndex() :
+    m_built(false)
+{
+
+}
+
+void TrigramIndex::build(int itemsCount, const TextFunction& text)
+{
+    clear();
+
+    m_offsets.reserve(itemsCount + 1);
+    m_offsets.push_back(0);
+    // Every text is terminated by '\0', so that matches never span two items
+    for (int item = 0; item < itemsCount; ++item) {
+        text(item, &m_texts);
+        m_texts.push_back('\0');
+        m_offsets.push_back(m_texts.size());
+    }
+
+    // Posting lists are laid out in one array. The first pass counts items
+    // of every trigram, the second one fills the lists, items are visited
+    // in order, so every list comes out sorted.
+    std::vector<uint32_t> itemTrigrams;
+    std::vector<uint32_t> counts;
+    for (int item = 0; item < itemsCount; ++item) {
+        trigrams(m_texts.data() + m_offsets[item], m_offsets[item + 1] - m_offsets[item], &itemTrigrams);
+        for (uint32_t trigram : itemTrigrams) {
+            auto it = m_trigrams.find(trigram);
+            if (it == m_trigrams.end()) {
+                m_trigrams[trigram] = counts.size();
+                counts.push_back(1);
+            } else {
+                ++counts[(*it).second];
+            }
+        }
+    }
+
+    m_postingOffsets.resize(counts.size() + 1);
+    m_postingOffsets[0] = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        m_postingOffsets[i + 1] = m_postingOffsets[i] + counts[i];
+    }
+    m_postings.resize(m_postingOffsets.back());
+
+    std::vector<uint32_t> fill(m_postingOffsets.begin(), m_postingOffsets.end() - 1);
+    for (int item = 0; item < itemsCount; ++item) {
+        trigrams(m_texts.data() + m_offsets[item], m_offsets[item + 1] - m_offsets[item], &itemTrigrams);
+        for (uint32_t trigram : itemTrigrams) {
+            m_postings[fill[(*m_trigrams.find(trigram)).second]++] = item;
+        }
+    }
+
+    m_built = true;
+}
+
+void TrigramIndex::clear()
+{
+    m_built = false;
+    m_texts.clear();
+    m_offsets.clear();
+    m_updatedItems.clear();
+    m_trigrams.clear();
+    m_postingOffsets.clear();
+    m_postings.clear();
+}
+
+void TrigramIndex::updateItem(int item, const TextFunction& text)
+{
+    if (item < 0 || item >= itemsCount())
+        return;
+
+    Span span;
+    span.begin = m_texts.size();
+    text(item, &m_texts);
+    m_texts.push_back('\0');
+    span.end = m_texts.size();
+    m_updatedItems[item] = span;
+}
+
+void TrigramIndex::find(const std::string& needle, std::vector<int> *items) const
+{
+    items->clear();
+
+    std::vector<uint32_t> needleTrigrams;
+    trigrams(needle.data(), needle.size(), &needleTrigrams);
+    if (needleTrigrams.empty()) {
+        scan(needle, items);
+        return;
+    }
+
+    // Intersection starts with the shortest list, so it never grows
+    std::vector<std::pair<const int*, const int*>> lists;
+    for (uint32_t trigram : needleTrigrams) {
+        auto it = m_trigrams.find(trigram);
+        if (it == m_trigrams.end()) {
+            lists.clear();
+            break;
+        }
+        const uint32_t index = (*it).second;
+        lists.push_back(std::make_pair(m_postings.data() + m_postingOffsets[index],
+                                       m_postings.data() + m_postingOffsets[index + 1]));
+    }
+    std::sort(lists.begin(), lists.end(), [](const std::pair<const int*, const int*>& left,
+                                             const std::pair<const int*, const int*>& right){
+        return left.second - left.first < right.second - right.first;
+    });
+
+    std::vector<int> candidates;
+    if (!lists.empty()) {
+        candidates.assign(lists[0].first, lists[0].second);
+        std::vector<int> intersection;
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+            intersection.clear();
+            std::set_intersection(candidates.begin(), candidates.end(),
+                                  lists[i].first, lists[i].second,
+                                  std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+    }
+
+    if (!m_updatedItems.empty()) {
+        std::vector<int> updatedItems;
+        for (const auto& value : m_updatedItems) {
+            updatedItems.push_back(value.first);
+        }
+        std::sort(updatedItems.begin(), updatedItems.end());
+        std::vector<int> merged;
+        std::set_union(candidates.begin(), candidates.end(),
+                       updatedItems.begin(), updatedItems.end(),
+                       std::back_inserter(merged));
+        candidates.swap(merged);
+    }
+
+    find(needle, candidates, items);
+}
+
+void TrigramIndex::find(const std::string& needle, const std::vector<int>& candidates, std::vector<int> *items) const
+{
+    items->clear();
+    for (int item : candidates) {
+        if (item >= 0 && item < itemsCount() && contains(item, needle))
+            items->push_back(item);
+    }
+}
+
+TrigramIndex::Span TrigramIndex::itemSpan(int item) const
+{
+    auto it = m_updatedItems.find(item);
+    if (it != m_updatedItems.end())
+        return (*it).second;
+    return Span{m_offsets[item], m_offsets[item + 1]};
+}
+
+bool TrigramIndex::contains(int item, const std::string& needle) const
+{
+    const Span span = itemSpan(item);
+    const char *begin = m_texts.data() + span.begin;
+    const char *end = m_texts.data() + span.end;
+    return std::search(begin, end, needle.begin(), needle.end()) != end;
+}
+
+void TrigramIndex::scan(const std::string& needle, std::vector<int> *items) const
+{
+    // Whole buffer is scanned at once, every hit is mapped to the item by its
+    // offset. Updated items are checked separately, as their old texts are
+    // still in place and new ones are at the end of the buffer.
+    const size_t textsEnd = m_offsets.empty() ? 0 : m_offsets.back();
+    size_t pos = needle.empty() ? 0 : m_texts.find(needle);
+    while (pos < textsEnd) {
+        const int item = std::upper_bound(m_offsets.begin(), m_offsets.end(), pos) - m_offsets.begin() - 1;
+        if (!m_updatedItems.count(item))
+            items->push_back(item);
+        pos = needle.empty() ? m_offsets[item + 1] : m_texts.find(needle, m_offsets[item + 1]);
+    }
+
+    if (!m_updatedItems.empty()) {
+        for (const auto& value : m_updatedItems) {
+            if (contains(value.first, needle))
+                items->push_back(value.first);
+        }
+        std::sort(items->begin(), items->end());
+    }
+}
+
+void TrigramIndex::trigrams(const char *text, size_t size, std::vector<uint32_t> *result)
+{
+    result->clear();
+    for (size_t i = 0; i + 3 <= size; ++i) {
+        const unsigned char a = text[i];
+        const unsigned char b = text[i + 1];
+        const unsigned char c = text[i + 2];
+        if (!a || !b || !c)
+            continue;
+        result->push_back((uint32_t)a << 16 | (uint32_t)b << 8 | c);
+    }
+    std::sort(result->begin(), result->end());
+    result->erase(std::unique(result->begin(), result->end()), result->end());
+}
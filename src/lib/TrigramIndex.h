@@ -0,0 +1,87 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#include "FlatHashMap.h"
+
+namespace ncxmms2 {
+
+/*   TrigramIndex keeps case folded texts of list items in one buffer together
+ * with posting lists of items for every trigram (three consecutive bytes) of
+ * the texts. Items containing a substring are found by intersecting posting
+ * lists of trigrams of the substring, so only a few candidates are compared
+ * with the substring instead of all items. Needles shorter than three bytes
+ * are looked for with a plain scan of the buffer.
+ *   Text of an item may consist of several strings separated by '\0', matches
+ * across separators are not found.
+ *   Changed texts of single items are updated without rebuilding the index,
+ * such items are compared with every needle until the next rebuild.
+ */
+class TrigramIndex
+{
+public:
+    TrigramIndex();
+
+    // Text function appends case folded text of the item
+    typedef std::function<void (int, std::string*)> TextFunction;
+    void build(int itemsCount, const TextFunction& text);
+    void clear();
+
+    bool isBuilt() const   {return m_built;}
+    int itemsCount() const {return m_offsets.empty() ? 0 : m_offsets.size() - 1;}
+
+    void updateItem(int item, const TextFunction& text);
+    // Index is worth rebuilding when many items are updated
+    bool hasManyUpdatedItems() const {return m_updatedItems.size() > 64 + (size_t)itemsCount() / 16;}
+
+    // Sorted list of items containing needle, needle must be case folded
+    void find(const std::string& needle, std::vector<int> *items) const;
+    // The same, but only items of the sorted candidates list are checked,
+    // e.g. items found for a prefix of needle
+    void find(const std::string& needle, const std::vector<int>& candidates, std::vector<int> *items) const;
+
+private:
+    bool m_built;
+    std::string m_texts;
+    std::vector<uint32_t> m_offsets; // Text of item i is in [m_offsets[i], m_offsets[i + 1])
+
+    // Updated texts are appended to m_texts, postings of such items may be wrong
+    struct Span
+    {
+        uint32_t begin;
+        uint32_t end;
+    };
+    FlatHashMap<int, Span> m_updatedItems;
+
+    FlatHashMap<uint32_t, uint32_t> m_trigrams; // Trigram -> index in m_postingOffsets
+    std::vector<uint32_t> m_postingOffsets;
+    std::vector<int> m_postings;
+
+    Span itemSpan(int item) const;
+    bool contains(int item, const std::string& needle) const;
+    void scan(const std::string& needle, std::vector<int> *items) const;
+    // Sorted distinct trigrams of text, the ones containing '\0' are skipped
+    static void trigrams(const char *text, size_t size, std::vector<uint32_t> *result);
+};
+} // ncxmms2
+
+#endif // TRIGRAMINDEX_H
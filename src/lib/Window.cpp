@@ -15,6 +15,7 @@
  */
 
 #include <algorithm>
+#include <cstdlib>
 #include <curses.h>
 #include <assert.h>
 
@@ -29,6 +30,7 @@
 using namespace ncxmms2;
 
 bool WindowPrivate::doingResize = false;
+std::vector<Window*> WindowPrivate::damagedWindows;
 
 Window::Window(const Rectangle& rect, Window *parent) :
     Object(parent),
@@ -181,6 +183,7 @@ void Window::hide()
 void Window::show()
 {
     d->isVisible = true;
+    d->damagedLines.clear();
     paint(Rectangle(0, 0, cols(), lines()));
     showEvent();
 }
@@ -290,6 +293,11 @@ void Window::mouseEvent(const MouseEvent& ev)
     }
 }
 
+bool Window::handlesKeyRepeatCount() const
+{
+    return false;
+}
+
 void Window::resize(const Size& size)
 {
     d->checkSize(size);
@@ -326,8 +334,54 @@ void Window::update()
 
 void Window::update(const Rectangle& rect)
 {
-    if (d->isVisible)
-        paint(rect);
+    // Painting is deferred till the end of the current main loop iteration,
+    // so lines invalidated several times are painted only once.
+    if (!d->isVisible)
+        return;
+
+    const int begin = std::max(rect.y(), 0);
+    const int end = std::min(rect.y() + rect.lines(), lines());
+    if (begin >= end)
+        return;
+
+    if (d->damagedLines.empty()) {
+        auto& windows = WindowPrivate::damagedWindows;
+        if (std::find(windows.begin(), windows.end(), this) == windows.end())
+            windows.push_back(this);
+    }
+    d->addDamagedLines(begin, end);
+    Application::scheduleScreenUpdate();
+}
+
+void Window::scrollContent(int count)
+{
+    if (!d->isVisible || count == 0)
+        return;
+
+    if (std::abs(count) >= lines()) {
+        update();
+        return;
+    }
+
+    // Window content is shifted by curses, with idlok the terminal may do the
+    // same by its insert/delete line capabilities instead of redrawing lines
+    idlok(d->cursesWin, TRUE);
+    scrollok(d->cursesWin, TRUE);
+    wscrl(d->cursesWin, count);
+    scrollok(d->cursesWin, FALSE);
+
+    // Lines damaged before are not painted yet, they are shifted with content
+    std::vector<std::pair<int, int>> spans;
+    spans.swap(d->damagedLines);
+    for (const auto& span : spans) {
+        update(Rectangle(0, span.first - count, cols(), span.second - span.first));
+    }
+
+    if (count > 0) {
+        update(Rectangle(0, lines() - count, cols(), count));
+    } else {
+        update(Rectangle(0, 0, cols(), -count));
+    }
 }
 
 Window::~Window()
@@ -343,6 +397,10 @@ Window::~Window()
         win->d->parent = nullptr;
     }
 
+    auto& damagedWindows = WindowPrivate::damagedWindows;
+    damagedWindows.erase(std::remove(damagedWindows.begin(), damagedWindows.end(), this),
+                         damagedWindows.end());
+
     if (d->cursesWin)
         delwin(d->cursesWin);
 }
@@ -363,3 +421,34 @@ void WindowPrivate::checkSize(const Size& size)
         throw DesiredWindowSizeTooBig();
     }
 }
+
+void WindowPrivate::addDamagedLines(int begin, int end)
+{
+    typedef std::pair<int, int> Span;
+    auto first = std::lower_bound(damagedLines.begin(), damagedLines.end(), begin,
+                                  [](const Span& span, int line) {return span.second < line;});
+    auto last = first;
+    for (; last != damagedLines.end() && last->first <= end; ++last) {
+        begin = std::min(begin, last->first);
+        end = std::max(end, last->second);
+    }
+    first = damagedLines.erase(first, last);
+    damagedLines.insert(first, Span(begin, end));
+}
+
+void WindowPrivate::paintDamagedWindows()
+{
+    std::vector<Window*> windows;
+    windows.swap(damagedWindows);
+
+    for (Window *win : windows) {
+        std::vector<std::pair<int, int>> spans;
+        spans.swap(win->d->damagedLines);
+        if (!win->d->isVisible)
+            continue;
+
+        for (const auto& span : spans) {
+            win->paint(Rectangle(0, span.first, win->cols(), span.second - span.first));
+        }
+    }
+}
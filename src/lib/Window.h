@@ -40,6 +40,10 @@ public:
 
     virtual void keyPressedEvent(const KeyEvent& keyEvent);
     virtual void mouseEvent(const MouseEvent& ev);
+    // When the focused window handles KeyEvent::repeatCount, a run of the same
+    // navigation key read at once is sent to it as one event, otherwise every
+    // press is sent separately
+    virtual bool handlesKeyRepeatCount() const;
 
     int cols() const;
     int lines() const;
@@ -100,11 +104,15 @@ protected:
 
     void update();
     void update(const Rectangle& rect);
+    // Shifts painted content up (count > 0) or down (count < 0) and updates
+    // only lines which come into view
+    void scrollContent(int count);
 
 private:
     Window(const Window& other);
     Window& operator=(const Window& other);
     std::unique_ptr<WindowPrivate> d;
+    friend class WindowPrivate;
     friend class Painter;
     friend class Application;
 };
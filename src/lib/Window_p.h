@@ -19,6 +19,7 @@
 
 #include <curses.h>
 #include <vector>
+#include <utility>
 #include <limits>
 #include <memory>
 
@@ -68,6 +69,14 @@ public:
 
     static bool doingResize;
     void checkSize(const Size& size);
+
+    // Damaged lines are kept as sorted disjoint [begin, end) spans and
+    // painted once per frame, see paintDamagedWindows
+    std::vector<std::pair<int, int>> damagedLines;
+    void addDamagedLines(int begin, int end);
+
+    static std::vector<Window*> damagedWindows;
+    static void paintDamagedWindows();
 };
 } // ncxmms2
 
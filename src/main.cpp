@@ -20,6 +20,7 @@
 
 #include "config.h"
 #include "Settings.h"
+#include "SongInfoCache.h"
 #include "CommandLineOptions.h"
 #include "MainWindow/MainWindow.h"
 #include "XmmsUtils/Client.h"
@@ -56,6 +57,14 @@ int main(int argc, char **argv)
         std::cerr << "Disconnected!" << std::endl;
     });
     
+    // Saves the cache however main is left
+    ncxmms2::SongInfoCacheCloser songInfoCacheCloser;
+    if (ncxmms2::Settings::value("General", "songInfoCache", false)) {
+        const std::string songInfoCacheFilePath =
+                std::string(g_get_user_config_dir()).append("/ncxmms2/songinfo.cache");
+        ncxmms2::SongInfoCache::open(songInfoCacheFilePath, ipcPath);
+    }
+    
     const bool mouseEnable = ncxmms2::Settings::value("General", "mouseEnable", true);
     const int mouseDoubleClickInterval = ncxmms2::Settings::value("General",
                                                                   "mouseDoubleClickInterval", 300);
@@ -0,0 +1,353 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "gtest/gtest.h"
+
+#include "lib/ChunkedVector.h"
+
+using namespace ncxmms2;
+
+namespace {
+
+template <typename T, size_t ChunkSize, typename Weight>
+void expectEqual(const std::vector<T>& expected, const ChunkedVector<T, ChunkSize, Weight>& v)
+{
+    ASSERT_EQ(expected.size(), v.size());
+    EXPECT_EQ(expected, v.toVector());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(expected[i], v[i]);
+    }
+}
+
+template <typename F>
+double measureMs(F f)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+}
+
+TEST(ChunkedVector, Empty)
+{
+    ChunkedVector<int> v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ((size_t)0, v.size());
+    EXPECT_TRUE(v.toVector().empty());
+}
+
+TEST(ChunkedVector, PushBackAndAssign)
+{
+    std::vector<int> expected;
+    ChunkedVector<int, 4> v;
+    for (int i = 0; i < 100; ++i) {
+        expected.push_back(i);
+        v.push_back(i);
+    }
+    expectEqual(expected, v);
+
+    ChunkedVector<int, 4> assigned;
+    assigned.assign(expected.begin(), expected.end());
+    expectEqual(expected, assigned);
+
+    assigned.clear();
+    EXPECT_TRUE(assigned.empty());
+}
+
+TEST(ChunkedVector, InsertEraseMove)
+{
+    std::vector<int> expected = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    ChunkedVector<int, 4> v;
+    v.assign(expected.begin(), expected.end());
+
+    v.insert(0, 100);
+    expected.insert(expected.begin(), 100);
+    v.insert(5, 101);
+    expected.insert(expected.begin() + 5, 101);
+    v.insert(v.size(), 102);
+    expected.push_back(102);
+    expectEqual(expected, v);
+
+    v.erase(3);
+    expected.erase(expected.begin() + 3);
+    v.erase(2, 6);
+    expected.erase(expected.begin() + 2, expected.begin() + 6);
+    expectEqual(expected, v);
+
+    v.move(0, 5);
+    int value = expected[0];
+    expected.erase(expected.begin());
+    expected.insert(expected.begin() + 5, value);
+    v.move(6, 1);
+    value = expected[6];
+    expected.erase(expected.begin() + 6);
+    expected.insert(expected.begin() + 1, value);
+    expectEqual(expected, v);
+
+    std::vector<int> range = {200, 201, 202};
+    v.insert(2, range.begin(), range.end());
+    expected.insert(expected.begin() + 2, range.begin(), range.end());
+    expectEqual(expected, v);
+}
+
+TEST(ChunkedVector, ForEachRange)
+{
+    std::vector<int> expected;
+    for (int i = 0; i < 1000; ++i) {
+        expected.push_back(i);
+    }
+    ChunkedVector<int, 8> v;
+    v.assign(expected.begin(), expected.end());
+
+    std::vector<int> visited;
+    v.forEach(123, 457, [&visited](int value){visited.push_back(value);});
+    EXPECT_EQ(std::vector<int>(expected.begin() + 123, expected.begin() + 457), visited);
+
+    visited.clear();
+    v.forEach(500, 500, [&visited](int value){visited.push_back(value);});
+    EXPECT_TRUE(visited.empty());
+}
+
+TEST(ChunkedVector, RandomOperations)
+{
+    std::srand(42);
+    std::vector<int> expected;
+    ChunkedVector<int, 16> v;
+
+    for (int i = 0; i < 20000; ++i) {
+        const int op = std::rand() % 4;
+        if (op < 2 || expected.empty()) {
+            const size_t pos = std::rand() % (expected.size() + 1);
+            expected.insert(expected.begin() + pos, i);
+            v.insert(pos, i);
+        } else if (op == 2) {
+            const size_t pos = std::rand() % expected.size();
+            expected.erase(expected.begin() + pos);
+            v.erase(pos);
+        } else {
+            const size_t from = std::rand() % expected.size();
+            const size_t to = std::rand() % expected.size();
+            const int value = expected[from];
+            expected.erase(expected.begin() + from);
+            expected.insert(expected.begin() + to, value);
+            v.move(from, to);
+        }
+    }
+    expectEqual(expected, v);
+}
+
+namespace {
+
+struct ValueWeight
+{
+    int64_t operator()(int value) const {return value;}
+};
+
+int64_t rangeSum(const std::vector<int>& values, size_t first, size_t last)
+{
+    int64_t result = 0;
+    for (size_t i = first; i < last; ++i) {
+        result += values[i];
+    }
+    return result;
+}
+
+}
+
+TEST(ChunkedVector, RangeSums)
+{
+    std::srand(7);
+    std::vector<int> expected;
+    ChunkedVector<int, 8, ValueWeight> v;
+    EXPECT_EQ(0, v.sum());
+
+    std::vector<int> initial;
+    for (int i = 0; i < 100; ++i) {
+        initial.push_back(i);
+    }
+    v.assign(initial.begin(), initial.end());
+    expected = initial;
+    EXPECT_EQ(rangeSum(expected, 0, expected.size()), v.sum());
+
+    for (int i = 0; i < 5000; ++i) {
+        const int op = std::rand() % 5;
+        if (op < 2 || expected.empty()) {
+            const size_t pos = std::rand() % (expected.size() + 1);
+            const int value = std::rand() % 1000;
+            expected.insert(expected.begin() + pos, value);
+            v.insert(pos, value);
+        } else if (op == 2) {
+            const size_t pos = std::rand() % expected.size();
+            expected.erase(expected.begin() + pos);
+            v.erase(pos);
+        } else if (op == 3) {
+            const size_t from = std::rand() % expected.size();
+            const size_t to = std::rand() % expected.size();
+            const int value = expected[from];
+            expected.erase(expected.begin() + from);
+            expected.insert(expected.begin() + to, value);
+            v.move(from, to);
+        } else {
+            const int oldValue = expected[std::rand() % expected.size()];
+            for (int& value : expected) {
+                if (value == oldValue)
+                    value += 1;
+            }
+            const bool changed = v.modify([oldValue](int& value){
+                if (value != oldValue)
+                    return false;
+                value += 1;
+                return true;
+            });
+            EXPECT_TRUE(changed);
+        }
+
+        ASSERT_EQ(rangeSum(expected, 0, expected.size()), v.sum());
+        const size_t first = std::rand() % (expected.size() + 1);
+        const size_t last = first + std::rand() % (expected.size() - first + 1);
+        ASSERT_EQ(rangeSum(expected, first, last), v.sum(first, last));
+    }
+    expectEqual(expected, v);
+    EXPECT_FALSE(v.modify([](int&){return false;}));
+}
+
+TEST(ChunkedVector, RangeInsertErase)
+{
+    std::srand(11);
+    std::vector<int> expected;
+    ChunkedVector<int, 16, ValueWeight> v;
+
+    for (int i = 0; i < 3000; ++i) {
+        const int op = std::rand() % 4;
+        if (op == 0 || expected.size() < 100) {
+            const size_t pos = std::rand() % (expected.size() + 1);
+            std::vector<int> range(std::rand() % 200);
+            for (int& value : range) {
+                value = std::rand() % 1000;
+            }
+            expected.insert(expected.begin() + pos, range.begin(), range.end());
+            v.insert(pos, range.begin(), range.end());
+        } else if (op == 1) {
+            const size_t first = std::rand() % (expected.size() + 1);
+            const size_t last = first + std::rand() % (std::min<size_t>(expected.size() - first, 150) + 1);
+            expected.erase(expected.begin() + first, expected.begin() + last);
+            v.erase(first, last);
+        } else {
+            const size_t pos = std::rand() % expected.size();
+            expected.erase(expected.begin() + pos);
+            v.erase(pos);
+        }
+
+        ASSERT_EQ(expected.size(), v.size());
+        ASSERT_EQ(rangeSum(expected, 0, expected.size()), v.sum());
+        // Underfull chunks are joined with their neighbours
+        ASSERT_LE(v.chunksCount(), expected.size() / 4 + 1);
+    }
+    expectEqual(expected, v);
+
+    // Erasing everything but the edges keeps a few chunks
+    v.erase(10, v.size() - 10);
+    expected.erase(expected.begin() + 10, expected.end() - 10);
+    expectEqual(expected, v);
+    EXPECT_EQ((size_t)2, v.chunksCount());
+
+    v.erase(0, v.size());
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ((size_t)0, v.chunksCount());
+}
+
+// Run with --gtest_also_run_disabled_tests to compare with std::vector
+TEST(ChunkedVector, DISABLED_BenchmarkPlaylistEdits)
+{
+    const int playlistSize = 200000;
+    const int edits = 20000;
+
+    std::vector<int> ids;
+    for (int i = 0; i < playlistSize; ++i) {
+        ids.push_back(i);
+    }
+
+    std::vector<int> vector(ids);
+    ChunkedVector<int> chunked;
+    chunked.assign(ids.begin(), ids.end());
+
+    // Moves near the top of the playlist, like moving selected songs
+    const double vectorMoveMs = measureMs([&vector, edits](){
+        for (int i = 0; i < edits; ++i) {
+            const int value = vector[i % 100];
+            vector.erase(vector.begin() + i % 100);
+            vector.insert(vector.begin() + (i + 50) % 100, value);
+        }
+    });
+    const double chunkedMoveMs = measureMs([&chunked, edits](){
+        for (int i = 0; i < edits; ++i) {
+            chunked.move(i % 100, (i + 50) % 100);
+        }
+    });
+    EXPECT_EQ(vector, chunked.toVector());
+
+    // Random inserts and removals
+    std::srand(1);
+    const double vectorEditMs = measureMs([&vector, edits](){
+        for (int i = 0; i < edits; ++i) {
+            const size_t pos = std::rand() % vector.size();
+            if (i % 2)
+                vector.erase(vector.begin() + pos);
+            else
+                vector.insert(vector.begin() + pos, i);
+        }
+    });
+    std::srand(1);
+    const double chunkedEditMs = measureMs([&chunked, edits](){
+        for (int i = 0; i < edits; ++i) {
+            const size_t pos = std::rand() % chunked.size();
+            if (i % 2)
+                chunked.erase(pos);
+            else
+                chunked.insert(pos, i);
+        }
+    });
+    EXPECT_EQ(vector, chunked.toVector());
+
+    // Painting a page of rows from the middle
+    long long vectorSum = 0, chunkedSum = 0;
+    const double vectorPaintMs = measureMs([&vector, &vectorSum, edits](){
+        for (int i = 0; i < edits; ++i) {
+            const size_t first = (i * 997) % (vector.size() - 100);
+            for (size_t item = first; item < first + 100; ++item) {
+                vectorSum += vector[item];
+            }
+        }
+    });
+    const double chunkedPaintMs = measureMs([&chunked, &chunkedSum, edits](){
+        for (int i = 0; i < edits; ++i) {
+            const size_t first = (i * 997) % (chunked.size() - 100);
+            chunked.forEach(first, first + 100, [&chunkedSum](int value){chunkedSum += value;});
+        }
+    });
+    EXPECT_EQ(vectorSum, chunkedSum);
+
+    std::printf("%d entries, %d operations:\n", playlistSize, edits);
+    std::printf("  move near top:    vector %8.2f ms, chunked %8.2f ms\n", vectorMoveMs, chunkedMoveMs);
+    std::printf("  random edit:      vector %8.2f ms, chunked %8.2f ms\n", vectorEditMs, chunkedEditMs);
+    std::printf("  paint 100 rows:   vector %8.2f ms, chunked %8.2f ms\n", vectorPaintMs, chunkedPaintMs);
+}
@@ -0,0 +1,276 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "gtest/gtest.h"
+
+#include "lib/FlatHashMap.h"
+
+using namespace ncxmms2;
+
+namespace {
+
+template <typename T>
+void expectEqual(const std::unordered_map<int, T>& expected, const FlatHashMap<int, T>& map)
+{
+    ASSERT_EQ(expected.size(), map.size());
+    for (const auto& pair : expected) {
+        auto it = map.find(pair.first);
+        ASSERT_TRUE(it != map.end());
+        EXPECT_EQ(pair.first, it->first);
+        EXPECT_EQ(pair.second, it->second);
+    }
+
+    size_t count = 0;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        EXPECT_EQ(1u, expected.count(it->first));
+        ++count;
+    }
+    EXPECT_EQ(expected.size(), count);
+}
+
+template <typename F>
+double measureMs(F f)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// Roughly the size of Song
+struct SongInfo
+{
+    SongInfo() : id(0), duration(-1) {}
+    int id;
+    int duration;
+    int other[14];
+};
+
+}
+
+TEST(FlatHashMap, Empty)
+{
+    FlatHashMap<int, int> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ((size_t)0, map.size());
+    EXPECT_TRUE(map.find(1) == map.end());
+    EXPECT_TRUE(map.begin() == map.end());
+    EXPECT_EQ((size_t)0, map.erase(1));
+}
+
+TEST(FlatHashMap, InsertFindErase)
+{
+    FlatHashMap<int, std::string> map;
+    map[1] = "one";
+    map[2] = "two";
+    map[1000] = "thousand";
+    EXPECT_EQ((size_t)3, map.size());
+
+    EXPECT_EQ("one", map[1]);
+    EXPECT_EQ((size_t)3, map.size());
+    EXPECT_EQ("thousand", map.find(1000)->second);
+    EXPECT_TRUE(map.find(3) == map.end());
+
+    map.erase(map.find(1));
+    EXPECT_TRUE(map.find(1) == map.end());
+    EXPECT_EQ((size_t)1, map.erase(2));
+    EXPECT_EQ((size_t)0, map.erase(2));
+    EXPECT_EQ((size_t)1, map.size());
+    EXPECT_EQ("thousand", map[1000]);
+
+    // Default constructed value after reinsertion
+    EXPECT_EQ("", map[1]);
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_TRUE(map.find(1000) == map.end());
+}
+
+TEST(FlatHashMap, Reserve)
+{
+    FlatHashMap<int, int> map;
+    map.reserve(1000);
+    for (int i = 0; i < 1000; ++i) {
+        map[i] = i * 2;
+    }
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(i * 2, map.find(i)->second);
+    }
+}
+
+namespace {
+
+template <typename KeyGenerator>
+void testRandomOperations(KeyGenerator nextKey)
+{
+    std::unordered_map<int, int> expected;
+    FlatHashMap<int, int> map;
+    std::srand(1);
+    for (int i = 0; i < 100000; ++i) {
+        const int key = nextKey();
+        switch (std::rand() % 3) {
+            case 0:
+                expected[key] = i;
+                map[key] = i;
+                break;
+            case 1:
+                ASSERT_EQ(expected.erase(key), map.erase(key));
+                break;
+            case 2:
+                ASSERT_EQ(expected.count(key), map.count(key));
+                break;
+        }
+        if (i % 1000 == 0)
+            expectEqual(expected, map);
+    }
+    expectEqual(expected, map);
+}
+
+}
+
+TEST(FlatHashMap, RandomOperations)
+{
+    // Small key range, so that probe runs collide and wrap around a lot,
+    // which exercises backward shift deletion
+    testRandomOperations([](){return std::rand() % 500 - 100;});
+}
+
+TEST(FlatHashMap, RandomOperationsStridedKeys)
+{
+    // Keys differing by multiples of a power of two
+    testRandomOperations([](){return (std::rand() % 300) * 65536 + std::rand() % 4;});
+}
+
+TEST(FlatHashMap, SequentialAndStridedKeysProbeShortly)
+{
+    // A playlist of sequential ids, then ids of a range far above them
+    FlatHashMap<int, int> map;
+    map.reserve(150000);
+    for (int id = 1; id <= 150000; ++id) {
+        map[id] = id;
+    }
+    for (int id = 524289; id < 524289 + 10000; ++id) {
+        map[id] = id;
+    }
+    EXPECT_LT(map.maxProbeLength(), (size_t)64);
+
+    // Keys differing by multiples of the capacity
+    FlatHashMap<int, int> strided;
+    for (int i = 0; i < 20000; ++i) {
+        strided[i * 65536] = i;
+    }
+    EXPECT_LT(strided.maxProbeLength(), (size_t)64);
+
+    for (int id = 1; id <= 150000; ++id) {
+        ASSERT_EQ(id, map.find(id)->second);
+    }
+    for (int i = 0; i < 20000; ++i) {
+        ASSERT_EQ(i, strided.find(i * 65536)->second);
+    }
+    EXPECT_TRUE(map.find(150001) == map.end());
+    EXPECT_TRUE(strided.find(65535) == strided.end());
+}
+
+TEST(FlatHashMap, DISABLED_BenchmarkPlaylistSongInfos)
+{
+    const int playlistSize = 200000;
+    const int operations = 2000000;
+
+    // Playlist made of albums, songs of an album usually have sequential medialib ids
+    std::vector<int> ids;
+    std::srand(1);
+    while (ids.size() < (size_t)playlistSize) {
+        const int albumFirstId = std::rand() % (playlistSize * 4) + 1;
+        const int albumSize = std::rand() % 15 + 1;
+        for (int id = albumFirstId; id < albumFirstId + albumSize; ++id) {
+            ids.push_back(id);
+        }
+    }
+    ids.resize(playlistSize);
+
+    std::unordered_map<int, SongInfo> unordered;
+    FlatHashMap<int, SongInfo> flat;
+    const double unorderedLoadMs = measureMs([&](){
+        unordered.rehash(ids.size() / unordered.max_load_factor() + 1);
+        for (int id : ids) {
+            unordered[id].id = id;
+        }
+    });
+    const double flatLoadMs = measureMs([&](){
+        flat.reserve(ids.size());
+        for (int id : ids) {
+            flat[id].id = id;
+        }
+    });
+
+    // Painting pages of 50 rows from random places of the playlist,
+    // every row looks up song info by id
+    const int pageSize = 50;
+    long long unorderedSum = 0, flatSum = 0;
+    const double unorderedPaintMs = measureMs([&](){
+        for (int i = 0; i < operations / pageSize; ++i) {
+            const int first = (i * 7919) % (playlistSize - pageSize);
+            for (int item = first; item < first + pageSize; ++item) {
+                unorderedSum += unordered.find(ids[item])->second.duration;
+            }
+        }
+    });
+    const double flatPaintMs = measureMs([&](){
+        for (int i = 0; i < operations / pageSize; ++i) {
+            const int first = (i * 7919) % (playlistSize - pageSize);
+            for (int item = first; item < first + pageSize; ++item) {
+                flatSum += flat.find(ids[item])->second.duration;
+            }
+        }
+    });
+    EXPECT_EQ(unorderedSum, flatSum);
+
+    // Playlist edits: songs removed and added, lookup misses for new ids
+    std::srand(2);
+    const double unorderedChurnMs = measureMs([&](){
+        for (int i = 0; i < operations / 4; ++i) {
+            const int id = std::rand() % (playlistSize * 4) + 1;
+            auto it = unordered.find(id);
+            if (it != unordered.end())
+                unordered.erase(it);
+            else
+                unordered[id].id = id;
+        }
+    });
+    std::srand(2);
+    const double flatChurnMs = measureMs([&](){
+        for (int i = 0; i < operations / 4; ++i) {
+            const int id = std::rand() % (playlistSize * 4) + 1;
+            auto it = flat.find(id);
+            if (it != flat.end())
+                flat.erase(it);
+            else
+                flat[id].id = id;
+        }
+    });
+    EXPECT_EQ(unordered.size(), flat.size());
+
+    std::printf("%d entries, %d operations:\n", playlistSize, operations);
+    std::printf("  load:      unordered_map %8.2f ms, flat %8.2f ms\n", unorderedLoadMs, flatLoadMs);
+    std::printf("  paint:     unordered_map %8.2f ms, flat %8.2f ms\n", unorderedPaintMs, flatPaintMs);
+    std::printf("  churn:     unordered_map %8.2f ms, flat %8.2f ms\n", unorderedChurnMs, flatChurnMs);
+}
@@ -0,0 +1,256 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "gtest/gtest.h"
+
+#include "lib/ItemSelection.h"
+
+using namespace ncxmms2;
+
+namespace {
+
+void expectEqual(const std::vector<bool>& expected, const ItemSelection& selection)
+{
+    ASSERT_EQ((int)expected.size(), selection.itemsCount());
+
+    std::vector<int> expectedItems;
+    for (size_t item = 0; item < expected.size(); ++item) {
+        if (expected[item])
+            expectedItems.push_back(item);
+        ASSERT_EQ(expected[item], selection.contains(item)) << "item " << item;
+    }
+    ASSERT_EQ((int)expectedItems.size(), selection.size());
+    ASSERT_EQ(expectedItems, selection.items());
+    ASSERT_EQ(expectedItems, std::vector<int>(selection.begin(), selection.end()));
+
+    if (expectedItems.empty()) {
+        EXPECT_EQ(-1, selection.first());
+        EXPECT_EQ(-1, selection.last());
+    } else {
+        EXPECT_EQ(expectedItems.front(), selection.first());
+        EXPECT_EQ(expectedItems.back(), selection.last());
+    }
+
+    // Neighbours of every item
+    int previous = -1;
+    size_t nextIndex = 0;
+    for (int item = 0; item < (int)expected.size(); ++item) {
+        if (nextIndex < expectedItems.size() && expectedItems[nextIndex] <= item)
+            ++nextIndex;
+        const int next = nextIndex < expectedItems.size() ? expectedItems[nextIndex] : -1;
+        ASSERT_EQ(next, selection.next(item)) << "item " << item;
+        ASSERT_EQ(previous, selection.previous(item)) << "item " << item;
+        if (expected[item])
+            previous = item;
+    }
+}
+
+} // namespace
+
+TEST(ItemSelection, SelectAndUnselect)
+{
+    ItemSelection selection(10);
+    EXPECT_TRUE(selection.empty());
+    EXPECT_EQ(selection.end(), selection.begin());
+
+    selection.select(3);
+    selection.select(5);
+    selection.select(4);
+    selection.select(4);
+    EXPECT_EQ(3, selection.size());
+    EXPECT_EQ(std::vector<int>({3, 4, 5}), selection.items());
+
+    selection.unselect(4);
+    EXPECT_EQ(std::vector<int>({3, 5}), selection.items());
+    selection.toggle(4);
+    selection.toggle(3);
+    EXPECT_EQ(std::vector<int>({4, 5}), selection.items());
+    EXPECT_EQ(5, selection.next(4));
+    EXPECT_EQ(-1, selection.next(5));
+    EXPECT_EQ(4, selection.previous(5));
+    EXPECT_EQ(-1, selection.previous(4));
+}
+
+TEST(ItemSelection, SelectAllAndInvertLargeList)
+{
+    ItemSelection selection(500000);
+    selection.selectAll();
+    EXPECT_EQ(500000, selection.size());
+    EXPECT_FALSE(selection.isDense());
+
+    selection.unselect(1000);
+    selection.invert();
+    EXPECT_EQ(std::vector<int>({1000}), selection.items());
+    EXPECT_FALSE(selection.isDense());
+
+    selection.invert();
+    EXPECT_EQ(499999, selection.size());
+    EXPECT_EQ(1001, selection.next(999));
+}
+
+TEST(ItemSelection, ShiftsOnListChanges)
+{
+    ItemSelection selection(10);
+    selection.selectRange(2, 4); // 2 3 4 5
+    selection.select(8);
+
+    selection.itemsInserted(4, 2);
+    EXPECT_EQ(12, selection.itemsCount());
+    EXPECT_EQ(std::vector<int>({2, 3, 6, 7, 10}), selection.items());
+
+    selection.itemsRemoved(3, 4);
+    EXPECT_EQ(std::vector<int>({2, 3, 6}), selection.items());
+
+    // The same as moving item 6 to the top of the list
+    selection.itemsMoved(6, 1, 0);
+    EXPECT_EQ(std::vector<int>({0, 3, 4}), selection.items());
+    selection.itemsMoved(0, 2, 5);
+    EXPECT_EQ(std::vector<int>({1, 2, 5}), selection.items());
+}
+
+TEST(ItemSelection, SwitchesRepresentation)
+{
+    const int itemsCount = 20000;
+    ItemSelection selection(itemsCount);
+    for (int item = 0; item < itemsCount; item += 2) {
+        selection.select(item);
+    }
+    EXPECT_TRUE(selection.isDense());
+    EXPECT_EQ(itemsCount / 2, selection.size());
+
+    ItemSelection odd(itemsCount);
+    selection.invert();
+    odd.unite(selection);
+    EXPECT_EQ(itemsCount / 2, odd.size());
+    EXPECT_EQ(1, odd.first());
+
+    selection.selectAll();
+    EXPECT_FALSE(selection.isDense());
+    selection.subtract(odd);
+    EXPECT_EQ(itemsCount / 2, selection.size());
+    EXPECT_EQ(0, selection.first());
+    EXPECT_EQ(2, selection.next(0));
+}
+
+TEST(ItemSelection, MatchesReferenceModel)
+{
+    srand(1);
+    int denseSteps = 0;
+    for (int round = 0; round < 40; ++round) {
+        // Large rounds get fragmented enough to become dense
+        const int initialItemsCount = round % 2 ? 300 + rand() % 200 : 5000 + rand() % 5000;
+        std::vector<bool> expected(initialItemsCount, false);
+        ItemSelection selection(initialItemsCount);
+
+        for (int step = 0; step < 300; ++step) {
+            const int itemsCount = expected.size();
+            const int item = itemsCount ? rand() % itemsCount : 0;
+            const int count = itemsCount ? rand() % (itemsCount - item + 1) : 0;
+            switch (rand() % 12) {
+                case 0:
+                case 1:
+                    for (int i = 0; i < 50 && itemsCount; ++i) {
+                        const int randomItem = rand() % itemsCount;
+                        expected[randomItem] = !expected[randomItem];
+                        selection.toggle(randomItem);
+                    }
+                    break;
+                case 2:
+                    std::fill(expected.begin() + item, expected.begin() + item + count, true);
+                    selection.selectRange(item, count);
+                    break;
+                case 3:
+                    std::fill(expected.begin() + item, expected.begin() + item + count, false);
+                    selection.unselectRange(item, count);
+                    break;
+                case 4:
+                    expected.flip();
+                    selection.invert();
+                    break;
+                case 5:
+                {
+                    const int inserted = rand() % 100;
+                    expected.insert(expected.begin() + item, inserted, false);
+                    selection.itemsInserted(item, inserted);
+                    break;
+                }
+                case 6:
+                {
+                    const int removed = std::min(count, 200);
+                    expected.erase(expected.begin() + item, expected.begin() + item + removed);
+                    selection.itemsRemoved(item, removed);
+                    break;
+                }
+                case 7:
+                {
+                    const int moved = std::min(count, 300);
+                    std::vector<bool> block(expected.begin() + item, expected.begin() + item + moved);
+                    expected.erase(expected.begin() + item, expected.begin() + item + moved);
+                    const int to = rand() % (expected.size() + 1);
+                    expected.insert(expected.begin() + to, block.begin(), block.end());
+                    selection.itemsMoved(item, moved, to);
+                    break;
+                }
+                case 8:
+                case 9:
+                {
+                    std::vector<bool> otherExpected(itemsCount, false);
+                    ItemSelection other(itemsCount);
+                    for (int i = 0; i < 100 && itemsCount; ++i) {
+                        const int otherItem = rand() % itemsCount;
+                        const int otherCount = rand() % std::min(itemsCount - otherItem, 20) + 1;
+                        std::fill(otherExpected.begin() + otherItem,
+                                  otherExpected.begin() + otherItem + otherCount, true);
+                        other.selectRange(otherItem, otherCount);
+                    }
+                    for (int i = 0; i < itemsCount; ++i) {
+                        if (otherExpected[i])
+                            expected[i] = step % 2 == 0;
+                    }
+                    if (step % 2 == 0) {
+                        selection.unite(other);
+                    } else {
+                        selection.subtract(other);
+                    }
+                    break;
+                }
+                case 10:
+                    if (rand() % 4 == 0) {
+                        expected.assign(itemsCount, true);
+                        selection.selectAll();
+                    }
+                    break;
+                default:
+                    if (rand() % 4 == 0) {
+                        expected.assign(itemsCount, false);
+                        selection.clear();
+                    }
+                    break;
+            }
+            ASSERT_EQ((int)expected.size(), selection.itemsCount());
+            ASSERT_EQ((int)std::count(expected.begin(), expected.end(), true), selection.size());
+            if (selection.isDense())
+                ++denseSteps;
+            if (step % 50 == 0)
+                expectEqual(expected, selection);
+        }
+        expectEqual(expected, selection);
+    }
+    EXPECT_GT(denseSteps, 0);
+}
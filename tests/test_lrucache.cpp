@@ -0,0 +1,121 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <list>
+#include <string>
+#include <cstdlib>
+#include "gtest/gtest.h"
+
+#include "lib/LruCache.h"
+
+using namespace ncxmms2;
+
+TEST(LruCache, EvictsLeastRecentlyUsed)
+{
+    LruCache<int, std::string> cache(3);
+    cache.insert(1) = "one";
+    cache.insert(2) = "two";
+    cache.insert(3) = "three";
+    EXPECT_EQ(3u, cache.size());
+
+    // 1 becomes the most recently used, so 2 goes first
+    ASSERT_TRUE(cache.find(1) != nullptr);
+    EXPECT_EQ("one", *cache.find(1));
+    cache.insert(4) = "four";
+    EXPECT_EQ(3u, cache.size());
+    EXPECT_TRUE(cache.find(2) == nullptr);
+    EXPECT_EQ("one", *cache.find(1));
+    EXPECT_EQ("three", *cache.find(3));
+    EXPECT_EQ("four", *cache.find(4));
+
+    // Reinserted key keeps its value
+    EXPECT_EQ("one", cache.insert(1));
+}
+
+TEST(LruCache, RemoveAndClear)
+{
+    LruCache<int, std::string> cache(2);
+    cache.insert(1) = "one";
+    cache.insert(2) = "two";
+    EXPECT_TRUE(cache.remove(1));
+    EXPECT_FALSE(cache.remove(1));
+    EXPECT_EQ(1u, cache.size());
+
+    // Removed slot is reused without evicting 2
+    cache.insert(3) = "three";
+    EXPECT_EQ("two", *cache.find(2));
+    EXPECT_EQ("three", *cache.find(3));
+
+    cache.clear();
+    EXPECT_TRUE(cache.empty());
+    EXPECT_TRUE(cache.find(2) == nullptr);
+    cache.insert(5) = "five";
+    cache.insert(6) = "six";
+    cache.insert(7) = "seven";
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_TRUE(cache.find(5) == nullptr);
+    EXPECT_EQ("seven", *cache.find(7));
+}
+
+TEST(LruCache, RandomOperations)
+{
+    const size_t capacity = 16;
+    LruCache<int, int> cache(capacity);
+    std::list<std::pair<int, int>> expected; // The most recently used first
+
+    auto expectedFind = [&expected](int key) -> std::list<std::pair<int, int>>::iterator
+    {
+        for (auto it = expected.begin(); it != expected.end(); ++it) {
+            if (it->first == key)
+                return it;
+        }
+        return expected.end();
+    };
+
+    std::srand(7);
+    for (int i = 0; i < 20000; ++i) {
+        const int key = std::rand() % 40;
+        auto it = expectedFind(key);
+        switch (std::rand() % 3) {
+            case 0:
+            {
+                int *value = cache.find(key);
+                ASSERT_EQ(it != expected.end(), value != nullptr);
+                if (value) {
+                    EXPECT_EQ(it->second, *value);
+                    expected.splice(expected.begin(), expected, it);
+                }
+                break;
+            }
+
+            case 1:
+                cache.insert(key) = i;
+                if (it != expected.end())
+                    expected.erase(it);
+                expected.emplace_front(key, i);
+                if (expected.size() > capacity)
+                    expected.pop_back();
+                break;
+
+            case 2:
+                EXPECT_EQ(it != expected.end(), cache.remove(key));
+                if (it != expected.end())
+                    expected.erase(it);
+                break;
+        }
+        ASSERT_EQ(expected.size(), cache.size());
+    }
+}
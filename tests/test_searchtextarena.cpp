@@ -0,0 +1,81 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#include <string>
+#include "gtest/gtest.h"
+
+#include "lib/SearchTextArena.h"
+
+using namespace ncxmms2;
+
+namespace {
+
+std::string text(const SearchTextArena& arena, int key)
+{
+    SearchTextArena::Span span;
+    if (!arena.find(key, &span))
+        return "<none>";
+    return arena.buffer().substr(span.offset, span.size);
+}
+
+}
+
+TEST(SearchTextArena, FoldsAndTerminatesStrings)
+{
+    SearchTextArena arena;
+    const std::string song("Some Artist\0Song Title\0", 23);
+    arena.insert(1, song);
+    arena.insert(2, "NO TERMINATOR", 13);
+    arena.insert(3, std::string("\xD0\x90\xD0\x91\0", 5)); // Cyrillic "АБ"
+
+    EXPECT_EQ(3u, arena.size());
+    EXPECT_TRUE(arena.contains(1));
+    EXPECT_FALSE(arena.contains(4));
+    EXPECT_EQ(std::string("some artist\0song title\0", 23), text(arena, 1));
+    EXPECT_EQ(std::string("no terminator\0", 14), text(arena, 2));
+    EXPECT_EQ(std::string("\xD0\xB0\xD0\xB1\0", 5), text(arena, 3));
+}
+
+TEST(SearchTextArena, ReplaceAndRemove)
+{
+    SearchTextArena arena;
+    arena.insert(1, "First", 5);
+    arena.insert(2, "Second", 6);
+    arena.insert(1, "Replaced", 8);
+    EXPECT_EQ(std::string("replaced\0", 9), text(arena, 1));
+    EXPECT_EQ(std::string("second\0", 7), text(arena, 2));
+
+    arena.remove(2);
+    arena.remove(2);
+    EXPECT_FALSE(arena.contains(2));
+    EXPECT_EQ(1u, arena.size());
+
+    arena.clear();
+    EXPECT_EQ(0u, arena.size());
+    EXPECT_TRUE(arena.buffer().empty());
+}
+
+TEST(SearchTextArena, CompactsGarbage)
+{
+    SearchTextArena arena;
+    for (int i = 0; i < 1000; ++i) {
+        arena.insert(i % 10, "Text " + std::to_string(i));
+    }
+    EXPECT_EQ(10u, arena.size());
+    EXPECT_LT(arena.buffer().size(), 10u * 2 * 9 + 9);
+    for (int key = 0; key < 10; ++key) {
+        EXPECT_EQ("text " + std::to_string(990 + key) + '\0', text(arena, key));
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <xmmsclient/xmmsclient.h>
+#include "gtest/gtest.h"
+
+#include "SongDisplayFormatParser.h"
+#include "XmmsUtils/Types.h"
+
+using namespace ncxmms2;
+
+namespace {
+
+Song makeSong(const std::vector<std::pair<const char*, const char*>>& tags, int trackNumber = -1)
+{
+    xmmsv_t *dict = xmmsv_new_dict();
+    xmmsv_dict_set_int(dict, "id", 1);
+    if (trackNumber != -1)
+        xmmsv_dict_set_int(dict, "tracknr", trackNumber);
+    for (const auto& tag : tags) {
+        xmmsv_dict_set_string(dict, tag.first, tag.second);
+    }
+    Song song;
+    song.loadInfo(xmms2::Dict(dict));
+    xmmsv_unref(dict);
+    return song;
+}
+
+std::string format(const std::string& formatString, const Song& song, int column = 0)
+{
+    SongDisplayFormatParser parser;
+    EXPECT_TRUE(parser.setDisplayFormat(formatString)) << parser.errorString();
+    return parser.formattedString(song, column);
+}
+
+}
+
+TEST(SongDisplayFormat, FirstNotEmptyAlternative)
+{
+    const std::string formatString = "[l:1:0]{$a - $t}|{$t}|{$f}";
+    const Song full = makeSong({{"artist", "Artist"}, {"title", "Title"}, {"url", "file:///music/song.ogg"}});
+    const Song noArtist = makeSong({{"title", "Title"}, {"url", "file:///music/song.ogg"}});
+    const Song urlOnly = makeSong({{"url", "file:///music/song.ogg"}});
+    const Song nothing = makeSong({});
+
+    EXPECT_EQ("Artist - Title", format(formatString, full));
+    EXPECT_EQ("Title", format(formatString, noArtist));
+    EXPECT_EQ("song.ogg", format(formatString, urlOnly));
+    EXPECT_EQ("", format(formatString, nothing));
+}
+
+TEST(SongDisplayFormat, TextAroundAlternatives)
+{
+    // Text after the last alternative is printed whichever one is shown
+    const std::string formatString = "[l:1:0]<{$b}|{$y}>{ #$n}";
+    EXPECT_EQ("<Album> #3", format(formatString, makeSong({{"album", "Album"}}, 3)));
+    EXPECT_EQ("<2001>", format(formatString, makeSong({{"date", "2001"}})));
+    EXPECT_EQ("<>", format(formatString, makeSong({})));
+}
+
+TEST(SongDisplayFormat, LargeTrackNumber)
+{
+    EXPECT_EQ("40000", format("[l:1:0]{$n}", makeSong({}, 40000)));
+}
+
+TEST(SongDisplayFormat, MissingTags)
+{
+    // Variables outside of sections are printed empty
+    const Song song = makeSong({{"title", "Title"}});
+    EXPECT_EQ(" - Title", format("[l:1:0]$a - $t", song));
+    EXPECT_EQ("Title", format("[l:1:0]{$a - }$t", song));
+    EXPECT_EQ("()", format("[l:1:0]($l)", song));
+    EXPECT_EQ("", format("[l:1:0]{($l)}", song));
+}
+
+TEST(SongDisplayFormat, ColumnSections)
+{
+    // Sections of one column don't affect the others
+    const std::string formatString = "[r:0:3]{$n}[l:1:0]{$a - $t}|{$t}[c:0:10]%3c{$b}|{\\?}";
+    const Song song = makeSong({{"title", "Title"}}, 7);
+
+    EXPECT_EQ("7", format(formatString, song, 0));
+    EXPECT_EQ("Title", format(formatString, song, 1));
+    EXPECT_EQ("?", format(formatString, song, 2));
+
+    const Song album = makeSong({{"artist", "Artist"}, {"title", "Title"}, {"album", "Album"}});
+    EXPECT_EQ("", format(formatString, album, 0));
+    EXPECT_EQ("Artist - Title", format(formatString, album, 1));
+    EXPECT_EQ("Album", format(formatString, album, 2));
+}
+
+TEST(SongDisplayFormat, NestedSectionsAreRejected)
+{
+    SongDisplayFormatParser parser;
+    EXPECT_FALSE(parser.setDisplayFormat("[l:1:0]{$a{$t}|{$f}}"));
+    EXPECT_FALSE(parser.errorString().empty());
+    EXPECT_FALSE(parser.setDisplayFormat("[l:1:0]{$a}|$t"));
+    EXPECT_FALSE(parser.setDisplayFormat("[l:1:0]{$a}|"));
+}
+
+TEST(SongDisplayFormat, SectionsLimit)
+{
+    // Sections are tracked by bits of 64 bit masks, the last one must work as the first
+    std::string formatString = "[l:1:0]";
+    for (int i = 0; i < 62; ++i) {
+        formatString.append("{$a}");
+    }
+    formatString.append("{$t}|{$f}");
+
+    const Song song = makeSong({{"artist", "a"}, {"url", "file:///music/song.ogg"}});
+    SongDisplayFormatParser parser;
+    ASSERT_TRUE(parser.setDisplayFormat(formatString)) << parser.errorString();
+    EXPECT_EQ(std::string(62, 'a') + "song.ogg", parser.formattedString(song, 0));
+
+    formatString.append("{$a}");
+    EXPECT_FALSE(parser.setDisplayFormat(formatString));
+    EXPECT_FALSE(parser.errorString().empty());
+}
@@ -0,0 +1,136 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include <string>
+#include "gtest/gtest.h"
+
+#include "lib/StringPool.h"
+
+using namespace ncxmms2;
+
+TEST(StringPool, EmptyString)
+{
+    EXPECT_EQ((StringPool::Handle)0, StringPool::intern(""));
+    EXPECT_EQ((StringPool::Handle)0, StringPool::intern(std::string()));
+    EXPECT_EQ("", StringPool::get(0));
+    StringPool::release(0);
+    EXPECT_EQ("", StringPool::get(0));
+}
+
+TEST(StringPool, SameStringSameHandle)
+{
+    const size_t size = StringPool::size();
+
+    const StringPool::Handle artist = StringPool::intern("Some Artist");
+    const StringPool::Handle album = StringPool::intern(std::string("Some Album"));
+    const StringPool::Handle sameArtist = StringPool::intern(std::string("Some Artist"));
+
+    EXPECT_NE((StringPool::Handle)0, artist);
+    EXPECT_NE(artist, album);
+    EXPECT_EQ(artist, sameArtist);
+    EXPECT_EQ("Some Artist", StringPool::get(artist));
+    EXPECT_EQ("Some Album", StringPool::get(album));
+    EXPECT_EQ(size + 2, StringPool::size());
+
+    const char *prefix = "Some Artist and more";
+    EXPECT_EQ(artist, StringPool::intern(prefix, 11));
+    StringPool::release(artist);
+
+    StringPool::release(artist);
+    StringPool::release(sameArtist);
+    StringPool::release(album);
+    EXPECT_EQ(size, StringPool::size());
+}
+
+TEST(StringPool, ReferenceCounting)
+{
+    const size_t size = StringPool::size();
+
+    const StringPool::Handle handle = StringPool::intern("Genre");
+    const std::string *str = &StringPool::get(handle);
+    StringPool::addRef(handle);
+
+    StringPool::release(handle);
+    EXPECT_EQ(size + 1, StringPool::size());
+    EXPECT_EQ(str, &StringPool::get(handle)); // Still referenced, not moved
+    EXPECT_EQ("Genre", *str);
+
+    StringPool::release(handle);
+    EXPECT_EQ(size, StringPool::size());
+
+    // Freed slot is reused
+    const StringPool::Handle other = StringPool::intern("Other Genre");
+    EXPECT_EQ(handle, other);
+    EXPECT_EQ("Other Genre", StringPool::get(other));
+    EXPECT_EQ(other, StringPool::intern("Other Genre"));
+    StringPool::release(other);
+    StringPool::release(other);
+    EXPECT_EQ(size, StringPool::size());
+}
+
+TEST(StringPool, ManyStrings)
+{
+    const size_t size = StringPool::size();
+
+    std::vector<StringPool::Handle> handles;
+    for (int i = 0; i < 10000; ++i) {
+        handles.push_back(StringPool::intern(std::to_string(i % 1000)));
+    }
+    EXPECT_EQ(size + 1000, StringPool::size());
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(std::to_string(i % 1000), StringPool::get(handles[i]));
+        ASSERT_EQ(handles[i % 1000], handles[i]);
+    }
+    for (StringPool::Handle handle : handles) {
+        StringPool::release(handle);
+    }
+    EXPECT_EQ(size, StringPool::size());
+}
+
+TEST(StringPool, PooledString)
+{
+    const size_t size = StringPool::size();
+    {
+        PooledString empty;
+        EXPECT_TRUE(empty.empty());
+        EXPECT_EQ("", empty.str());
+
+        PooledString title("Title");
+        PooledString sameTitle(std::string("Title"));
+        PooledString other("Other title", 5);
+        EXPECT_EQ(title, sameTitle);
+        EXPECT_NE(title, other);
+        EXPECT_EQ("Other", other.str());
+        EXPECT_EQ(size + 2, StringPool::size());
+
+        PooledString copy = title;
+        PooledString moved = std::move(sameTitle);
+        EXPECT_TRUE(sameTitle.empty());
+        EXPECT_EQ(title, copy);
+        EXPECT_EQ(title, moved);
+
+        other = title;
+        EXPECT_EQ(size + 1, StringPool::size());
+        EXPECT_EQ("Title", other.str());
+
+        PooledString fromHandle = PooledString::fromHandle(title.handle());
+        title = PooledString();
+        copy = std::move(moved);
+        EXPECT_EQ("Title", fromHandle.str());
+        EXPECT_EQ(size + 1, StringPool::size());
+    }
+    EXPECT_EQ(size, StringPool::size());
+}
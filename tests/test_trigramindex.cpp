@@ -0,0 +1,133 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "gtest/gtest.h"
+
+#include "lib/TrigramIndex.h"
+
+using namespace ncxmms2;
+
+namespace {
+
+std::vector<int> find(const TrigramIndex& index, const std::string& needle)
+{
+    std::vector<int> items;
+    index.find(needle, &items);
+    return items;
+}
+
+std::vector<int> bruteForceFind(const std::vector<std::string>& texts, const std::string& needle)
+{
+    std::vector<int> items;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        size_t begin = 0;
+        while (begin <= texts[i].size()) {
+            size_t end = texts[i].find('\0', begin);
+            if (end == std::string::npos)
+                end = texts[i].size();
+            if (texts[i].substr(begin, end - begin).find(needle) != std::string::npos) {
+                items.push_back(i);
+                break;
+            }
+            begin = end + 1;
+        }
+    }
+    return items;
+}
+
+}
+
+TEST(TrigramIndex, FindsSubstrings)
+{
+    std::vector<std::string> texts = {
+        "the beatles - yesterday",
+        "the rolling stones - angie",
+        std::string("abc\0def", 7),
+        "",
+        "yesterday once more"
+    };
+    TrigramIndex index;
+    EXPECT_FALSE(index.isBuilt());
+    index.build(texts.size(), [&texts](int item, std::string *text){text->append(texts[item]);});
+    EXPECT_TRUE(index.isBuilt());
+    EXPECT_EQ(5, index.itemsCount());
+
+    EXPECT_EQ(std::vector<int>({0, 4}), find(index, "yesterday"));
+    EXPECT_EQ(std::vector<int>({0, 1}), find(index, "the "));
+    EXPECT_EQ(std::vector<int>({1}), find(index, "es - an"));
+    EXPECT_EQ(std::vector<int>(), find(index, "cde"));
+    EXPECT_EQ(std::vector<int>(), find(index, "xyz"));
+
+    // Short needles are scanned for, matches don't cross item boundaries
+    EXPECT_EQ(std::vector<int>({2}), find(index, "ab"));
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 4}), find(index, "e"));
+    EXPECT_EQ(std::vector<int>(), find(index, "ey"));
+
+    std::vector<int> narrowed;
+    index.find("yesterday o", find(index, "yesterday"), &narrowed);
+    EXPECT_EQ(std::vector<int>({4}), narrowed);
+}
+
+TEST(TrigramIndex, UpdatedItems)
+{
+    std::vector<std::string> texts = {"first song", "second song", "third song"};
+    TrigramIndex index;
+    index.build(texts.size(), [&texts](int item, std::string *text){text->append(texts[item]);});
+
+    texts[1] = "renamed track";
+    index.updateItem(1, [&texts](int item, std::string *text){text->append(texts[item]);});
+    EXPECT_EQ(std::vector<int>({0, 2}), find(index, "song"));
+    EXPECT_EQ(std::vector<int>({1}), find(index, "track"));
+    EXPECT_EQ(std::vector<int>({1}), find(index, "ck"));
+    EXPECT_EQ(std::vector<int>({0, 2}), find(index, "so"));
+    EXPECT_FALSE(index.hasManyUpdatedItems());
+
+    index.clear();
+    EXPECT_FALSE(index.isBuilt());
+    EXPECT_EQ(0, index.itemsCount());
+}
+
+TEST(TrigramIndex, RandomTexts)
+{
+    std::srand(3);
+    std::vector<std::string> texts;
+    for (int i = 0; i < 2000; ++i) {
+        std::string text;
+        const int size = std::rand() % 20;
+        for (int j = 0; j < size; ++j) {
+            text.push_back(std::rand() % 8 ? 'a' + std::rand() % 4 : '\0');
+        }
+        texts.push_back(text);
+    }
+    TrigramIndex index;
+    index.build(texts.size(), [&texts](int item, std::string *text){text->append(texts[item]);});
+
+    for (int i = 0; i < 200; ++i) {
+        if (i % 10 == 0) {
+            const int item = std::rand() % texts.size();
+            texts[item] = "dcba" + texts[item];
+            index.updateItem(item, [&texts](int item, std::string *text){text->append(texts[item]);});
+        }
+        std::string needle;
+        const int size = 1 + std::rand() % 5;
+        for (int j = 0; j < size; ++j) {
+            needle.push_back('a' + std::rand() % 4);
+        }
+        ASSERT_EQ(bruteForceFind(texts, needle), find(index, needle)) << needle;
+    }
+}
@@ -0,0 +1,51 @@
+/**
+ *  This file is a part of ncxmms2, an XMMS2 Client.
+ *
+ *  Copyright (C) 2011-2018 Pavel Kunavin <tusk.kun@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+#include <string>
+#include "gtest/gtest.h"
+
+#include "XmmsUtils/Types.h"
+
+using namespace ncxmms2;
+
+TEST(XmmsTypes, DecodeUrl)
+{
+    std::string buffer;
+    EXPECT_TRUE(xmms2::decodeUrl("file:///music/Some+Artist/01%20Song%2b%C3%A9.ogg", &buffer));
+    EXPECT_EQ("file:///music/Some Artist/01 Song+\xC3\xA9.ogg", buffer);
+    EXPECT_EQ(buffer, xmms2::decodeUrl("file:///music/Some+Artist/01%20Song%2b%C3%A9.ogg"));
+
+    EXPECT_FALSE(xmms2::decodeUrl("file:///music/%2", &buffer));
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_FALSE(xmms2::decodeUrl("file:///music/%zz", &buffer));
+    EXPECT_EQ("", xmms2::decodeUrl("file:///music/%"));
+}
+
+TEST(XmmsTypes, PooledFileNameFromUrl)
+{
+    std::string buffer;
+    const char *urls[] = {
+        "file:///music/Some+Artist/01%20Song.ogg",
+        "file:///music/Some+Artist/",
+        "file:///music",
+        "no_slash",
+        "file:///music/%"
+    };
+
+    for (const char *url : urls) {
+        const PooledString fileName = xmms2::getPooledFileNameFromUrl(url, &buffer);
+        EXPECT_EQ(xmms2::getFileNameFromUrl(xmms2::decodeUrl(url)), fileName.str());
+    }
+}